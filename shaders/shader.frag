@@ -1,6 +1,6 @@
 #version 450
 
-layout(location = 0) in vec3 frag_color;
+layout(location = 0) flat in uint frag_color_seed;
 layout(location = 1) in vec2 frag_tex_coord;
 layout(location = 2) in vec3 pos_world;
 layout(location = 3) in vec3 normal_world;
@@ -24,17 +24,43 @@ layout(binding = 3) uniform Light {
 
 const vec4 _gray_scale = vec4(0.7, 0.7, 0.7, 1.0);
 
+// Vibrant color from a hash of the seed, the same from run to run
+vec3	generateVibrantColor(uint seed) {
+	seed = (seed ^ 61u) ^ (seed >> 16u);
+	seed *= 9u;
+	seed ^= seed >> 4u;
+	seed *= 0x27d4eb2du;
+	seed ^= seed >> 15u;
+
+	vec3	color = vec3(
+		float(seed & 0x3FFu),
+		float((seed >> 10u) & 0x3FFu),
+		float((seed >> 20u) & 0x3FFu)
+	) / 1023.0;
+	float	max_channel = max(max(color.r, color.g), color.b);
+	float	min_channel = min(min(color.r, color.g), color.b);
+	float	delta = max_channel - min_channel;
+
+	// Boost the saturation and value
+	if (delta > 0.0) {
+		vec3	boosted = (color - min_channel) / delta;
+		color = mix(boosted, color, equal(color, vec3(max_channel)));
+	}
+	return color;
+}
+
 void main() {
 	vec4	input_color; // Current color
 	vec4	output_color; // Next color
+	vec4	face_color = vec4(generateVibrantColor(frag_color_seed), 1.0);
 
 	if (texture_ubo.state == 1) {
 		// From texture to color
 		input_color = texture(tex_sampler, frag_tex_coord);
-		output_color = vec4(frag_color, 1.0);
+		output_color = face_color;
 	} else if (texture_ubo.state == 2) {
 		// From color to grayscale
-		input_color = vec4(frag_color, 1.0);
+		input_color = face_color;
 		output_color = _gray_scale;
 	} else {
 		// From grayscale to texture
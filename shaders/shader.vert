@@ -1,11 +1,18 @@
 #version 450
 
+#if SCOP_COMPACT_VERTEX
+// Quantized attributes, see scop::CompactVertex
+layout(location = 0) in vec4 in_position;
+layout(location = 1) in vec2 in_tex_coord;
+layout(location = 2) in vec2 in_normal;
+#else
 layout(location = 0) in vec3 in_position;
-layout(location = 1) in vec3 in_color;
-layout(location = 2) in vec2 in_tex_coord;
-layout(location = 3) in vec3 in_normal;
+layout(location = 1) in vec2 in_tex_coord;
+layout(location = 2) in vec3 in_normal;
+#endif
 
-layout(location = 0) out vec3 frag_color;
+// Face color seed, from the first vertex of the triangle
+layout(location = 0) flat out uint frag_color_seed;
 layout(location = 1) out vec2 frag_tex_coord;
 layout(location = 2) out vec3 pos_world;
 layout(location = 3) out vec3 normal_world;
@@ -14,18 +21,47 @@ layout(binding = 0) uniform Camera {
 	mat4 model;
 	mat4 view;
 	mat4 proj;
+	vec3 pos_offset;
+	vec3 pos_scale;
+	vec2 uv_offset;
+	vec2 uv_scale;
 } camera_ubo;
 
+// Same depth as the depth only pass (shader.depth)
+invariant gl_Position;
+
+#if SCOP_COMPACT_VERTEX
+// Octahedral decoding (inverse of scop::mesh::quantizeVertices)
+vec3	decodeNormal(vec2 encoded) {
+	vec3	normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float	fold = max(-normal.z, 0.0);
+
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+	return normalize(normal);
+}
+#endif
+
 void	main() {
+#if SCOP_COMPACT_VERTEX
+	vec3	position = camera_ubo.pos_offset + in_position.xyz * camera_ubo.pos_scale;
+	vec3	normal = decodeNormal(in_normal);
+	vec2	tex_coord = camera_ubo.uv_offset + in_tex_coord * camera_ubo.uv_scale;
+#else
+	vec3	position = in_position;
+	vec3	normal = in_normal;
+	vec2	tex_coord = in_tex_coord;
+#endif
+
 	// Transform to world space
-	pos_world = vec3(camera_ubo.model * vec4(in_position, 1.0));
+	pos_world = vec3(camera_ubo.model * vec4(position, 1.0));
 
 	// Apply camera view
 	gl_Position = camera_ubo.proj * camera_ubo.view * vec4(pos_world, 1.0);
-	frag_color = in_color;
-	frag_tex_coord = in_tex_coord;
+	frag_color_seed = uint(gl_VertexIndex);
+	frag_tex_coord = tex_coord;
 
 	// Note: no need to inverse transpose model matrix
 	// 		 because object scaling (zoom) is uniform.
-	normal_world = normalize(mat3(camera_ubo.model) * in_normal);
+	normal_world = normalize(mat3(camera_ubo.model) * normal);
 }
\ No newline at end of file
@@ -16,6 +16,13 @@
 #include "ppm_loader.hpp"
 #include "math.hpp"
 #include "mtl_parser.hpp"
+#include "material_cache.hpp"
+#include "image_cache.hpp"
+#include "mesh_cache.hpp"
+#include "index_map.hpp"
+#include "weld.hpp"
+#include "vertex_cache.hpp"
+#include "overdraw.hpp"
 
 namespace scop {
 
@@ -55,19 +62,41 @@ std::size_t						App::selected_light_pos = 0;
 /*                                   PUBLIC                                   */
 /* ========================================================================== */
 
-App::App(const std::string& model_file) {
+/**
+ * @brief Loads the model, and opens the viewer unless only
+ * reporting on the mesh.
+*/
+App::App(const std::string& model_file, AppMode mode): mode(mode) {
 	loadModel(model_file);
+	if (mode == APP_MODE_MESH_REPORT) {
+		return;
+	}
 	window.init(model_file);
-	engine.init(window, *image, light, vertices, indices);
+
+	// Cached vertices are decoded by the engine straight to the gpu
+	const scop::graphics::VertexData	vertex_data = mesh_cache ?
+		scop::graphics::VertexData{ nullptr, mesh_cache.get() } :
+		scop::graphics::VertexData{ &vertices, nullptr };
+	engine.init(window, image, light, vertex_data, indices, meshlets, lods, bounds);
+	mesh_cache.reset();
+
+	// Streamed in by the engine, which keeps it until decoded
+	image.reset();
 }
 
 App::~App() {
-	engine.destroy();
+	if (mode == APP_MODE_VIEWER) {
+		engine.destroy();
+	}
 }
 
 /* ========================================================================== */
 
 void	App::run() {
+	if (mode == APP_MODE_MESH_REPORT) {
+		scop::mesh::printMeshReport(std::cout, report);
+		return;
+	}
 	while (window.alive()) {
 		window.await();
 		drawFrame();
@@ -277,66 +306,223 @@ void	App::drawFrame() {
 	engine.render(window, indices.size());
 }
 
+/**
+ * @brief Loads the model buffers, material and light.
+ *
+ * @note Uses the .scopmesh cache when it is up to date,
+ * otherwise parses the .obj file and writes the cache.
+ * The mesh report always parses it, for the figures before optimization,
+ * and leaves the cache as is.
+*/
 void	App::loadModel(const std::string& path) {
 	LOG("Loading model...");
 
+	auto				cache = std::make_unique<scop::obj::MeshCache>();
+	scop::mtl::Material	material;
+
+	if (
+		mode != APP_MODE_MESH_REPORT &&
+		cache->load(path) &&
+		cache->decodeIndices(indices)
+	) {
+		LOG("Using cached model.");
+		meshlets.assign(
+			cache->getMeshlets(),
+			cache->getMeshlets() + cache->getNbMeshlets()
+		);
+		lods.assign(
+			cache->getLods(),
+			cache->getLods() + cache->getNbLods()
+		);
+		bounds = cache->getBounds();
+		material = cache->getMaterial();
+
+		// Kept mapped for the engine to decode the vertices
+		mesh_cache = std::move(cache);
+	} else {
+		material = parseModel(path);
+		if (mode != APP_MODE_MESH_REPORT) {
+			scop::obj::MeshCache::save(
+				path,
+				vertices,
+				indices,
+				meshlets,
+				lods,
+				bounds,
+				material
+			);
+		}
+	}
+	LOG("Meshlets: " << meshlets.size());
+	for (std::size_t i = 0; i < lods.size(); ++i) {
+		LOG(
+			"LOD " << i << ": " << lods[i].index_count / 3 <<
+			" triangles, error " << lods[i].error
+		);
+	}
+
+	// Back the camera off until the whole model is in view
+	const float	model_radius = scop::mesh::computeOriginRadius(bounds);
+	if (model_radius > 0.0f) {
+		App::eye_pos = scop::normalize(App::eye_pos) * (
+			model_radius * SCOP_CAMERA_FIT_MARGIN /
+			std::sin(math::radians(SCOP_FOV) * 0.5f)
+		);
+	}
+
+	// Pass ownership of texture image from material to app
+	image = std::move(material.ambient_texture);
+
+	// Single model: nothing left to share
+	scop::clearSharedImages();
+	scop::mtl::clearSharedMaterials();
+
+	// Load light
+	light = UniformBufferObject::Light{
+		material.ambient_color,
+		App::light_positions[0],
+		App::light_colors[0],
+		material.diffuse_color,
+		App::eye_pos * App::zoom_input,
+		material.specular_color,
+		material.shininess
+	};
+}
+
+/**
+ * @brief Parses the .obj file, welds it if SCOP_WELD_EPSILON enables it,
+ * and builds the deduplicated and centered vertex buffer.
+ *
+ * @return The model material.
+*/
+scop::mtl::Material	App::parseModel(const std::string& path) {
 	scop::obj::ObjParser	parser;
 	scop::obj::Model	model = parser.parseFile(path.c_str());
 
-	std::unordered_map<scop::Vertex, uint32_t>	unique_vertices{};
+	// Merge close positions, and the triangles collapsing with them
+	if (SCOP_WELD_EPSILON >= 0.0f) {
+		const scop::obj::WeldStats	stats = model.weld(SCOP_WELD_EPSILON);
+		LOG(
+			"Welding: " << stats.welded_vertices << " positions merged, " <<
+			stats.removed_triangles << " triangles removed"
+		);
+	}
 
 	const auto&	model_vertices = model.getVertexCoords();
 	const auto& model_textures = model.getTextureCoords();
 	const auto& model_normals = model.getNormalCoords();
-	const auto& model_triangles = model.getTriangles();
-
-	// Retrieve unique vertices:
-	for (const auto& triangle: model_triangles) {
-		for (const auto& index: triangle.indices) {
-			scop::Vertex	vertex{};
-
-			vertex.pos = model_vertices[index.vertex];
-			vertex.tex_coord = {
-				model_textures[index.texture].x,
-				1.0f - model_textures[index.texture].y
-			};
-			vertex.normal = model_normals[index.normal];
-			math::generateVibrantColor(
-				vertex.color.x,
-				vertex.color.y,
-				vertex.color.z
-			);
 
-			if (unique_vertices.count(vertex) == 0) {
-				unique_vertices[vertex] = static_cast<uint32_t>(vertices.size());
-				vertices.emplace_back(vertex);
-			}
-			indices.emplace_back(unique_vertices[vertex]);
+	if (mode == APP_MODE_MESH_REPORT) {
+		report.nb_positions = model_vertices.size();
+		report.nb_triangles_before = model.getTriangles().size();
+		report.nb_corners = report.nb_triangles_before * 3;
+	}
+
+	// Retrieve unique vertices, one per (vertex, texture, normal) triple
+	std::vector<scop::obj::Model::Index>	unique_indices;
+	scop::obj::IndexMap::deduplicate(model.getTriangles(), unique_indices, indices);
+
+	std::vector<scop::Vect3>	positions;
+	if (SCOP_OVERDRAW_THRESHOLD >= 1.0f || mode == APP_MODE_MESH_REPORT) {
+		positions.resize(unique_indices.size());
+		for (std::size_t i = 0; i < unique_indices.size(); ++i) {
+			positions[i] = model_vertices[unique_indices[i].vertex];
 		}
 	}
+	if (mode == APP_MODE_MESH_REPORT) {
+		report.before = scop::mesh::analyzeMesh(indices, positions);
+	}
 
-	// Center model
-	scop::Vect3	barycenter = utils::computeBarycenter(vertices);
+	// Reorder triangles for the vertex cache and overdraw,
+	// then vertices for fetch locality
+	const float	acmr_before = scop::mesh::computeAcmr(indices, unique_indices.size());
+	scop::mesh::optimizeVertexCache(indices, unique_indices.size());
+	if (SCOP_OVERDRAW_THRESHOLD >= 1.0f) {
+		scop::mesh::optimizeOverdraw(indices, positions, SCOP_OVERDRAW_THRESHOLD);
+	}
+	scop::mesh::optimizeVertexFetch(unique_indices, indices);
+
+	vertices.resize(unique_indices.size());
+	for (std::size_t i = 0; i < unique_indices.size(); ++i) {
+		const scop::obj::Model::Index&	index = unique_indices[i];
+		scop::Vertex&					vertex = vertices[i];
+
+		vertex.pos = model_vertices[index.vertex];
+		vertex.tex_coord = {
+			model_textures[index.texture].x,
+			1.0f - model_textures[index.texture].y
+		};
+		vertex.normal = model_normals[index.normal];
+	}
+	LOG(
+		"Model: " << vertices.size() << " vertices, " <<
+		indices.size() / 3 << " triangles (" <<
+		indices.size() << " vertices before deduplication)"
+	);
+
+	// Center model, the bounds moving along
+	bounds = scop::mesh::computeBounds(vertices);
+	const scop::Vect3	barycenter = bounds.barycenter;
 	for (auto& vertex: vertices) {
 		vertex.pos -= barycenter;
 	}
+	scop::mesh::translateBounds(bounds, -barycenter);
+
+	// Simplified levels of detail after the full one, each split in
+	// clusters for culling, meshlet by meshlet in the index buffer
+	lods = scop::mesh::buildLods(
+		indices,
+		vertices,
+		meshlets,
+		!model.hasDefaultTextureCoords()
+	);
+	scop::mesh::optimizeVertexFetch(vertices, indices);
 
-	// Pass ownership of texture image from model to app
-	image.reset(
-		new scop::Image(std::move(*model.getMaterial().ambient_texture))
+	const std::vector<uint32_t>	full_detail(
+		indices.begin(),
+		indices.begin() + lods[0].index_count
+	);
+	LOG(
+		"Vertex cache ACMR: " << acmr_before << " -> " <<
+		scop::mesh::computeAcmr(full_detail, vertices.size())
 	);
-	model.getMaterial().ambient_texture.release();
+	if (mode == APP_MODE_MESH_REPORT) {
+		fillMeshReport(full_detail);
+	}
 
-	// Load light
-	light = UniformBufferObject::Light{
-		model.getMaterial().ambient_color,
-		App::light_positions[0],
-		App::light_colors[0],
-		model.getMaterial().diffuse_color,
-		App::eye_pos * App::zoom_input,
-		model.getMaterial().specular_color,
-		model.getMaterial().shininess
-	};
+	return std::move(model.getMaterial());
+}
+
+/**
+ * @brief Completes the mesh report with the final buffers, sized as
+ * VertexInput uploads them.
+ *
+ * @param full_detail Index buffer of the full detail level.
+*/
+void	App::fillMeshReport(const std::vector<uint32_t>& full_detail) {
+	using scop::graphics::VertexInput;
+
+	std::vector<scop::Vect3>	positions(vertices.size());
+	for (std::size_t i = 0; i < vertices.size(); ++i) {
+		positions[i] = vertices[i].pos;
+	}
+
+	report.nb_vertices = vertices.size();
+	report.nb_triangles = full_detail.size() / 3;
+	report.after = scop::mesh::analyzeMesh(full_detail, positions);
+
+	report.nb_lods = lods.size();
+	report.nb_indices = indices.size();
+	report.index_size =
+		VertexInput::getIndexType(vertices.size()) == VK_INDEX_TYPE_UINT16 ?
+		sizeof(uint16_t) :
+		sizeof(uint32_t);
+	report.index_buffer_size = VertexInput::getIndexBufferSize(
+		indices.size(),
+		vertices.size()
+	);
+	report.vertex_size = sizeof(scop::GpuVertex);
+	report.vertex_buffer_size = VertexInput::getVertexBufferSize(vertices.size());
 }
 
 /* ========================================================================== */
@@ -21,20 +21,34 @@
 # include <GLFW/glfw3.h>
 
 // Std
-# include <memory> // std::unique_ptr
+# include <memory> // std::unique_ptr, std::shared_ptr
 # include <map> // std::map
+# include <algorithm> // std::clamp
 
 # include "window.hpp"
 # include "utils.hpp"
 # include "matrix.hpp"
 # include "vertex.hpp"
 # include "image_handler.hpp"
+# include "material.hpp"
 # include "engine.hpp"
+# include "meshlet.hpp"
+# include "lod.hpp"
+# include "bounds.hpp"
+# include "mesh_cache.hpp"
+# include "report.hpp"
 # include "uniform_buffer_object.hpp"
 
 # define SCOP_MOUSE_SENSITIVITY	0.25f
 # define SCOP_MOVE_SPEED		0.005f
 # define SCOP_ROTATION_SPEED	0.25f // deg
+# define SCOP_FOV				45.0f // deg
+
+// Room left around the model when fitting the camera to its bounds
+# define SCOP_CAMERA_FIT_MARGIN	1.1f
+
+// Smallest near plane distance, relative to the far one
+# define SCOP_NEAR_FAR_RATIO	0.001f
 
 namespace scop {
 
@@ -74,6 +88,11 @@ enum TextureState {
 	TEXTURE_ENABLED = 0
 };
 
+enum AppMode {
+	APP_MODE_VIEWER,
+	APP_MODE_MESH_REPORT
+};
+
 /**
  * Main class.
 */
@@ -81,6 +100,7 @@ class App {
 public:
 
 	friend graphics::DescriptorSet;
+	friend graphics::Engine;
 
 	/* ========================================================================= */
 	/*                               CONST MEMBERS                               */
@@ -92,7 +112,7 @@ public:
 	/*                                  METHODS                                  */
 	/* ========================================================================= */
 
-	App(const std::string& model_file);
+	App(const std::string& model_file, AppMode mode = APP_MODE_VIEWER);
 	~App();
 
 	App() = delete;
@@ -139,13 +159,19 @@ private:
 	/*                               CLASS MEMBERS                               */
 	/* ========================================================================= */
 
+	AppMode								mode;
 	scop::Window						window;
 	scop::graphics::Engine				engine;
 
 	std::vector<scop::Vertex>			vertices;
+	std::unique_ptr<scop::obj::MeshCache>	mesh_cache;	// Vertices, if cached
 	std::vector<uint32_t>				indices;
-	std::unique_ptr<scop::Image>		image;
+	std::vector<scop::mesh::Meshlet>	meshlets;
+	std::vector<scop::mesh::Lod>		lods;
+	scop::mesh::Bounds					bounds;
+	std::shared_ptr<const scop::Image>	image;
 	UniformBufferObject::Light			light;
+	scop::mesh::MeshReport				report{};
 
 	/* ========================================================================= */
 	/*                               STATIC MEMBERS                              */
@@ -179,6 +205,10 @@ private:
 
 	void								drawFrame();
 	void								loadModel(const std::string& path);
+	scop::mtl::Material					parseModel(const std::string& path);
+	void								fillMeshReport(
+		const std::vector<uint32_t>& full_detail
+	);
 
 }; // class App
 
@@ -15,6 +15,7 @@
 #include "app.hpp"
 #include "math.hpp"
 
+#include <algorithm> // std::max
 #include <array> // std::array
 #include <stdexcept> // std::runtime_error
 #include <chrono> // std::chrono
@@ -34,7 +35,9 @@ void	DescriptorSet::initLayout(Device& device) {
 void	DescriptorSet::initSets(
 	Device& device,
 	TextureSampler& texture_sampler,
-	const UniformBufferObject::Light& light
+	const UniformBufferObject::Light& light,
+	const scop::mesh::Quantization& vertex_quantization,
+	float radius
 ) {
 	uint32_t	frames_in_flight = static_cast<uint32_t>(
 		Engine::max_frames_in_flight
@@ -43,6 +46,8 @@ void	DescriptorSet::initSets(
 	createDescriptorPool(device, frames_in_flight);
 	createDescriptorSets(device, texture_sampler, frames_in_flight);
 
+	quantization = vertex_quantization;
+	model_radius = radius;
 	initUniformBuffer(light);
 }
 
@@ -71,6 +76,33 @@ void	DescriptorSet::updateUniformBuffer(VkExtent2D extent) {
 	updateLight();
 }
 
+/**
+ * Point the sampler descriptor to the current texture sampler,
+ * recreated as its levels stream in
+*/
+void	DescriptorSet::updateTextureSampler(
+	Device& device,
+	TextureSampler& texture_sampler
+) {
+	VkDescriptorImageInfo	image_info{};
+	image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	image_info.imageView = texture_sampler.vk_texture_image_view;
+	image_info.sampler = texture_sampler.vk_texture_sampler;
+
+	VkWriteDescriptorSet	descriptor_write{};
+	descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptor_write.dstSet = vk_descriptor_sets;
+	descriptor_write.dstBinding = 1;
+	descriptor_write.dstArrayElement = 0;
+	descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptor_write.descriptorCount = 1;
+	descriptor_write.pBufferInfo = nullptr;
+	descriptor_write.pImageInfo = &image_info;
+	descriptor_write.pTexelBufferView = nullptr;
+
+	vkUpdateDescriptorSets(device.logical_device, 1, &descriptor_write, 0, nullptr);
+}
+
 /* ========================================================================== */
 /*                                   PRIVATE                                  */
 /* ========================================================================== */
@@ -327,28 +359,42 @@ void	DescriptorSet::updateCamera(
 	);
 
 	// Define camera transformation view
+	const scop::Vect3	eye = scop::App::eye_pos * scop::App::zoom_input;
 	camera.view = scop::lookAtDir(
-		scop::App::eye_pos * scop::App::zoom_input,
+		eye,
 		scop::App::eye_dir,
 		scop::Vect3(0.0f, 1.0f, 0.0f)
 	);
 
+	// Fit the depth range to the model bounding sphere,
+	// whatever the rotation and the view direction
+	const float	distance = scop::norm(eye - App::position);
+	const float	far = std::max(distance + model_radius, 0.1f);
+	const float	near = std::max(distance - model_radius, far * SCOP_NEAR_FAR_RATIO);
+
 	// Define persp. projection transformation
 	camera.proj = scop::perspective(
-		scop::math::radians(45.0f),
+		scop::math::radians(SCOP_FOV),
 		extent.width / static_cast<float>(extent.height),
-		0.1f,
-		100.0f
+		near,
+		far
 	);
 	// Invert y axis (because y axis is inverted in Vulkan)
 	camera.proj[5] *= -1;
 
+	// Vertex attributes dequantization
+	camera.pos_offset = quantization.pos_offset;
+	camera.pos_scale = quantization.pos_scale;
+	camera.uv_offset = quantization.uv_offset;
+	camera.uv_scale = quantization.uv_scale;
+
 	// Copy to uniform buffer
 	memcpy(
 		(char*)uniform_buffers_mapped,
 		&camera,
 		sizeof(UniformBufferObject::Camera)
 	);
+	current_camera = camera;
 }
 
 /**
@@ -25,6 +25,7 @@
 # include "device.hpp"
 # include "texture_sampler.hpp"
 # include "uniform_buffer_object.hpp"
+# include "quantization.hpp"
 
 namespace scop {
 namespace graphics {
@@ -52,10 +53,16 @@ public:
 	void					initSets(
 		Device& device, 
 		TextureSampler& texture_sampler,
-		const UniformBufferObject::Light& light
+		const UniformBufferObject::Light& light,
+		const scop::mesh::Quantization& vertex_quantization,
+		float radius
 	);
 	void					destroy(Device& device);
 	void					updateUniformBuffer(VkExtent2D extent);
+	void					updateTextureSampler(
+		Device& device,
+		TextureSampler& texture_sampler
+	);
 
 private:
 	/* ========================================================================= */
@@ -76,6 +83,10 @@ private:
 	VkDeviceMemory			uniform_buffers_memory;
 	void*					uniform_buffers_mapped;
 
+	scop::mesh::Quantization	quantization;
+	float						model_radius;
+	UniformBufferObject::Camera	current_camera;
+
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
 	/* ========================================================================= */
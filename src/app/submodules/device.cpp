@@ -44,19 +44,24 @@ void	Device::idle() {
 /* ========================================================================== */
 
 /**
- * Map memory and find one suitable with filter and properties
+ * Map memory and find one suitable with filter and properties,
+ * with the preferred ones too if there is one
 */
 uint32_t	Device::findMemoryType(
 	uint32_t type_filter,
-	VkMemoryPropertyFlags properties
+	VkMemoryPropertyFlags properties,
+	VkMemoryPropertyFlags preferred
 ) const {
 	VkPhysicalDeviceMemoryProperties	mem_properties;
 	vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
 
-	for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i) {
-		if ((mem_properties.memoryTypes[i].propertyFlags & properties) == properties &&
-			(type_filter & (1 << i))) {
-			return i;
+	// With the preferred properties first, then without them
+	for (VkMemoryPropertyFlags wanted: { properties | preferred, properties }) {
+		for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i) {
+			if ((mem_properties.memoryTypes[i].propertyFlags & wanted) == wanted &&
+				(type_filter & (1 << i))) {
+				return i;
+			}
 		}
 	}
 	throw std::runtime_error("failed to find suitable memory type");
@@ -125,7 +130,8 @@ void	Device::createBuffer(
 	VkBufferUsageFlags usage,
 	VkMemoryPropertyFlags properties,
 	VkBuffer& buffer,
-	VkDeviceMemory& buffer_memory
+	VkDeviceMemory& buffer_memory,
+	VkMemoryPropertyFlags preferred
 ) {
 	// Create buffer instance
 	VkBufferCreateInfo	buffer_info{};
@@ -147,7 +153,8 @@ void	Device::createBuffer(
 	alloc_info.allocationSize = mem_requirements.size;
 	alloc_info.memoryTypeIndex = findMemoryType(
 		mem_requirements.memoryTypeBits,
-		properties
+		properties,
+		preferred
 	);
 
 	if (vkAllocateMemory(logical_device, &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS) {
@@ -223,9 +230,13 @@ void	Device::createLogicalDevice() {
 		queue_create_infos.emplace_back(queue_create_info);
 	}
 
-	// Enable device features
+	// Enable device features, block compressed textures if supported
+	VkPhysicalDeviceFeatures	supported_features;
+	vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+
 	VkPhysicalDeviceFeatures	device_features{};
 	device_features.samplerAnisotropy = VK_TRUE;
+	device_features.textureCompressionBC = supported_features.textureCompressionBC;
 
 	VkDeviceCreateInfo			create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
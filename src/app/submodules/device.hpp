@@ -63,7 +63,8 @@ public:
 
 	uint32_t						findMemoryType(
 		uint32_t type_filter,
-		VkMemoryPropertyFlags properties
+		VkMemoryPropertyFlags properties,
+		VkMemoryPropertyFlags preferred = 0
 	) const;
 	void							createImage(
 		uint32_t width,
@@ -82,7 +83,8 @@ public:
 		VkBufferUsageFlags usage,
 		VkMemoryPropertyFlags properties,
 		VkBuffer& buffer,
-		VkDeviceMemory& buffer_memory
+		VkDeviceMemory& buffer_memory,
+		VkMemoryPropertyFlags preferred = 0
 	);
 
 private:
@@ -14,10 +14,12 @@
 #include "window.hpp"
 #include "utils.hpp"
 #include "image_handler.hpp"
+#include "app.hpp"
 
 #include <iostream> // std::cerr std::endl
 #include <cstring> // std::strcmp
 #include <set> // std::set
+#include <cmath> // std::abs
 
 namespace scop {
 namespace graphics {
@@ -32,21 +34,34 @@ const std::vector<const char*>	Engine::validation_layers = {
 
 void	Engine::init(
 	scop::Window& window,
-	const scop::Image& image,
+	const std::shared_ptr<const scop::Image>& image,
 	const UniformBufferObject::Light& light,
-	const std::vector<Vertex>& vertices,
-	const std::vector<uint32_t>& indices
+	const VertexData& vertices,
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::mesh::Meshlet>& model_meshlets,
+	const std::vector<scop::mesh::Lod>& model_lods,
+	const scop::mesh::Bounds& model_bounds
 ) {
+	meshlets = model_meshlets;
+	lods = model_lods;
+	model_radius = scop::mesh::computeOriginRadius(model_bounds);
 	createInstance();
 	debug_module.init(vk_instance);
 	device.init(window, vk_instance);
 	render_target.init(device, window);
 	descriptor_set.initLayout(device);
 	createGraphicsPipeline();
+	createDepthPipeline();
 	command_buffer.initPool(device);
 	texture_sampler.init(device, command_buffer.vk_command_pool, image);
 	vertex_input.init(device, command_buffer.vk_command_pool, vertices, indices);
-	descriptor_set.initSets(device, texture_sampler, light);
+	descriptor_set.initSets(
+		device,
+		texture_sampler,
+		light,
+		vertex_input.quantization,
+		model_radius
+	);
 	command_buffer.initBuffer(device);
 	createSyncObjects();
 }
@@ -56,7 +71,8 @@ void	Engine::destroy() {
 
 	texture_sampler.destroy(device);
 
-	// Remove graphics pipeline
+	// Remove graphics pipelines
+	vkDestroyPipeline(device.logical_device, depth_pipeline, nullptr);
 	vkDestroyPipeline(device.logical_device, engine, nullptr);
 	vkDestroyPipelineLayout(device.logical_device, pipeline_layout, nullptr);
 
@@ -89,6 +105,11 @@ void	Engine::render(
 	// Wait fence available, lock it
 	vkWaitForFences(device.logical_device, 1, &in_flight_fences, VK_TRUE, UINT64_MAX);
 
+	// Texture levels streamed in since last frame, now that it is unused
+	if (texture_sampler.update(device, command_buffer.vk_command_pool)) {
+		descriptor_set.updateTextureSampler(device, texture_sampler);
+	}
+
 	// Next available image from swap chain
 	uint32_t	image_index;
 	VkResult	result = vkAcquireNextImageKHR(
@@ -114,14 +135,15 @@ void	Engine::render(
 	// Record buffer
 	vkResetCommandBuffer(command_buffer.command_buffers, 0);
 
+	// Camera first, the visible meshlets depend on it
+	descriptor_set.updateUniformBuffer(render_target.swap_chain_extent);
+
 	recordCommandBuffer(
 		indices_size,
 		command_buffer.command_buffers, 
 		image_index
 	);
 
-	descriptor_set.updateUniformBuffer(render_target.swap_chain_extent);
-
 	// Set synchronization objects
 	VkSemaphore				wait_semaphore[] = {
 		image_available_semaphores
@@ -251,15 +273,15 @@ void	Engine::createGraphicsPipeline() {
 
 	// Vertex data input handler
 	VkPipelineVertexInputStateCreateInfo	vertex_input_info{};
-	auto	binding_description = scop::Vertex::getBindingDescription();
-	auto	attribute_descriptions = scop::Vertex::getAttributeDescriptions();
+	auto	binding_descriptions = scop::GpuStreams::getBindingDescriptions();
+	auto	attribute_descriptions = scop::GpuStreams::getAttributeDescriptions();
 
 	vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertex_input_info.vertexBindingDescriptionCount = 1;
+	vertex_input_info.vertexBindingDescriptionCount = scop::GpuStreams::nb_bindings;
 	vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(
 		attribute_descriptions.size()
 	);
-	vertex_input_info.pVertexBindingDescriptions = &binding_description;
+	vertex_input_info.pVertexBindingDescriptions = binding_descriptions.data();
 	vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data();
 
 	// Vertex input assembly descriptor: regular triangles here
@@ -328,8 +350,14 @@ void	Engine::createGraphicsPipeline() {
 	VkPipelineDepthStencilStateCreateInfo	depth_stencil{};
 	depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depth_stencil.depthTestEnable = VK_TRUE;			// fragment depth compared to depth buffer enabled
-	depth_stencil.depthWriteEnable = VK_TRUE;			// if test passed, new depth saved in buffer enabled
-	depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;	// depth low = object closer
+	if (SCOP_DEPTH_PREPASS) {
+		// Depth already laid down by the depth pipeline
+		depth_stencil.depthWriteEnable = VK_FALSE;
+		depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	} else {
+		depth_stencil.depthWriteEnable = VK_TRUE;			// if test passed, new depth saved in buffer enabled
+		depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;	// depth low = object closer
+	}
 	depth_stencil.depthBoundsTestEnable = VK_FALSE;		// unused. specifies min/max depth bounds
 	depth_stencil.minDepthBounds = 0.0f;
 	depth_stencil.maxDepthBounds = 1.0f;
@@ -395,6 +423,114 @@ void	Engine::createGraphicsPipeline() {
 	vkDestroyShaderModule(device.logical_device, vert_shader_module, nullptr);
 }
 
+/**
+ * Depth only pipeline: vertex stage alone, reading the position stream,
+ * with the same transform and layout as the main pipeline.
+ *
+ * @note Color writes are masked, the render pass is the same.
+*/
+void	Engine::createDepthPipeline() {
+	std::vector<char>	depth_shader_code = scop::utils::readFile(depth_shader_bin);
+	VkShaderModule		depth_shader_module = createShaderModule(depth_shader_code);
+
+	VkPipelineShaderStageCreateInfo	depth_stage_info{};
+	depth_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	depth_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	depth_stage_info.module = depth_shader_module;
+	depth_stage_info.pName = "main";
+
+	// Positions only, from binding 0
+	VkPipelineVertexInputStateCreateInfo	vertex_input_info{};
+	auto	binding_description = scop::GpuStreams::getBindingDescriptions()[0];
+	auto	attribute_description = scop::GpuStreams::getPositionDescription();
+
+	vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertex_input_info.vertexBindingDescriptionCount = 1;
+	vertex_input_info.vertexAttributeDescriptionCount = 1;
+	vertex_input_info.pVertexBindingDescriptions = &binding_description;
+	vertex_input_info.pVertexAttributeDescriptions = &attribute_description;
+
+	VkPipelineInputAssemblyStateCreateInfo	input_assembly_info{};
+	input_assembly_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	input_assembly_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	input_assembly_info.primitiveRestartEnable = VK_FALSE;
+
+	VkPipelineViewportStateCreateInfo	viewport_state{};
+	viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewport_state.viewportCount = 1;
+	viewport_state.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo	rasterizer{};
+	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizer.depthClampEnable = VK_FALSE;
+	rasterizer.rasterizerDiscardEnable = VK_FALSE;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.lineWidth = 1.0f;
+	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizer.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo	multisampling{};
+	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampling.sampleShadingEnable = VK_FALSE;
+	multisampling.rasterizationSamples = device.msaa_samples;
+	multisampling.minSampleShading = 1.0f;
+
+	// No color output
+	VkPipelineColorBlendAttachmentState	color_blend_attachment{};
+	color_blend_attachment.colorWriteMask = 0;
+	color_blend_attachment.blendEnable = VK_FALSE;
+
+	VkPipelineColorBlendStateCreateInfo	color_blending{};
+	color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	color_blending.logicOpEnable = VK_FALSE;
+	color_blending.attachmentCount = 1;
+	color_blending.pAttachments = &color_blend_attachment;
+
+	VkPipelineDepthStencilStateCreateInfo	depth_stencil{};
+	depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depth_stencil.depthTestEnable = VK_TRUE;
+	depth_stencil.depthWriteEnable = VK_TRUE;
+	depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depth_stencil.depthBoundsTestEnable = VK_FALSE;
+	depth_stencil.stencilTestEnable = VK_FALSE;
+
+	std::vector<VkDynamicState>	dynamic_states = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo	dynamic_state{};
+	dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+	dynamic_state.pDynamicStates = dynamic_states.data();
+
+	VkGraphicsPipelineCreateInfo	pipeline_info{};
+	pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipeline_info.stageCount = 1;
+	pipeline_info.pStages = &depth_stage_info;
+	pipeline_info.pVertexInputState = &vertex_input_info;
+	pipeline_info.pInputAssemblyState = &input_assembly_info;
+	pipeline_info.pViewportState = &viewport_state;
+	pipeline_info.pRasterizationState = &rasterizer;
+	pipeline_info.pMultisampleState = &multisampling;
+	pipeline_info.pDepthStencilState = &depth_stencil;
+	pipeline_info.pColorBlendState = &color_blending;
+	pipeline_info.pDynamicState = &dynamic_state;
+	pipeline_info.layout = pipeline_layout;
+	pipeline_info.renderPass = render_target.vk_render_pass;
+	pipeline_info.subpass = 0;
+	pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+	pipeline_info.basePipelineIndex = -1;
+
+	if (vkCreateGraphicsPipelines(device.logical_device, VK_NULL_HANDLE, 1, &pipeline_info,
+	nullptr, &depth_pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create depth pipeline");
+	}
+
+	vkDestroyShaderModule(device.logical_device, depth_shader_module, nullptr);
+}
+
 /**
  * Create semaphores and fences
 */
@@ -506,9 +642,8 @@ void	Engine::recordCommandBuffer(
 	render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
 	render_pass_info.pClearValues = clear_values.data();
 
-	// Begin rp and bind pipeline
+	// Begin rp, pipelines are bound with the draws
 	vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, engine);
 
 	// Set viewport and scissors
 	VkViewport	viewport{};
@@ -525,11 +660,20 @@ void	Engine::recordCommandBuffer(
 	scissor.extent = render_target.swap_chain_extent;
 	vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
-	// Bind vertex buffer && index buffer
-	VkBuffer		vertex_buffers[] = { vertex_input.vertex_buffer };
-	VkDeviceSize	offsets[] = { 0 };
-	vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-	vkCmdBindIndexBuffer(command_buffer, vertex_input.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+	// Bind vertex buffer(s) && index buffer
+	VkBuffer		vertex_buffers[] = {
+		vertex_input.vertex_buffer,
+		vertex_input.vertex_buffer
+	};
+	VkDeviceSize	offsets[] = { 0, vertex_input.attributes_offset };
+	vkCmdBindVertexBuffers(
+		command_buffer,
+		0,
+		scop::GpuStreams::nb_bindings,
+		vertex_buffers,
+		offsets
+	);
+	vkCmdBindIndexBuffer(command_buffer, vertex_input.index_buffer, 0, vertex_input.index_type);
 
 	// Bind descriptor sets
 	vkCmdBindDescriptorSets(
@@ -543,8 +687,48 @@ void	Engine::recordCommandBuffer(
 		nullptr
 	);
 
-	// Issue draw command
-	vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(indices_size), 1, 0, 0, 0);
+	// Index ranges to draw, for the visible meshlets only
+	if (lods.empty()) {
+		draw_ranges.assign(1, { 0, static_cast<uint32_t>(indices_size) });
+	} else {
+		const UniformBufferObject::Camera&	camera = descriptor_set.current_camera;
+
+		// Level of detail from the screen size of the model
+		const float				distance = scop::norm(
+			App::eye_pos * App::zoom_input - App::position
+		);
+		const float				pixel_scale =
+			std::abs(camera.proj.mat[5]) *
+			render_target.swap_chain_extent.height * 0.5f;
+		const scop::mesh::Lod&	lod = lods[
+			scop::mesh::selectLod(lods, model_radius, distance, pixel_scale)
+		];
+
+		if (lod.meshlet_count == 0) {
+			draw_ranges.assign(1, { lod.first_index, lod.index_count });
+		} else {
+			scop::mesh::cullMeshlets(
+				meshlets.data() + lod.first_meshlet,
+				lod.meshlet_count,
+				camera.model,
+				camera.view,
+				camera.proj,
+				draw_ranges
+			);
+		}
+	}
+
+	// Depth first, then shading of the visible fragments
+	if (SCOP_DEPTH_PREPASS) {
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depth_pipeline);
+		for (const scop::mesh::DrawRange& range: draw_ranges) {
+			vkCmdDrawIndexed(command_buffer, range.index_count, 1, range.first_index, 0, 0);
+		}
+	}
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, engine);
+	for (const scop::mesh::DrawRange& range: draw_ranges) {
+		vkCmdDrawIndexed(command_buffer, range.index_count, 1, range.first_index, 0, 0);
+	}
 
 	// Stop the render target work
 	vkCmdEndRenderPass(command_buffer);
@@ -668,11 +852,6 @@ void	copyBufferToImage(
 	uint32_t width,
 	uint32_t height
 ) {
-	VkCommandBuffer	command_buffer = beginSingleTimeCommands(
-		device,
-		command_pool
-	);
-
 	// Specify part of buffer to be copied to image
 	VkBufferImageCopy	region{};
 	region.bufferOffset = 0;
@@ -685,13 +864,33 @@ void	copyBufferToImage(
 	region.imageOffset = { 0, 0, 0 };
 	region.imageExtent = { width, height, 1 };
 
+	copyBufferToImage(device, queue, command_pool, src_buffer, image, &region, 1);
+}
+
+/**
+ * Copies several parts of the buffer (e.g. mip levels) in one command
+*/
+void	copyBufferToImage(
+	VkDevice device,
+	VkQueue queue,
+	VkCommandPool command_pool,
+	VkBuffer src_buffer,
+	VkImage image,
+	const VkBufferImageCopy* regions,
+	uint32_t nb_regions
+) {
+	VkCommandBuffer	command_buffer = beginSingleTimeCommands(
+		device,
+		command_pool
+	);
+
 	vkCmdCopyBufferToImage(
 		command_buffer,
 		src_buffer,
 		image,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		1,
-		&region
+		nb_regions,
+		regions
 	);
 
 	endSingleTimeCommands(device, queue, command_pool, command_buffer);
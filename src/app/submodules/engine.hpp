@@ -20,6 +20,7 @@
 # include <GLFW/glfw3.h>
 
 // Std
+# include <memory>	// std::shared_ptr
 # include <optional>	// std::optional
 # include <vector>		// std::vector
 
@@ -30,6 +31,17 @@
 # include "descriptor_set.hpp"
 # include "command_buffer.hpp"
 # include "vertex_input.hpp"
+# include "meshlet.hpp"
+# include "lod.hpp"
+# include "bounds.hpp"
+
+/**
+ * 1 to lay the depth down with the position only pipeline first,
+ * so that the shading pass only runs for the visible fragments.
+*/
+# ifndef SCOP_DEPTH_PREPASS
+#  define SCOP_DEPTH_PREPASS 0
+# endif
 
 namespace scop {
 namespace graphics {
@@ -73,10 +85,13 @@ public:
 
 	void						init(
 		scop::Window& window,
-		const scop::Image& image,
+		const std::shared_ptr<const scop::Image>& image,
 		const UniformBufferObject::Light& light,
-		const std::vector<Vertex>& vertices,
-		const std::vector<uint32_t>& indices
+		const VertexData& vertices,
+		const std::vector<uint32_t>& indices,
+		const std::vector<scop::mesh::Meshlet>& meshlets,
+		const std::vector<scop::mesh::Lod>& lods,
+		const scop::mesh::Bounds& bounds
 	);
 	void						destroy();
 
@@ -102,6 +117,7 @@ private:
 
 	static constexpr const char*	vertex_shader_bin = "shaders/vert.spv";
 	static constexpr const char*	fragment_shader_bin = "shaders/frag.spv";
+	static constexpr const char*	depth_shader_bin = "shaders/depth.spv";
 
 	/* ========================================================================= */
 	/*                               CLASS MEMBERS                               */
@@ -123,6 +139,12 @@ private:
 
 	VkPipelineLayout				pipeline_layout;
 	VkPipeline						engine;
+	VkPipeline						depth_pipeline;
+
+	std::vector<scop::mesh::Meshlet>	meshlets;
+	std::vector<scop::mesh::Lod>		lods;
+	float								model_radius;
+	std::vector<scop::mesh::DrawRange>	draw_ranges;
 
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
@@ -132,6 +154,7 @@ private:
 
 	void							createInstance();
 	void							createGraphicsPipeline();
+	void							createDepthPipeline();
 	void							createSyncObjects();
 
 	bool							checkValidationLayerSupport();
@@ -189,6 +212,15 @@ void	copyBufferToImage(
 	uint32_t width,
 	uint32_t height
 );
+void	copyBufferToImage(
+	VkDevice device,
+	VkQueue queue,
+	VkCommandPool command_pool,
+	VkBuffer buffer,
+	VkImage image,
+	const VkBufferImageCopy* regions,
+	uint32_t nb_regions
+);
 
 } // namespace graphics
 } // namespace scop
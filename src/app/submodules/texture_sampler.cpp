@@ -15,15 +15,177 @@
 #include "image_handler.hpp"
 #include "device.hpp"
 #include "utils.hpp"
-
-#include <cmath> // std::floor
-#include <algorithm> // std::max
+#include "mipmap.hpp"
+#include "block_compression.hpp"
+#include "texture_cache.hpp"
+
+#include <algorithm> // std::min, std::max
+#include <cstring> // std::memcpy
+#include <string> // std::string
+#include <vector> // std::vector
 #include <stdexcept> // std::runtime_error
-#include <cstring> // memcpy
 
 namespace scop {
 namespace graphics {
 
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Copy of a width x height mip level, from offset in the staging
+ * buffer.
+*/
+static VkBufferImageCopy	getCopyRegion(
+	VkDeviceSize offset,
+	uint32_t mip_level,
+	std::size_t width,
+	std::size_t height
+) noexcept {
+	VkBufferImageCopy	region{};
+
+	region.bufferOffset = offset;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = mip_level;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = {
+		static_cast<uint32_t>(width),
+		static_cast<uint32_t>(height),
+		1
+	};
+	return region;
+}
+
+/**
+ * @brief Copies of the RGBA8 levels from base_level on, at their offset
+ * in the whole chain.
+*/
+static std::vector<VkBufferImageCopy>	getChainRegions(
+	const std::vector<scop::MipLevel>& levels,
+	std::size_t base_level
+) {
+	std::vector<VkBufferImageCopy>	regions;
+
+	for (std::size_t i = base_level; i < levels.size(); ++i) {
+		regions.push_back(getCopyRegion(
+			levels[i].offset * sizeof(uint32_t),
+			static_cast<uint32_t>(i - base_level),
+			levels[i].width,
+			levels[i].height
+		));
+	}
+	return regions;
+}
+
+static VkFormat	getBlockVkFormat(scop::BlockFormat format) noexcept {
+	return format == scop::BLOCK_FORMAT_BC1
+		? VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		: VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+/**
+ * @brief Whether the device can sample, linearly filtered,
+ * textures of that format.
+*/
+static bool	isBlockFormatSupported(
+	VkPhysicalDevice physical_device,
+	scop::BlockFormat format
+) {
+	const VkFormatFeatureFlags	required =
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	VkPhysicalDeviceFeatures	features;
+	VkFormatProperties			properties;
+
+	vkGetPhysicalDeviceFeatures(physical_device, &features);
+	vkGetPhysicalDeviceFormatProperties(
+		physical_device,
+		getBlockVkFormat(format),
+		&properties
+	);
+	return
+		features.textureCompressionBC &&
+		(properties.optimalTilingFeatures & required) == required;
+}
+
+/**
+ * @brief First level streamed in with the texture, the longest side
+ * of the following ones fitting SCOP_TEXTURE_STREAM_TAIL_SIZE.
+*/
+static uint32_t	getTailLevel(const std::vector<VkBufferImageCopy>& regions) noexcept {
+	uint32_t	level = static_cast<uint32_t>(regions.size() - 1);
+
+	while (
+		level > 0 &&
+		std::max(
+			regions[level - 1].imageExtent.width,
+			regions[level - 1].imageExtent.height
+		) <= SCOP_TEXTURE_STREAM_TAIL_SIZE
+	) {
+		--level;
+	}
+	return level;
+}
+
+/**
+ * @brief Compresses the whole chain in the format its alpha calls for,
+ * on every thread, and writes it to the texture cache for the next runs.
+ *
+ * @param source Key of the file the chain was decoded from.
+ * @param supported Whether the device samples each block format.
+ * @note Gives up between levels once cancelled.
+*/
+static void	cacheCompressedTexture(
+	const std::string& path,
+	const scop::utils::FileKey& source,
+	const uint32_t* chain,
+	const std::vector<scop::MipLevel>& levels,
+	const bool supported[2],
+	const std::atomic<bool>& cancelled
+) {
+	const scop::BlockFormat	format = scop::isOpaque(
+		chain,
+		levels[0].width * levels[0].height
+	) ? scop::BLOCK_FORMAT_BC1 : scop::BLOCK_FORMAT_BC7;
+
+	if (!supported[format]) {
+		return;
+	}
+
+	// Every level compressed, 16 bytes aligned in the cache
+	std::vector<scop::TextureCache::Level>	compressed_levels(levels.size());
+	std::size_t								data_size = 0;
+
+	for (std::size_t i = 0; i < levels.size(); ++i) {
+		compressed_levels[i].offset = data_size;
+		compressed_levels[i].size = scop::getCompressedSize(
+			format,
+			levels[i].width,
+			levels[i].height
+		);
+		compressed_levels[i].width = static_cast<uint32_t>(levels[i].width);
+		compressed_levels[i].height = static_cast<uint32_t>(levels[i].height);
+		data_size = (data_size + compressed_levels[i].size + 15) & ~std::size_t(15);
+	}
+
+	std::vector<uint8_t>	data(data_size);
+	for (std::size_t i = 0; i < levels.size(); ++i) {
+		if (cancelled.load(std::memory_order_relaxed)) {
+			return;
+		}
+		scop::compressImage(
+			chain + levels[i].offset,
+			levels[i].width,
+			levels[i].height,
+			format,
+			data.data() + compressed_levels[i].offset
+		);
+	}
+	scop::TextureCache::save(path, source, format, data, compressed_levels);
+}
+
 /* ========================================================================== */
 /*                                   PUBLIC                                   */
 /* ========================================================================== */
@@ -31,14 +193,76 @@ namespace graphics {
 void	TextureSampler::init(
 	Device& device,
 	VkCommandPool command_pool,
-	const scop::Image& image
+	const std::shared_ptr<const scop::Image>& image
 ) {
 	createTextureImage(device, command_pool, image);
 	createTextureImageView(device);
 	createTextureSampler(device);
 }
 
+/**
+ * @brief Uploads the levels streamed in since the last call, lowest first,
+ * SCOP_TEXTURE_STREAM_BUDGET bytes at most, and relaxes the sampler
+ * minimum lod down to them.
+ *
+ * @note The texture must not be in use by the device.
+ * @return true if the sampler was recreated, for the descriptors
+ * to be updated.
+ * @throw The error of the worker, if the image could not be decoded.
+*/
+bool	TextureSampler::update(
+	Device& device,
+	VkCommandPool command_pool
+) {
+	if (!stream) {
+		return false;
+	}
+
+	const uint32_t	ready_level = stream->ready_level.load(std::memory_order_acquire);
+	const uint32_t	end_level =
+		stream->placeholder && ready_level < mip_levels ? mip_levels : resident_level;
+	bool			updated = false;
+
+	if (ready_level < end_level) {
+		uint32_t		first_level = end_level;
+		VkDeviceSize	size = 0;
+
+		while (
+			first_level > ready_level &&
+			(first_level == end_level || size < SCOP_TEXTURE_STREAM_BUDGET)
+		) {
+			--first_level;
+			size += stream->level_sizes[first_level];
+		}
+		uploadLevels(device, command_pool, first_level, end_level);
+		resident_level = std::min(resident_level, first_level);
+		stream->placeholder = false;
+
+		vkDestroySampler(device.logical_device, vk_texture_sampler, nullptr);
+		createTextureSampler(device);
+		updated = true;
+	}
+
+	// Every level uploaded, or failed to decode
+	if (
+		stream->done.load(std::memory_order_acquire) &&
+		((resident_level == 0 && !stream->placeholder) || stream->error)
+	) {
+		const std::exception_ptr	error = stream->error;
+
+		finishStream(device);
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+	return updated;
+}
+
 void	TextureSampler::destroy(Device& device) {
+	if (stream) {
+		stream->cancelled.store(true, std::memory_order_relaxed);
+		finishStream(device);
+	}
 	vkDestroySampler(device.logical_device, vk_texture_sampler, nullptr);
 	vkDestroyImageView(device.logical_device, vk_texture_image_view, nullptr);
 	vkDestroyImage(device.logical_device, vk_texture_image, nullptr);
@@ -49,48 +273,292 @@ void	TextureSampler::destroy(Device& device) {
 /*                                   PRIVATE                                  */
 /* ========================================================================== */
 
+/**
+ * Waits for the worker, in case the texture is dropped before finishStream.
+*/
+TextureSampler::Stream::~Stream() {
+	cancelled.store(true, std::memory_order_relaxed);
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+/**
+ * @brief Runs the work of the worker thread, keeping its error for
+ * update() to rethrow, then flags the stream as done.
+*/
+template<typename Work>
+void	TextureSampler::runStream(Stream& stream, Work&& work) noexcept {
+	try {
+		work();
+	} catch (...) {
+		stream.error = std::current_exception();
+	}
+	stream.done.store(true, std::memory_order_release);
+}
+
 /**
  * Texture loader
+ *
+ * The texture image is created with its whole mip chain, but only its
+ * smallest levels are uploaded here, for rendering to start right away.
+ * The others are prepared in the staging buffer by a worker thread,
+ * then uploaded by update(), lowest first.
+ *
+ * Block compressed (BC1 when opaque, BC7 otherwise) when the texture cache
+ * is valid and the device supports its format (see texture_cache.hpp):
+ * the levels are copied from the cache mapping.
+ * RGBA8 otherwise: decoded in the staging buffer, followed by its mip
+ * levels, generated on the cpu from it (sRGB correct, see mipmap.hpp),
+ * then compressed and cached for the next runs. Until then, its smallest
+ * level is a placeholder.
+ * The levels above the device limit, or SCOP_TEXTURE_MAX_SIZE, are skipped.
 */
 void	TextureSampler::createTextureImage(
 	Device& device,
 	VkCommandPool command_pool,
-	const scop::Image& image
+	const std::shared_ptr<const scop::Image>& image
+) {
+	VkPhysicalDeviceProperties	properties{};
+	vkGetPhysicalDeviceProperties(device.physical_device, &properties);
+
+	std::size_t	max_size = properties.limits.maxImageDimension2D;
+	if (SCOP_TEXTURE_MAX_SIZE > 0) {
+		max_size = std::min<std::size_t>(max_size, SCOP_TEXTURE_MAX_SIZE);
+	}
+
+	const std::vector<scop::MipLevel>	levels = scop::getMipChain(
+		image->getWidth(),
+		image->getHeight()
+	);
+	if (levels.empty()) {
+		throw std::runtime_error("texture image is empty");
+	}
+
+	const std::size_t	base_level = scop::selectBaseLevel(levels, max_size);
+
+	stream.reset(new Stream());
+	try {
+		scop::TextureCache&	cache = stream->cache;
+
+		if (
+			SCOP_TEXTURE_COMPRESSION &&
+			!image->getPath().empty() &&
+			cache.load(image->getPath()) &&
+			cache.getWidth() == image->getWidth() &&
+			cache.getHeight() == image->getHeight() &&
+			isBlockFormatSupported(device.physical_device, cache.getFormat())
+		) {
+			streamCachedTexture(device, command_pool, base_level);
+		} else {
+			stream->image = image;
+			streamDecodedTexture(device, command_pool, levels, base_level);
+		}
+	} catch (...) {
+		stream->cancelled.store(true, std::memory_order_relaxed);
+		finishStream(device);
+		throw;
+	}
+}
+
+/**
+ * @brief Streams the compressed levels of the texture cache, copied from
+ * its mapping, packed one after the other in the staging buffer.
+*/
+void	TextureSampler::streamCachedTexture(
+	Device& device,
+	VkCommandPool command_pool,
+	std::size_t base_level
+) {
+	Stream* const									current = stream.get();
+	const std::vector<scop::TextureCache::Level>&	levels = current->cache.getLevels();
+	VkDeviceSize									size = 0;
+
+	// Levels sizes are whole blocks: offsets stay block aligned
+	for (std::size_t i = base_level; i < levels.size(); ++i) {
+		current->regions.push_back(getCopyRegion(
+			size,
+			static_cast<uint32_t>(i - base_level),
+			levels[i].width,
+			levels[i].height
+		));
+		current->level_sizes.push_back(levels[i].size);
+		size += levels[i].size;
+	}
+
+	auto	copyLevel = [current, base_level](uint32_t level) {
+		const scop::TextureCache::Level&	source =
+			current->cache.getLevels()[base_level + level];
+
+		std::memcpy(
+			current->data + current->regions[level].bufferOffset,
+			current->cache.getData() + source.offset,
+			source.size
+		);
+	};
+
+	// Tail first
+	const uint32_t	tail_level = getTailLevel(current->regions);
+
+	createStagingBuffer(device, size, 0);
+	for (uint32_t i = tail_level; i < current->regions.size(); ++i) {
+		copyLevel(i);
+	}
+	createStreamedImage(
+		device,
+		command_pool,
+		getBlockVkFormat(current->cache.getFormat()),
+		tail_level
+	);
+	current->ready_level.store(tail_level, std::memory_order_relaxed);
+
+	// Then the larger levels, each published once copied
+	current->worker = std::thread([current, copyLevel]() {
+		runStream(*current, [current, &copyLevel]() {
+			uint32_t	level = current->ready_level.load(std::memory_order_relaxed);
+
+			while (level > 0 && !current->cancelled.load(std::memory_order_relaxed)) {
+				copyLevel(--level);
+				current->ready_level.store(level, std::memory_order_release);
+			}
+		});
+	});
+}
+
+/**
+ * @brief Streams the RGBA8 chain, decoded then generated in the staging
+ * buffer, all its levels published at once.
+ *
+ * @note The chain is then compressed and cached, from the staging buffer,
+ * which is read back: cached memory if any.
+*/
+void	TextureSampler::streamDecodedTexture(
+	Device& device,
+	VkCommandPool command_pool,
+	const std::vector<scop::MipLevel>& levels,
+	std::size_t base_level
 ) {
-	mip_levels = 1 + static_cast<uint32_t>(
-		std::floor(std::log2(std::max(
-			image.getWidth(),
-			image.getHeight()
-		)))
+	Stream* const	current = stream.get();
+
+	current->regions = getChainRegions(levels, base_level);
+	for (std::size_t i = base_level; i < levels.size(); ++i) {
+		current->level_sizes.push_back(
+			levels[i].width * levels[i].height * sizeof(uint32_t)
+		);
+	}
+
+	// Placeholder in the last level, 1x1
+	createStagingBuffer(
+		device,
+		scop::getMipChainSize(levels) * sizeof(uint32_t),
+		VK_MEMORY_PROPERTY_HOST_CACHED_BIT
 	);
+	*reinterpret_cast<uint32_t*>(
+		current->data + current->regions.back().bufferOffset
+	) = SCOP_TEXTURE_PLACEHOLDER;
+
+	const uint32_t	last_level = static_cast<uint32_t>(current->regions.size() - 1);
+
+	createStreamedImage(device, command_pool, VK_FORMAT_R8G8B8A8_SRGB, last_level);
+	current->placeholder = true;
+	current->ready_level.store(last_level + 1, std::memory_order_relaxed);
+
+	// Cached compressed if the device can use it, keyed on the file
+	// the pixels are decoded from, when they are
+	scop::utils::FileKey	source;
+	const std::string		path =
+		SCOP_TEXTURE_COMPRESSION && current->image->getSourceKey(source)
+		? current->image->getPath()
+		: std::string();
+	const bool				supported[2] = {
+		isBlockFormatSupported(device.physical_device, scop::BLOCK_FORMAT_BC1),
+		isBlockFormatSupported(device.physical_device, scop::BLOCK_FORMAT_BC7)
+	};
+
+	current->worker = std::thread([current, levels, path, source, supported]() {
+		runStream(*current, [&]() {
+			uint32_t*	chain = reinterpret_cast<uint32_t*>(current->data);
+
+			current->image->writePixels(chain);
+			current->image.reset();
+			if (current->cancelled.load(std::memory_order_relaxed)) {
+				return;
+			}
+			scop::generateMipChain(chain, levels);
+			current->ready_level.store(0, std::memory_order_release);
+
+			if (!path.empty()) {
+				cacheCompressedTexture(
+					path,
+					source,
+					chain,
+					levels,
+					supported,
+					current->cancelled
+				);
+			}
+		});
+	});
+}
 
-	VkDeviceSize	image_size = image.getWidth() * image.getHeight() * sizeof(uint32_t);
-	VkBuffer		staging_buffer;
-	VkDeviceMemory	staging_buffer_memory;
+/**
+ * @brief Staging buffer of the stream, mapped until it is finished.
+ *
+ * @param preferred_memory Memory properties used if available.
+*/
+void	TextureSampler::createStagingBuffer(
+	Device& device,
+	VkDeviceSize size,
+	VkMemoryPropertyFlags preferred_memory
+) {
+	void*	data;
 
 	device.createBuffer(
-		image_size,
+		size,
 		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		staging_buffer,
-		staging_buffer_memory
+		stream->staging_buffer,
+		stream->staging_buffer_memory,
+		preferred_memory
+	);
+	vkMapMemory(
+		device.logical_device,
+		stream->staging_buffer_memory,
+		0,
+		size,
+		0,
+		&data
 	);
+	stream->data = static_cast<uint8_t*>(data);
+}
 
-	// Map buffer, copy image load into buffer
-	void*	data;
-	vkMapMemory(device.logical_device, staging_buffer_memory, 0, image_size, 0, &data);
-	memcpy(data, image.getPixels(), static_cast<std::size_t>(image_size));
-	vkUnmapMemory(device.logical_device, staging_buffer_memory);
+/**
+ * @brief Creates the texture image, one mip level per region of the stream,
+ * and uploads the levels from tail_level on, already in the staging buffer.
+ *
+ * @note The levels yet to be streamed are left undefined, in the shader
+ * read layout as well, the sampler not reaching them.
+*/
+void	TextureSampler::createStreamedImage(
+	Device& device,
+	VkCommandPool command_pool,
+	VkFormat format,
+	uint32_t tail_level
+) {
+	const std::vector<VkBufferImageCopy>&	regions = stream->regions;
+
+	mip_levels = static_cast<uint32_t>(regions.size());
+	resident_level = tail_level;
+	texture_format = format;
 
 	// Create texture image to be filled
 	device.createImage(
-		image.getWidth(),
-		image.getHeight(),
+		regions[0].imageExtent.width,
+		regions[0].imageExtent.height,
 		mip_levels,
 		VK_SAMPLE_COUNT_1_BIT,
-		VK_FORMAT_R8G8B8A8_SRGB,
+		texture_format,
 		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
 		VK_IMAGE_USAGE_TRANSFER_DST_BIT |
 		VK_IMAGE_USAGE_SAMPLED_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
@@ -98,13 +566,13 @@ void	TextureSampler::createTextureImage(
 		vk_texture_image_memory
 	);
 
-	// Copy staging buffer to texture image
+	// Copy staging buffer tail to texture image
 	transitionImageLayout(
 		device.logical_device,
 		command_pool,
 		device.graphics_queue,
 		vk_texture_image,
-		VK_FORMAT_R8G8B8A8_SRGB,
+		texture_format,
 		VK_IMAGE_LAYOUT_UNDEFINED,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		mip_levels
@@ -113,25 +581,81 @@ void	TextureSampler::createTextureImage(
 		device.logical_device,
 		device.graphics_queue,
 		command_pool,
-		staging_buffer,
+		stream->staging_buffer,
 		vk_texture_image,
-		static_cast<uint32_t>(image.getWidth()),
-		static_cast<uint32_t>(image.getHeight())
+		regions.data() + tail_level,
+		mip_levels - tail_level
 	);
-
-	// Fill mipmaps images (directly handled by gpu)
-	generateMipmaps(
-		device,
+	transitionImageLayout(
+		device.logical_device,
 		command_pool,
+		device.graphics_queue,
 		vk_texture_image,
-		VK_FORMAT_R8G8B8A8_SRGB,
-		image.getWidth(),
-		image.getHeight(),
+		texture_format,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 		mip_levels
 	);
+}
+
+/**
+ * @brief Uploads the levels [first_level, end_level) from the staging
+ * buffer, their previous content discarded.
+*/
+void	TextureSampler::uploadLevels(
+	Device& device,
+	VkCommandPool command_pool,
+	uint32_t first_level,
+	uint32_t end_level
+) {
+	const uint32_t	nb_levels = end_level - first_level;
+
+	transitionImageLayout(
+		device.logical_device,
+		command_pool,
+		device.graphics_queue,
+		vk_texture_image,
+		texture_format,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		nb_levels,
+		first_level
+	);
+	copyBufferToImage(
+		device.logical_device,
+		device.graphics_queue,
+		command_pool,
+		stream->staging_buffer,
+		vk_texture_image,
+		stream->regions.data() + first_level,
+		nb_levels
+	);
+	transitionImageLayout(
+		device.logical_device,
+		command_pool,
+		device.graphics_queue,
+		vk_texture_image,
+		texture_format,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		nb_levels,
+		first_level
+	);
+}
 
-	vkDestroyBuffer(device.logical_device, staging_buffer, nullptr);
-	vkFreeMemory(device.logical_device, staging_buffer_memory, nullptr);
+/**
+ * @brief Waits for the worker, then frees the staging buffer.
+*/
+void	TextureSampler::finishStream(Device& device) {
+	if (stream->worker.joinable()) {
+		stream->worker.join();
+	}
+	if (stream->data != nullptr) {
+		vkUnmapMemory(device.logical_device, stream->staging_buffer_memory);
+	}
+	vkDestroyBuffer(device.logical_device, stream->staging_buffer, nullptr);
+	vkFreeMemory(device.logical_device, stream->staging_buffer_memory, nullptr);
+	stream.reset();
 }
 
 /**
@@ -141,7 +665,7 @@ void	TextureSampler::createTextureImageView(Device& device) {
 	vk_texture_image_view = createImageView(
 		device.logical_device,
 		vk_texture_image,
-		VK_FORMAT_R8G8B8A8_SRGB,
+		texture_format,
 		VK_IMAGE_ASPECT_COLOR_BIT,
 		mip_levels
 	);
@@ -171,7 +695,8 @@ void	TextureSampler::createTextureSampler(
 	sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
 	sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	sampler_info.mipLodBias = 0.0f;
-	sampler_info.minLod = 0.0f;
+	// Levels not streamed in yet are never sampled
+	sampler_info.minLod = static_cast<float>(resident_level);
 	sampler_info.maxLod = static_cast<float>(mip_levels);
 
 	if (vkCreateSampler(device.logical_device, &sampler_info, nullptr, &vk_texture_sampler) != VK_SUCCESS) {
@@ -179,152 +704,6 @@ void	TextureSampler::createTextureSampler(
 	}
 }
 
-/**
- * Record command to generate mipmaps levels
-*/
-void	TextureSampler::generateMipmaps(
-	Device& device,
-	VkCommandPool command_pool,
-	VkImage image,
-	VkFormat image_format,
-	int32_t tex_width,
-	int32_t tex_height,
-	uint32_t mip_level
-) const {
-	// Check if support blitting
-	VkFormatProperties	properties;
-	vkGetPhysicalDeviceFormatProperties(device.physical_device, image_format, &properties);
-
-	if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-		throw std::runtime_error("texture image format doesn't support linear blitting");
-	}
-
-	VkCommandBuffer	command_buffer = beginSingleTimeCommands(
-		device.logical_device,
-		command_pool
-	);
-
-	VkImageMemoryBarrier	barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.image = image;
-	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
-	barrier.subresourceRange.levelCount = 1;
-
-	int32_t	mip_width = tex_width;
-	int32_t	mip_height = tex_height;
-
-	// Redefine parts of barrier for each level
-	for (uint32_t i = 1; i < mip_level; ++i) {
-		barrier.subresourceRange.baseMipLevel = i - 1;
-		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-		vkCmdPipelineBarrier(
-			command_buffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			0,
-			0,
-			nullptr,
-			0,
-			nullptr,
-			1,
-			&barrier
-		);
-
-		// Define blit region
-		VkImageBlit	blit{};
-		blit.srcOffsets[0] = { 0, 0, 0 };
-		blit.srcOffsets[1] = { mip_width, mip_height, 1 };
-		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		blit.srcSubresource.mipLevel = i - 1;
-		blit.srcSubresource.baseArrayLayer = 0;
-		blit.srcSubresource.layerCount = 1;
-		blit.dstOffsets[0] = { 0, 0, 0 };
-		blit.dstOffsets[1] = {
-			mip_width > 1 ? mip_width / 2 : 1,
-			mip_height > 1 ? mip_height / 2: 1,
-			1
-		};
-		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		blit.dstSubresource.mipLevel = i;
-		blit.dstSubresource.baseArrayLayer = 0;
-		blit.dstSubresource.layerCount = 1;
-
-		// Record blit command
-		vkCmdBlitImage(
-			command_buffer,
-			image,
-			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			image,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&blit,
-			VK_FILTER_LINEAR
-		);
-
-		// Transition to shader readable layout
-		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		vkCmdPipelineBarrier(
-			command_buffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			0,
-			0,
-			nullptr,
-			0,
-			nullptr,
-			1,
-			&barrier
-		);
-
-		// Set next mip level size
-		if (mip_width > 1) {
-			mip_width /= 2;
-		}
-		if (mip_height > 1) {
-			mip_height /= 2;
-		}
-	}
-
-	// Last mip level
-	barrier.subresourceRange.baseMipLevel = mip_level - 1;
-	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-	vkCmdPipelineBarrier(
-		command_buffer,
-		VK_PIPELINE_STAGE_TRANSFER_BIT,
-		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		0,
-		0,
-		nullptr,
-		0,
-		nullptr,
-		1,
-		&barrier
-	);
-
-	endSingleTimeCommands(
-		device.logical_device,
-		device.graphics_queue,
-		command_pool,
-		command_buffer
-	);
-}
-
 /* ========================================================================== */
 /*                                    OTHER                                   */
 /* ========================================================================== */
@@ -337,7 +716,8 @@ void	transitionImageLayout(
 	VkFormat format,
 	VkImageLayout old_layout,
 	VkImageLayout new_layout,
-	uint32_t mip_level
+	uint32_t mip_level,
+	uint32_t base_mip_level
 ) {
 	(void)format;
 	VkCommandBuffer	command_buffer = beginSingleTimeCommands(
@@ -354,7 +734,7 @@ void	transitionImageLayout(
 	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	barrier.image = image;
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.baseMipLevel = base_mip_level;
 	barrier.subresourceRange.levelCount = mip_level;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
@@ -18,6 +18,32 @@
 
 # include <GLFW/glfw3.h>
 
+// Std
+# include <atomic> // std::atomic
+# include <exception> // std::exception_ptr
+# include <memory> // std::shared_ptr, std::unique_ptr
+# include <thread> // std::thread
+# include <vector> // std::vector
+
+# include "mipmap.hpp"
+# include "texture_cache.hpp"
+
+/**
+ * Levels this size or smaller (pixels, on the longest side) are uploaded
+ * with the texture, the larger ones streamed in afterwards.
+*/
+# define SCOP_TEXTURE_STREAM_TAIL_SIZE 64
+
+/**
+ * Bytes of streamed levels uploaded per frame, one level at least.
+*/
+# define SCOP_TEXTURE_STREAM_BUDGET (1 << 24)
+
+/**
+ * Color shown until the texture is decoded (ABGR).
+*/
+# define SCOP_TEXTURE_PLACEHOLDER 0xff808080
+
 namespace scop {
 class Image;
 
@@ -46,21 +72,58 @@ public:
 	void							init(
 		Device& device,
 		VkCommandPool command_pool,
-		const scop::Image& image
+		const std::shared_ptr<const scop::Image>& image
+	);
+	bool							update(
+		Device& device,
+		VkCommandPool command_pool
 	);
 
 	void							destroy(Device& device);
 	
 private:
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	/**
+	 * Levels prepared in the staging buffer by the worker thread,
+	 * from the last one down to ready_level, for update() to upload.
+	*/
+	struct Stream {
+		std::shared_ptr<const scop::Image>	image;
+		scop::TextureCache					cache;
+
+		VkBuffer							staging_buffer = VK_NULL_HANDLE;
+		VkDeviceMemory						staging_buffer_memory = VK_NULL_HANDLE;
+		uint8_t*							data = nullptr;
+		std::vector<VkBufferImageCopy>		regions;
+		std::vector<VkDeviceSize>			level_sizes;
+
+		// Smallest level holding the placeholder, to be replaced
+		bool								placeholder = false;
+
+		std::thread							worker;
+		std::atomic<uint32_t>				ready_level{0};
+		std::atomic<bool>					done{false};
+		std::atomic<bool>					cancelled{false};
+		std::exception_ptr					error;
+
+		~Stream();
+	};
+
 	/* ========================================================================= */
 	/*                                CLASS MEMBER                               */
 	/* ========================================================================= */
 
 	uint32_t						mip_levels;
+	uint32_t						resident_level;
+	VkFormat						texture_format;
 	VkImage							vk_texture_image;
 	VkDeviceMemory					vk_texture_image_memory;
 	VkImageView						vk_texture_image_view;
 	VkSampler 						vk_texture_sampler;
+	std::unique_ptr<Stream>			stream;
 
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
@@ -69,21 +132,44 @@ private:
 	void							createTextureImage(
 		Device& device,
 		VkCommandPool command_pool,
-		const scop::Image& image
+		const std::shared_ptr<const scop::Image>& image
+	);
+	void							streamCachedTexture(
+		Device& device,
+		VkCommandPool command_pool,
+		std::size_t base_level
 	);
+	void							streamDecodedTexture(
+		Device& device,
+		VkCommandPool command_pool,
+		const std::vector<scop::MipLevel>& levels,
+		std::size_t base_level
+	);
+	void							createStagingBuffer(
+		Device& device,
+		VkDeviceSize size,
+		VkMemoryPropertyFlags preferred_memory
+	);
+	void							createStreamedImage(
+		Device& device,
+		VkCommandPool command_pool,
+		VkFormat format,
+		uint32_t tail_level
+	);
+	void							uploadLevels(
+		Device& device,
+		VkCommandPool command_pool,
+		uint32_t first_level,
+		uint32_t end_level
+	);
+	void							finishStream(Device& device);
+	template<typename Work>
+	static void						runStream(Stream& stream, Work&& work) noexcept;
+
 	void							createTextureImageView(Device& device);
 	void							createTextureSampler(
 		Device& device
 	);
-	void							generateMipmaps(
-		Device& device,
-		VkCommandPool command_pool,
-		VkImage image,
-		VkFormat image_format,
-		int32_t tex_width,
-		int32_t tex_height,
-		uint32_t mip_level
-	) const;
 
 }; // class TextureSampler
 
@@ -99,7 +185,8 @@ void	transitionImageLayout(
 	VkFormat format,
 	VkImageLayout old_layout,
 	VkImageLayout new_layout,
-	uint32_t mip_level
+	uint32_t mip_level,
+	uint32_t base_mip_level = 0
 );
 
 } // namespace graphics
@@ -15,6 +15,8 @@
 #include "device.hpp"
 
 #include <cstring> // memcpy
+#include <limits> // std::numeric_limits
+#include <stdexcept> // std::runtime_error
 
 namespace scop {
 namespace graphics {
@@ -23,14 +25,35 @@ namespace graphics {
 /*                                   PUBLIC                                   */
 /* ========================================================================== */
 
+std::size_t	VertexData::size() const noexcept {
+	return cache != nullptr ? cache->getNbVertices() : vertices->size();
+}
+
+/**
+ * @brief Writes the size() vertices to dst in the gpu layout,
+ * decoded from the cache, or laid out from the cpu ones.
+ *
+ * @return Their quantization.
+*/
+scop::mesh::Quantization	VertexData::write(GpuVertex* dst) const {
+	if (cache == nullptr) {
+		return scop::mesh::layoutVertices(*vertices, dst);
+	} else if (!cache->decodeVertices(dst)) {
+		throw std::runtime_error("Corrupted mesh cache vertices");
+	}
+	return cache->getQuantization();
+}
+
+/* ========================================================================== */
+
 void	VertexInput::init(
 	Device& device,
 	VkCommandPool command_pool,
-	const std::vector<Vertex>& vertices,
+	const VertexData& vertices,
 	const std::vector<uint32_t>& indices
 ) {
 	createVertexBuffer(device, command_pool, vertices);
-	createIndexBuffer(device, command_pool, indices);
+	createIndexBuffer(device, command_pool, indices, vertices.size());
 }
 
 void	VertexInput::destroy(Device& device) {
@@ -40,19 +63,63 @@ void	VertexInput::destroy(Device& device) {
 	vkFreeMemory(device.logical_device, vertex_buffer_memory, nullptr);
 }
 
+/* ========================================================================== */
+
+/**
+ * @brief Start of the attributes stream in the vertex buffer, 16 bytes
+ * aligned after the positions with split streams, else 0.
+*/
+VkDeviceSize	VertexInput::getAttributesOffset(std::size_t nb_vertices) noexcept {
+	return GpuStreams::split ?
+		(GpuStreams::position_size * nb_vertices + 15) & ~VkDeviceSize(15) :
+		0;
+}
+
+VkDeviceSize	VertexInput::getVertexBufferSize(std::size_t nb_vertices) noexcept {
+	return GpuStreams::split ?
+		getAttributesOffset(nb_vertices) + GpuStreams::attributes_size * nb_vertices :
+		sizeof(GpuVertex) * nb_vertices;
+}
+
+/**
+ * @brief 16 bits indices when all the vertices can be addressed, else 32 bits.
+*/
+VkIndexType	VertexInput::getIndexType(std::size_t nb_vertices) noexcept {
+	return nb_vertices <= std::numeric_limits<uint16_t>::max() + 1UL ?
+		VK_INDEX_TYPE_UINT16 :
+		VK_INDEX_TYPE_UINT32;
+}
+
+VkDeviceSize	VertexInput::getIndexBufferSize(
+	std::size_t nb_indices,
+	std::size_t nb_vertices
+) noexcept {
+	return (getIndexType(nb_vertices) == VK_INDEX_TYPE_UINT16 ?
+		sizeof(uint16_t) :
+		sizeof(uint32_t)) * nb_indices;
+}
+
 /* ========================================================================== */
 /*                                   PRIVATE                                  */
 /* ========================================================================== */
 
 /**
  * Create the vertex buffer that'll be used to store the vertices of the triangle.
+ *
+ * @note Vertices are written in the gpu layout directly into the staging
+ * buffer, quantized or decoded from the mesh cache.
+ * With split streams, the attributes follow the positions
+ * in the same buffer, from attributes_offset.
 */
 void	VertexInput::createVertexBuffer(
 	Device& device,
 	VkCommandPool command_pool,
-	const std::vector<Vertex>& vertices
+	const VertexData& vertices
 ) {
-	VkDeviceSize	buffer_size = sizeof(Vertex) * vertices.size();
+	const std::size_t	nb_vertices = vertices.size();
+
+	attributes_offset = getAttributesOffset(nb_vertices);
+	VkDeviceSize	buffer_size = getVertexBufferSize(nb_vertices);
 
 	// Create staging buffer to upload cpu memory to
 	VkBuffer		staging_buffer;
@@ -70,7 +137,14 @@ void	VertexInput::createVertexBuffer(
 	// Fill staging buffer
 	void*	data;
 	vkMapMemory(device.logical_device, staging_buffer_memory, 0, buffer_size, 0, &data);
-	memcpy(data, vertices.data(), static_cast<std::size_t>(buffer_size));
+	void*	attributes = static_cast<char*>(data) + attributes_offset;
+	if constexpr (GpuStreams::split) {
+		std::vector<GpuVertex>	interleaved(nb_vertices);
+		quantization = vertices.write(interleaved.data());
+		GpuStreams::splitVertices(interleaved.data(), nb_vertices, data, attributes);
+	} else {
+		quantization = vertices.write(static_cast<GpuVertex*>(data));
+	}
 	vkUnmapMemory(device.logical_device, staging_buffer_memory);
 
 	// Create vertex buffer that'll interact with gpu
@@ -99,13 +173,19 @@ void	VertexInput::createVertexBuffer(
 
 /**
  *  Create index buffer (pointers into the vertex buffer)
+ *
+ *  @note Indices are narrowed to 16 bits when all vertices can be addressed.
  */
 void	VertexInput::createIndexBuffer(
 	Device& device,
 	VkCommandPool command_pool,
-	const std::vector<uint32_t>& indices
+	const std::vector<uint32_t>& indices,
+	std::size_t nb_vertices
 ) {
-	VkDeviceSize	buffer_size = sizeof(uint32_t) * indices.size();
+	index_type = getIndexType(nb_vertices);
+
+	const bool		narrow = index_type == VK_INDEX_TYPE_UINT16;
+	VkDeviceSize	buffer_size = getIndexBufferSize(indices.size(), nb_vertices);
 	VkBuffer		staging_buffer;
 	VkDeviceMemory	staging_buffer_memory;
 
@@ -120,7 +200,14 @@ void	VertexInput::createIndexBuffer(
 	// Fill staging buffer with indices
 	void*	data;
 	vkMapMemory(device.logical_device, staging_buffer_memory, 0, buffer_size, 0, &data);
-	memcpy(data, indices.data(), static_cast<std::size_t>(buffer_size));
+	if (narrow) {
+		uint16_t*	narrow_indices = static_cast<uint16_t*>(data);
+		for (std::size_t i = 0; i < indices.size(); ++i) {
+			narrow_indices[i] = static_cast<uint16_t>(indices[i]);
+		}
+	} else {
+		memcpy(data, indices.data(), static_cast<std::size_t>(buffer_size));
+	}
 	vkUnmapMemory(device.logical_device, staging_buffer_memory);
 
 	device.createBuffer(
@@ -23,12 +23,26 @@
 # include <vector>
 # include "vertex.hpp"
 # include "vector.hpp"
+# include "quantization.hpp"
+# include "mesh_cache.hpp"
 
 namespace scop {
 namespace graphics {
 class Engine;
 class Device;
 
+/**
+ * Vertices to upload: built on the cpu, or decoded from the mesh cache
+ * already in the gpu layout.
+*/
+struct VertexData {
+	const std::vector<Vertex>*		vertices = nullptr;
+	const scop::obj::MeshCache*		cache = nullptr;
+
+	std::size_t						size() const noexcept;
+	scop::mesh::Quantization		write(GpuVertex* dst) const;
+};
+
 class VertexInput {
 public:
 	friend Engine;
@@ -49,11 +63,19 @@ public:
 	void	init(
 		Device& device,
 		VkCommandPool command_pool,
-		const std::vector<Vertex>& vertices,
+		const VertexData& vertices,
 		const std::vector<uint32_t>& indices
 	);
 	void	destroy(Device& device);
 
+	static VkDeviceSize				getAttributesOffset(std::size_t nb_vertices) noexcept;
+	static VkDeviceSize				getVertexBufferSize(std::size_t nb_vertices) noexcept;
+	static VkIndexType				getIndexType(std::size_t nb_vertices) noexcept;
+	static VkDeviceSize				getIndexBufferSize(
+		std::size_t nb_indices,
+		std::size_t nb_vertices
+	) noexcept;
+
 private:
 	/* ========================================================================= */
 	/*                               CLASS MEMBERS                               */
@@ -61,8 +83,11 @@ private:
 
 	VkBuffer						vertex_buffer;
 	VkDeviceMemory					vertex_buffer_memory;
+	VkDeviceSize					attributes_offset;
 	VkBuffer						index_buffer;
 	VkDeviceMemory					index_buffer_memory;
+	VkIndexType						index_type;
+	scop::mesh::Quantization		quantization;
 
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
@@ -71,12 +96,13 @@ private:
 	void							createVertexBuffer(
 		Device& device,
 	VkCommandPool command_pool,
-		const std::vector<Vertex>& vertices
+		const VertexData& vertices
 	);
 	void							createIndexBuffer(
 		Device& device,
 	VkCommandPool command_pool,
-		const std::vector<uint32_t>& indices
+		const std::vector<uint32_t>& indices,
+		std::size_t nb_vertices
 	);
 
 }; // class VertexInput
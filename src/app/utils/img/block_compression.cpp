@@ -0,0 +1,566 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   block_compression.cpp                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 16:04:12 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 16:04:12 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "block_compression.hpp"
+#include "parallel.hpp"
+
+#include <algorithm> // std::min, std::max, std::swap
+#include <cmath> // std::sqrt, std::fabs, std::lround
+#include <cstring> // std::memset, std::memcpy
+
+namespace scop {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Pixels of a 4x4 block, row by row, one float per channel (RGBA).
+*/
+struct Block {
+	float	pixels[16][4];
+};
+
+/**
+ * @brief Block (bx, by) of the image, the last row and column being
+ * repeated past its edges.
+*/
+static void	loadBlock(
+	const uint32_t* pixels,
+	std::size_t width,
+	std::size_t height,
+	std::size_t bx,
+	std::size_t by,
+	Block& block
+) noexcept {
+	for (std::size_t i = 0; i < 16; ++i) {
+		const std::size_t	x = std::min(bx * 4 + i % 4, width - 1);
+		const std::size_t	y = std::min(by * 4 + i / 4, height - 1);
+		const uint32_t		pixel = pixels[y * width + x];
+
+		for (std::size_t c = 0; c < 4; ++c) {
+			block.pixels[i][c] = static_cast<float>((pixel >> (c * 8)) & 0xff);
+		}
+	}
+}
+
+/**
+ * @brief Line best fitting the first nb_channels channels of the block:
+ * their mean and principal axis (unit length, null for a uniform block).
+ *
+ * @note Power iteration on the covariance, started from its row of
+ * largest variance.
+*/
+template<std::size_t nb_channels>
+static void	getPrincipalAxis(
+	const Block& block,
+	float mean[4],
+	float axis[4]
+) noexcept {
+	float	covariance[4][4] = {};
+
+	for (std::size_t c = 0; c < 4; ++c) {
+		mean[c] = 0.0f;
+		axis[c] = 0.0f;
+	}
+	for (std::size_t i = 0; i < 16; ++i) {
+		for (std::size_t c = 0; c < nb_channels; ++c) {
+			mean[c] += block.pixels[i][c] / 16.0f;
+		}
+	}
+	for (std::size_t i = 0; i < 16; ++i) {
+		float	delta[4];
+		for (std::size_t c = 0; c < nb_channels; ++c) {
+			delta[c] = block.pixels[i][c] - mean[c];
+		}
+		for (std::size_t a = 0; a < nb_channels; ++a) {
+			for (std::size_t b = 0; b < nb_channels; ++b) {
+				covariance[a][b] += delta[a] * delta[b];
+			}
+		}
+	}
+
+	std::size_t	largest = 0;
+	for (std::size_t c = 1; c < nb_channels; ++c) {
+		if (covariance[c][c] > covariance[largest][largest]) {
+			largest = c;
+		}
+	}
+	for (std::size_t c = 0; c < nb_channels; ++c) {
+		axis[c] = covariance[largest][c];
+	}
+
+	for (std::size_t iteration = 0; iteration < 8; ++iteration) {
+		float	next[4] = {};
+		float	norm = 0.0f;
+
+		for (std::size_t a = 0; a < nb_channels; ++a) {
+			for (std::size_t b = 0; b < nb_channels; ++b) {
+				next[a] += covariance[a][b] * axis[b];
+			}
+			norm = std::max(norm, std::fabs(next[a]));
+		}
+		if (norm == 0.0f) {
+			return;
+		}
+		for (std::size_t c = 0; c < nb_channels; ++c) {
+			axis[c] = next[c] / norm;
+		}
+	}
+
+	float	length = 0.0f;
+	for (std::size_t c = 0; c < nb_channels; ++c) {
+		length += axis[c] * axis[c];
+	}
+	length = std::sqrt(length);
+	for (std::size_t c = 0; c < nb_channels; ++c) {
+		axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+	}
+}
+
+/**
+ * @brief Ends of the principal axis of the block, within [0, 255]:
+ * high on the largest projection, low on the smallest.
+*/
+template<std::size_t nb_channels>
+static void	getEndpoints(
+	const Block& block,
+	float high[4],
+	float low[4]
+) noexcept {
+	float	mean[4];
+	float	axis[4];
+	float	min_t = 0.0f;
+	float	max_t = 0.0f;
+
+	getPrincipalAxis<nb_channels>(block, mean, axis);
+	for (std::size_t i = 0; i < 16; ++i) {
+		float	t = 0.0f;
+		for (std::size_t c = 0; c < nb_channels; ++c) {
+			t += (block.pixels[i][c] - mean[c]) * axis[c];
+		}
+		min_t = std::min(min_t, t);
+		max_t = std::max(max_t, t);
+	}
+	for (std::size_t c = 0; c < 4; ++c) {
+		high[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * max_t));
+		low[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * min_t));
+	}
+}
+
+/**
+ * @brief Least squares endpoints for the interpolation weights of the
+ * block pixels, weights[i] being the share of the second endpoint.
+ *
+ * @return false if the weights do not constrain both endpoints.
+*/
+template<std::size_t nb_channels>
+static bool	solveEndpoints(
+	const Block& block,
+	const float weights[16],
+	float first[4],
+	float second[4]
+) noexcept {
+	float	aa = 0.0f;
+	float	ab = 0.0f;
+	float	bb = 0.0f;
+	float	ax[4] = {};
+	float	bx[4] = {};
+
+	for (std::size_t i = 0; i < 16; ++i) {
+		const float	b = weights[i];
+		const float	a = 1.0f - b;
+
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (std::size_t c = 0; c < nb_channels; ++c) {
+			ax[c] += a * block.pixels[i][c];
+			bx[c] += b * block.pixels[i][c];
+		}
+	}
+
+	const float	determinant = aa * bb - ab * ab;
+	if (std::fabs(determinant) < 1e-6f) {
+		return false;
+	}
+	for (std::size_t c = 0; c < 4; ++c) {
+		first[c] = 0.0f;
+		second[c] = 0.0f;
+	}
+	for (std::size_t c = 0; c < nb_channels; ++c) {
+		first[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+		second[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+		first[c] = std::min(255.0f, std::max(0.0f, first[c]));
+		second[c] = std::min(255.0f, std::max(0.0f, second[c]));
+	}
+	return true;
+}
+
+/* BC1 ====================================================================== */
+
+/**
+ * Endpoints and indices of a BC1 block, with their squared error.
+*/
+struct Bc1Fit {
+	uint16_t	color0;
+	uint16_t	color1;
+	uint32_t	indices;
+	float		error;
+};
+
+static uint16_t	toRgb565(const float color[4]) noexcept {
+	const uint16_t	r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+	const uint16_t	g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+	const uint16_t	b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+
+	return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+static void	fromRgb565(uint16_t color, int rgb[3]) noexcept {
+	const int	r = (color >> 11) & 0x1f;
+	const int	g = (color >> 5) & 0x3f;
+	const int	b = color & 0x1f;
+
+	rgb[0] = r << 3 | r >> 2;
+	rgb[1] = g << 2 | g >> 4;
+	rgb[2] = b << 3 | b >> 2;
+}
+
+/**
+ * @brief Nearest of the 4 palette colors for each pixel, in the 4 colors
+ * mode (color0 > color1, the endpoints are swapped otherwise).
+ *
+ * @note Equal endpoints select the 3 colors mode, where only index 0
+ * is safe to use.
+*/
+static Bc1Fit	fitBc1(const Block& block, uint16_t color0, uint16_t color1) noexcept {
+	Bc1Fit	fit = { std::max(color0, color1), std::min(color0, color1), 0, 0.0f };
+	int		palette[4][3];
+
+	fromRgb565(fit.color0, palette[0]);
+	fromRgb565(fit.color1, palette[1]);
+	for (std::size_t c = 0; c < 3; ++c) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	const uint32_t	nb_colors = fit.color0 == fit.color1 ? 1 : 4;
+	for (std::size_t i = 0; i < 16; ++i) {
+		uint32_t	best = 0;
+		float		best_error = 0.0f;
+
+		for (uint32_t index = 0; index < nb_colors; ++index) {
+			float	error = 0.0f;
+			for (std::size_t c = 0; c < 3; ++c) {
+				const float	delta = block.pixels[i][c] - palette[index][c];
+				error += delta * delta;
+			}
+			if (index == 0 || error < best_error) {
+				best = index;
+				best_error = error;
+			}
+		}
+		fit.indices |= best << (i * 2);
+		fit.error += best_error;
+	}
+	return fit;
+}
+
+/**
+ * @brief Principal axis endpoints, then refined once by least squares
+ * on the indices they gave.
+*/
+static void	encodeBc1Block(const Block& block, uint8_t* dst) noexcept {
+	static constexpr float	weights_of[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	float					high[4];
+	float					low[4];
+
+	getEndpoints<3>(block, high, low);
+	Bc1Fit	fit = fitBc1(block, toRgb565(high), toRgb565(low));
+
+	if (fit.color0 != fit.color1) {
+		float	weights[16];
+		for (std::size_t i = 0; i < 16; ++i) {
+			weights[i] = weights_of[(fit.indices >> (i * 2)) & 3];
+		}
+		if (solveEndpoints<3>(block, weights, high, low)) {
+			const Bc1Fit	refined = fitBc1(block, toRgb565(high), toRgb565(low));
+			if (refined.error < fit.error) {
+				fit = refined;
+			}
+		}
+	}
+
+	dst[0] = static_cast<uint8_t>(fit.color0);
+	dst[1] = static_cast<uint8_t>(fit.color0 >> 8);
+	dst[2] = static_cast<uint8_t>(fit.color1);
+	dst[3] = static_cast<uint8_t>(fit.color1 >> 8);
+	for (std::size_t i = 0; i < 4; ++i) {
+		dst[4 + i] = static_cast<uint8_t>(fit.indices >> (i * 8));
+	}
+}
+
+/* BC7 ====================================================================== */
+
+/**
+ * Interpolation weights (/64) of the 4 bits indices.
+*/
+static constexpr int	bc7_weights[16] = {
+	0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+/**
+ * Endpoints (7 bits RGBA and a shared low bit each) and indices
+ * of a BC7 mode 6 block, with their squared error.
+*/
+struct Bc7Fit {
+	uint8_t		endpoints[2][4];
+	uint8_t		p_bits[2];
+	uint8_t		indices[16];
+	float		error;
+};
+
+/**
+ * @brief 7 bits channels and low bit closest to the color.
+*/
+static void	quantizeBc7Endpoint(
+	const float color[4],
+	uint8_t endpoint[4],
+	uint8_t& p_bit
+) noexcept {
+	float	best_error = 0.0f;
+
+	for (uint8_t p = 0; p < 2; ++p) {
+		uint8_t	candidate[4];
+		float	error = 0.0f;
+
+		for (std::size_t c = 0; c < 4; ++c) {
+			const long	value = std::lround((color[c] - p) / 2.0f);
+			candidate[c] = static_cast<uint8_t>(std::min(127L, std::max(0L, value)));
+
+			const float	delta = color[c] - (candidate[c] << 1 | p);
+			error += delta * delta;
+		}
+		if (p == 0 || error < best_error) {
+			best_error = error;
+			p_bit = p;
+			std::memcpy(endpoint, candidate, sizeof(candidate));
+		}
+	}
+}
+
+static Bc7Fit	fitBc7(const Block& block, const float first[4], const float second[4]) noexcept {
+	Bc7Fit	fit{};
+	int		ends[2][4];
+	int		palette[16][4];
+
+	quantizeBc7Endpoint(first, fit.endpoints[0], fit.p_bits[0]);
+	quantizeBc7Endpoint(second, fit.endpoints[1], fit.p_bits[1]);
+	for (std::size_t e = 0; e < 2; ++e) {
+		for (std::size_t c = 0; c < 4; ++c) {
+			ends[e][c] = fit.endpoints[e][c] << 1 | fit.p_bits[e];
+		}
+	}
+	for (std::size_t index = 0; index < 16; ++index) {
+		for (std::size_t c = 0; c < 4; ++c) {
+			palette[index][c] = (
+				(64 - bc7_weights[index]) * ends[0][c] +
+				bc7_weights[index] * ends[1][c] + 32
+			) >> 6;
+		}
+	}
+
+	// Projection on the endpoints line, then its neighbour indices
+	int	direction[4];
+	int	length = 0;
+	for (std::size_t c = 0; c < 4; ++c) {
+		direction[c] = ends[1][c] - ends[0][c];
+		length += direction[c] * direction[c];
+	}
+
+	for (std::size_t i = 0; i < 16; ++i) {
+		float	projection = 0.0f;
+		for (std::size_t c = 0; c < 4; ++c) {
+			projection += (block.pixels[i][c] - ends[0][c]) * direction[c];
+		}
+
+		const long	guess = length > 0 ? std::lround(projection * 15.0f / length) : 0;
+		const int	first_index = static_cast<int>(std::min(14L, std::max(1L, guess))) - 1;
+		uint8_t		best = 0;
+		float		best_error = 0.0f;
+
+		for (int index = first_index; index < first_index + 3; ++index) {
+			float	error = 0.0f;
+			for (std::size_t c = 0; c < 4; ++c) {
+				const float	delta = block.pixels[i][c] - palette[index][c];
+				error += delta * delta;
+			}
+			if (index == first_index || error < best_error) {
+				best = static_cast<uint8_t>(index);
+				best_error = error;
+			}
+		}
+		fit.indices[i] = best;
+		fit.error += best_error;
+	}
+	return fit;
+}
+
+/**
+ * @brief Appends the count low bits of value, least significant first.
+*/
+static void	writeBits(
+	uint8_t* dst,
+	std::size_t& position,
+	uint32_t value,
+	std::size_t count
+) noexcept {
+	for (std::size_t bit = 0; bit < count; ++bit, ++position) {
+		if ((value >> bit) & 1) {
+			dst[position / 8] |= static_cast<uint8_t>(1 << (position % 8));
+		}
+	}
+}
+
+/**
+ * @brief Mode 6 block (one subset, RGBA endpoints, 4 bits indices),
+ * from the principal axis endpoints refined once by least squares.
+ *
+ * @note The first index must fit 3 bits: the endpoints are swapped,
+ * and the indices reversed, when it does not.
+*/
+static void	encodeBc7Block(const Block& block, uint8_t* dst) noexcept {
+	float	high[4];
+	float	low[4];
+
+	getEndpoints<4>(block, high, low);
+	Bc7Fit	fit = fitBc7(block, low, high);
+
+	float	weights[16];
+	for (std::size_t i = 0; i < 16; ++i) {
+		weights[i] = bc7_weights[fit.indices[i]] / 64.0f;
+	}
+	if (solveEndpoints<4>(block, weights, low, high)) {
+		const Bc7Fit	refined = fitBc7(block, low, high);
+		if (refined.error < fit.error) {
+			fit = refined;
+		}
+	}
+
+	if (fit.indices[0] >= 8) {
+		for (std::size_t c = 0; c < 4; ++c) {
+			std::swap(fit.endpoints[0][c], fit.endpoints[1][c]);
+		}
+		std::swap(fit.p_bits[0], fit.p_bits[1]);
+		for (std::size_t i = 0; i < 16; ++i) {
+			fit.indices[i] = static_cast<uint8_t>(15 - fit.indices[i]);
+		}
+	}
+
+	std::size_t	position = 0;
+	std::memset(dst, 0, 16);
+	writeBits(dst, position, 1 << 6, 7);
+	for (std::size_t c = 0; c < 4; ++c) {
+		writeBits(dst, position, fit.endpoints[0][c], 7);
+		writeBits(dst, position, fit.endpoints[1][c], 7);
+	}
+	writeBits(dst, position, fit.p_bits[0], 1);
+	writeBits(dst, position, fit.p_bits[1], 1);
+	writeBits(dst, position, fit.indices[0], 3);
+	for (std::size_t i = 1; i < 16; ++i) {
+		writeBits(dst, position, fit.indices[i], 4);
+	}
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Bytes per 4x4 block.
+*/
+std::size_t	getBlockSize(BlockFormat format) noexcept {
+	return format == BLOCK_FORMAT_BC1 ? 8 : 16;
+}
+
+/**
+ * @brief Bytes of a compressed width x height image, partial blocks
+ * included.
+*/
+std::size_t	getCompressedSize(
+	BlockFormat format,
+	std::size_t width,
+	std::size_t height
+) noexcept {
+	return ((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+/**
+ * @brief Whether every pixel has a full alpha.
+*/
+bool	isOpaque(const uint32_t* pixels, std::size_t count) noexcept {
+	uint32_t	alpha = 0xff000000;
+
+	for (std::size_t i = 0; i < count; ++i) {
+		alpha &= pixels[i];
+	}
+	return alpha == 0xff000000;
+}
+
+/**
+ * @brief Compresses the image into dst, getCompressedSize(format, width,
+ * height) bytes, blocks row by row.
+ *
+ * @param nb_threads 0 picks the number of hardware threads for large
+ * images, 1 compresses on the calling thread.
+ * @note The result does not depend on the number of threads.
+*/
+void	compressImage(
+	const uint32_t* pixels,
+	std::size_t width,
+	std::size_t height,
+	BlockFormat format,
+	uint8_t* dst,
+	std::size_t nb_threads
+) {
+	const std::size_t	blocks_x = (width + 3) / 4;
+	const std::size_t	blocks_y = (height + 3) / 4;
+	const std::size_t	block_size = getBlockSize(format);
+
+	scop::parallel::runRanges(
+		blocks_y,
+		scop::parallel::threadCount(
+			width * height,
+			SCOP_BC_PARALLEL_THRESHOLD,
+			nb_threads
+		),
+		[&](std::size_t begin, std::size_t end) {
+			Block	block;
+
+			for (std::size_t by = begin; by < end; ++by) {
+				for (std::size_t bx = 0; bx < blocks_x; ++bx) {
+					uint8_t*	out = dst + (by * blocks_x + bx) * block_size;
+
+					loadBlock(pixels, width, height, bx, by, block);
+					if (format == BLOCK_FORMAT_BC1) {
+						encodeBc1Block(block, out);
+					} else {
+						encodeBc7Block(block, out);
+					}
+				}
+			}
+		}
+	);
+}
+
+} // namespace scop
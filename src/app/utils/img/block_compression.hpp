@@ -0,0 +1,50 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   block_compression.hpp                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 16:04:12 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 16:04:12 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <cstdint> // uint8_t, uint32_t
+
+/**
+ * Images larger than this (pixels) get compressed on several threads.
+*/
+# define SCOP_BC_PARALLEL_THRESHOLD (1 << 16)
+
+namespace scop {
+
+/**
+ * Block compressed formats, 4x4 pixels per block.
+*/
+enum BlockFormat {
+	BLOCK_FORMAT_BC1,	// RGB 5:6:5 endpoints, 8 bytes per block
+	BLOCK_FORMAT_BC7	// RGBA, mode 6 only, 16 bytes per block
+};
+
+std::size_t	getBlockSize(BlockFormat format) noexcept;
+std::size_t	getCompressedSize(
+	BlockFormat format,
+	std::size_t width,
+	std::size_t height
+) noexcept;
+bool		isOpaque(const uint32_t* pixels, std::size_t count) noexcept;
+
+void		compressImage(
+	const uint32_t* pixels,
+	std::size_t width,
+	std::size_t height,
+	BlockFormat format,
+	uint8_t* dst,
+	std::size_t nb_threads = 0
+);
+
+} // namespace scop
@@ -0,0 +1,64 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   image_cache.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:09:44 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:09:44 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "image_cache.hpp"
+#include "ppm_loader.hpp"
+#include "file_cache.hpp"
+
+namespace scop {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Textures loaded so far, shared by all the materials using them.
+*/
+static utils::FileCache<Image>	shared_images;
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Image of the file, loaded once for the whole process: only its
+ * header is read here, the pixels are decoded when first written.
+ *
+ * @note Images keep their pixels once decoded while the cache holds them,
+ * so that a texture shared by many models is decoded once.
+*/
+std::shared_ptr<const Image>	getSharedImage(const std::string& path) {
+	return shared_images.get(
+		path,
+		[](const std::string& image_path) {
+			Image*	image = new Image(
+				std::unique_ptr<ImageLoader>(new PpmLoader(image_path))
+			);
+
+			image->retainPixels();
+			return image;
+		}
+	);
+}
+
+/**
+ * @brief Drops the cached images, still alive for their users, which
+ * then decode them straight to their destination.
+*/
+void	clearSharedImages() {
+	shared_images.forEach([](const Image& image) {
+		image.releasePixels();
+	});
+	shared_images.clear();
+}
+
+} // namespace scop
@@ -0,0 +1,26 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   image_cache.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:09:44 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:09:44 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <memory> // std::shared_ptr
+# include <string> // std::string
+
+# include "image_handler.hpp"
+
+namespace scop {
+
+std::shared_ptr<const Image>	getSharedImage(const std::string& path);
+void							clearSharedImages();
+
+} // namespace scop
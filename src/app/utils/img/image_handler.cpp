@@ -12,6 +12,8 @@
 
 #include "image_handler.hpp"
 
+#include <cstring>	// std::memcpy
+
 namespace scop {
 
 /* ========================================================================== */
@@ -31,14 +33,70 @@ pixels(std::move(pixels)),
 width(width),
 height(height) {}
 
+/**
+ * @brief Image decoded on demand by the loader, only its header read here.
+*/
+Image::Image(std::unique_ptr<ImageLoader>&& _loader):
+path(_loader->getPath()),
+loader(std::move(_loader)) {
+	loader->readHeader();
+	width = loader->getWidth();
+	height = loader->getHeight();
+}
+
 /* ========================================================================== */
 
-const std::string&	Image::getPath() const noexcept {
-	return path;
+/**
+ * @brief Writes the width * height pixels to dst, decoding them there
+ * if deferred, copying them otherwise.
+ *
+ * @note Decoding errors are thrown from here for deferred images.
+*/
+void	Image::writePixels(uint32_t* dst) const {
+	if (loader != nullptr) {
+		std::lock_guard<std::mutex>	lock(decode_mutex);
+
+		if (!retain_pixels) {
+			loader->decodeInto(dst);
+			return;
+		} else if (pixels.size() != width * height) {
+			std::vector<uint32_t>	decoded(width * height);
+			loader->decodeInto(decoded.data());
+			pixels.swap(decoded);
+		}
+	}
+
+	if (width * height > 0) {
+		std::memcpy(dst, pixels.data(), width * height * sizeof(uint32_t));
+	}
+}
+
+/**
+ * @brief Deferred images keep their pixels once decoded from then on,
+ * for the ones written more than once (e.g. shared by several models).
+*/
+void	Image::retainPixels() const {
+	std::lock_guard<std::mutex>	lock(decode_mutex);
+	retain_pixels = true;
 }
 
-const uint32_t*		Image::getPixels() const noexcept {
-	return pixels.data();
+/**
+ * @brief Deferred images no longer keep their pixels, and drop the ones
+ * kept so far: the next writes decode them again.
+*/
+void	Image::releasePixels() const {
+	std::lock_guard<std::mutex>	lock(decode_mutex);
+
+	if (loader != nullptr) {
+		retain_pixels = false;
+		std::vector<uint32_t>().swap(pixels);
+	}
+}
+
+/* ========================================================================== */
+
+const std::string&	Image::getPath() const noexcept {
+	return path;
 }
 
 std::size_t	Image::getWidth() const noexcept {
@@ -49,4 +107,17 @@ std::size_t	Image::getHeight() const noexcept {
 	return height;
 }
 
+/**
+ * @brief Key of the file the pixels are decoded from, as it was when opened.
+ *
+ * @return false if the pixels were not read from a file.
+*/
+bool	Image::getSourceKey(utils::FileKey& key) const noexcept {
+	if (loader == nullptr) {
+		return false;
+	}
+	key = loader->getSourceKey();
+	return true;
+}
+
 } // namespace scop
\ No newline at end of file
@@ -15,6 +15,8 @@
 // Std
 # include <string>
 # include <vector>
+# include <memory>		// std::unique_ptr
+# include <mutex>		// std::mutex
 
 # include "image_loader.hpp"
 
@@ -24,6 +26,9 @@ namespace scop {
  * Image handler.
  * 
  * Only handles 32-bit images.
+ * The pixels are either held, or decoded by a loader, in which case they
+ * only exist once written somewhere.
+ * Immutable once built, to be shared between threads.
 */
 class Image {
 public:
@@ -38,20 +43,25 @@ public:
 		std::size_t width,
 		std::size_t height
 	);
+	Image(std::unique_ptr<ImageLoader>&& loader);
 
-	Image(Image&& x) = default;
 	~Image() = default;
 
 	Image() = delete;
+	Image(Image&& x) = delete;
 	Image(const Image& x) = delete;
 	Image&	operator=(const Image& x) = delete;
 
 	/* ========================================================================= */
 
+	void						writePixels(uint32_t* dst) const;
+	void						retainPixels() const;
+	void						releasePixels() const;
+
 	const std::string&			getPath() const noexcept;
-	const uint32_t*				getPixels() const noexcept;
 	std::size_t					getWidth() const noexcept;
 	std::size_t					getHeight() const noexcept;
+	bool						getSourceKey(utils::FileKey& key) const noexcept;
 
 private:
 	/* ========================================================================= */
@@ -60,10 +70,15 @@ private:
 
 	const std::string			path;
 	// ImageType					type;
-	const std::vector<uint32_t>	pixels;
+	mutable std::vector<uint32_t>	pixels;
+	std::unique_ptr<ImageLoader>	loader;		// Decodes the pixels, if deferred
 	std::size_t					width;
 	std::size_t					height;
 
+	// Deferred images only
+	mutable std::mutex			decode_mutex;
+	mutable bool				retain_pixels = false;
+
 }; // class Image
 
 } // namespace scop
\ No newline at end of file
@@ -14,7 +14,9 @@
 
 // Std
 # include <string>
-# include <vector>
+# include <cstdint>
+
+# include "mapped_file.hpp"
 
 namespace scop {
 
@@ -34,8 +36,9 @@ enum ImageType {
 /**
  * Image loader interface.
  * 
- * The files are loaded into a vector of char, which is then parsed.
- * This format is necessary to be able to load binary files (images).
+ * The files are mapped in memory, then parsed in two steps: the header,
+ * giving the image size, then the pixels, decoded straight into
+ * a caller-provided destination (e.g. a mapped staging buffer).
 */
 class ImageLoader {
 public:
@@ -50,8 +53,15 @@ public:
 	/* ========================================================================= */
 
 	virtual ~ImageLoader() = default;
+	virtual void			readHeader() = 0;
+	virtual void			decodeInto(uint32_t* pixels) = 0;
 	virtual scop::Image		load() = 0;
 
+	const std::string&		getPath() const noexcept { return path; }
+	std::size_t				getWidth() const noexcept { return width; }
+	std::size_t				getHeight() const noexcept { return height; }
+	const utils::FileKey&	getSourceKey() const noexcept { return file.getKey(); }
+
 	/* ========================================================================= */
 	/*                                 EXCEPTIONS                                */
 	/* ========================================================================= */
@@ -76,9 +86,9 @@ protected:
 
 	const std::string	path;		// File path
 	ImageType			type;		// File extension
-	std::vector<char>	data;		// Contains file entire content
-	std::size_t			width;
-	std::size_t			height;
+	utils::MappedFile	file;		// File entire content, read only
+	std::size_t			width = 0;
+	std::size_t			height = 0;
 
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
@@ -0,0 +1,289 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   mipmap.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:31:06 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:31:06 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "mipmap.hpp"
+#include "simd.hpp"
+#include "parallel.hpp"
+
+#include <algorithm> // std::max
+#include <cmath> // std::pow, std::lround
+
+namespace scop {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Linear values are 15 bits, for sums of 4 to fit 16 bits signed lanes
+ * once halved.
+*/
+static constexpr uint32_t	linear_max = (1 << 15) - 1;
+
+/**
+ * sRGB to linear (15 bits) of each byte, and back.
+*/
+struct SrgbTables {
+	uint16_t	to_linear[256];
+	uint8_t		to_srgb[linear_max + 1];
+
+	SrgbTables() {
+		for (uint32_t i = 0; i < 256; ++i) {
+			const double	s = i / 255.0;
+			const double	l = s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+			to_linear[i] = static_cast<uint16_t>(std::lround(l * linear_max));
+		}
+		for (uint32_t i = 0; i <= linear_max; ++i) {
+			const double	l = static_cast<double>(i) / linear_max;
+			const double	s = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+			to_srgb[i] = static_cast<uint8_t>(std::lround(s * 255.0));
+		}
+	}
+};
+
+static const SrgbTables&	getSrgbTables() {
+	static const SrgbTables	tables;
+	return tables;
+}
+
+/**
+ * @brief Linear channels of a row of pixels, alpha left as is.
+*/
+static void	decodeRow(
+	const SrgbTables& tables,
+	const uint32_t* src,
+	std::size_t width,
+	uint16_t* dst
+) noexcept {
+	for (std::size_t x = 0; x < width; ++x) {
+		const uint32_t	pixel = src[x];
+		dst[x * 4 + 0] = tables.to_linear[pixel & 0xff];
+		dst[x * 4 + 1] = tables.to_linear[(pixel >> 8) & 0xff];
+		dst[x * 4 + 2] = tables.to_linear[(pixel >> 16) & 0xff];
+		dst[x * 4 + 3] = static_cast<uint16_t>(pixel >> 24);
+	}
+}
+
+/**
+ * @brief Averages the blocks of nb_rows linear rows (2, or 1 to 3 on the
+ * last row of the level), 2 pixels wide, into dst_width pixels re-encoded
+ * to sRGB.
+ *
+ * @note With SSE2, the sums of 2x2 blocks are done for two pixels at a time,
+ * only the table lookups being left scalar.
+ * @note The last column of odd widths is folded into the last pixel,
+ * averaged over 3 columns.
+*/
+static void	averageRows(
+	const SrgbTables& tables,
+	const uint16_t* const* rows,
+	std::size_t nb_rows,
+	std::size_t width,
+	uint16_t* sums,
+	uint32_t* dst,
+	std::size_t dst_width
+) noexcept {
+	const std::size_t	paired_width = width % 2 == 0 ? dst_width : dst_width - 1;
+	std::size_t			x = 0;
+
+# if SCOP_SIMD_SSE2
+	const __m128i	zero = _mm_setzero_si128();
+	const __m128i	round = _mm_set1_epi32(2);
+	auto			average = [&](std::size_t dst_x) -> __m128i {
+		const __m128i	top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[0] + dst_x * 8));
+		const __m128i	bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[1] + dst_x * 8));
+		const __m128i	column = _mm_add_epi16(top, bottom);
+		const __m128i	total = _mm_add_epi32(
+			_mm_unpacklo_epi16(column, zero),
+			_mm_unpackhi_epi16(column, zero)
+		);
+		return _mm_srli_epi32(_mm_add_epi32(total, round), 2);
+	};
+
+	// 2x2 blocks, short of the folded last column
+	for (; nb_rows == 2 && x + 2 <= paired_width; x += 2) {
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(sums + x * 4),
+			_mm_packs_epi32(average(x), average(x + 1))
+		);
+	}
+# endif
+
+	for (; x < dst_width; ++x) {
+		const std::size_t	x0 = x * 2;
+		const std::size_t	nb_columns = x < paired_width ? 2 : width - x0;
+		const uint32_t		nb_taps = static_cast<uint32_t>(nb_columns * nb_rows);
+
+		for (std::size_t c = 0; c < 4; ++c) {
+			uint32_t	total = 0;
+
+			for (std::size_t row = 0; row < nb_rows; ++row) {
+				for (std::size_t column = x0; column < x0 + nb_columns; ++column) {
+					total += rows[row][column * 4 + c];
+				}
+			}
+			sums[x * 4 + c] = static_cast<uint16_t>((total + nb_taps / 2) / nb_taps);
+		}
+	}
+
+	for (x = 0; x < dst_width; ++x) {
+		const uint16_t*	sum = sums + x * 4;
+		dst[x] =
+			static_cast<uint32_t>(tables.to_srgb[sum[0]]) |
+			static_cast<uint32_t>(tables.to_srgb[sum[1]]) << 8 |
+			static_cast<uint32_t>(tables.to_srgb[sum[2]]) << 16 |
+			static_cast<uint32_t>(sum[3]) << 24;
+	}
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Levels from width x height down to 1x1, each half the previous
+ * one (rounded down), packed one after the other.
+*/
+std::vector<MipLevel>	getMipChain(std::size_t width, std::size_t height) {
+	std::vector<MipLevel>	levels;
+	std::size_t				offset = 0;
+
+	if (width == 0 || height == 0) {
+		return levels;
+	}
+	while (true) {
+		levels.push_back({ offset, width, height });
+		offset += width * height;
+		if (width == 1 && height == 1) {
+			break;
+		}
+		width = std::max<std::size_t>(1, width / 2);
+		height = std::max<std::size_t>(1, height / 2);
+	}
+	return levels;
+}
+
+/**
+ * @brief Pixels of the whole chain.
+*/
+std::size_t	getMipChainSize(const std::vector<MipLevel>& levels) noexcept {
+	if (levels.empty()) {
+		return 0;
+	}
+	return levels.back().offset + levels.back().width * levels.back().height;
+}
+
+/**
+ * @brief First level whose longest side fits max_size, or the last one.
+ *
+ * @param max_size 0 for no limit.
+*/
+std::size_t	selectBaseLevel(
+	const std::vector<MipLevel>& levels,
+	std::size_t max_size
+) noexcept {
+	std::size_t	base = 0;
+
+	while (
+		max_size > 0 &&
+		base + 1 < levels.size() &&
+		std::max(levels[base].width, levels[base].height) > max_size
+	) {
+		++base;
+	}
+	return base;
+}
+
+/**
+ * @brief Halves the image into dst, max(1, width / 2) x max(1, height / 2),
+ * averaging 2x2 blocks in linear space (alpha as is).
+ *
+ * @param nb_threads 0 picks the number of hardware threads for large
+ * images, 1 filters on the calling thread.
+ * @note The last row and column of odd sizes are folded into the last
+ * pixels, averaged over 3 rows or columns.
+ * @note The result does not depend on the number of threads.
+*/
+void	downsampleImage(
+	const uint32_t* src,
+	std::size_t width,
+	std::size_t height,
+	uint32_t* dst,
+	std::size_t nb_threads
+) {
+	const SrgbTables&	tables = getSrgbTables();
+	const std::size_t	dst_width = std::max<std::size_t>(1, width / 2);
+	const std::size_t	dst_height = std::max<std::size_t>(1, height / 2);
+
+	scop::parallel::runRanges(
+		dst_height,
+		scop::parallel::threadCount(
+			width * height,
+			SCOP_MIPMAP_PARALLEL_THRESHOLD,
+			nb_threads
+		),
+		[&](std::size_t begin, std::size_t end) {
+			std::vector<uint16_t>	linear(width * 12);
+			std::vector<uint16_t>	sums(dst_width * 4 + 8);
+			const uint16_t* const	rows[3] = {
+				linear.data(),
+				linear.data() + width * 4,
+				linear.data() + width * 8
+			};
+
+			for (std::size_t y = begin; y < end; ++y) {
+				const std::size_t	y0 = y * 2;
+				const std::size_t	nb_rows = y + 1 < dst_height ? 2 : height - y0;
+
+				for (std::size_t row = 0; row < nb_rows; ++row) {
+					decodeRow(
+						tables,
+						src + (y0 + row) * width,
+						width,
+						linear.data() + row * width * 4
+					);
+				}
+				averageRows(
+					tables,
+					rows,
+					nb_rows,
+					width,
+					sums.data(),
+					dst + y * dst_width,
+					dst_width
+				);
+			}
+		}
+	);
+}
+
+/**
+ * @brief Fills the levels of the chain from the first one, already there,
+ * each from the previous one.
+*/
+void	generateMipChain(
+	uint32_t* chain,
+	const std::vector<MipLevel>& levels,
+	std::size_t nb_threads
+) {
+	for (std::size_t i = 1; i < levels.size(); ++i) {
+		downsampleImage(
+			chain + levels[i - 1].offset,
+			levels[i - 1].width,
+			levels[i - 1].height,
+			chain + levels[i].offset,
+			nb_threads
+		);
+	}
+}
+
+} // namespace scop
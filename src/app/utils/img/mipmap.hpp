@@ -0,0 +1,63 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   mipmap.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:31:06 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:31:06 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <cstdint> // uint32_t
+# include <vector> // std::vector
+
+/**
+ * Largest texture size uploaded (pixels, on the longest side), the top
+ * levels of the mip chain being skipped above it. 0 for the device limit.
+*/
+# ifndef SCOP_TEXTURE_MAX_SIZE
+#  define SCOP_TEXTURE_MAX_SIZE 0
+# endif
+
+/**
+ * Levels larger than this (pixels) get filtered on several threads.
+*/
+# define SCOP_MIPMAP_PARALLEL_THRESHOLD (1 << 18)
+
+namespace scop {
+
+/**
+ * Level of a mip chain, packed one after the other in a single buffer.
+*/
+struct MipLevel {
+	std::size_t	offset;	// In pixels, from the start of the chain
+	std::size_t	width;
+	std::size_t	height;
+};
+
+std::vector<MipLevel>	getMipChain(std::size_t width, std::size_t height);
+std::size_t				getMipChainSize(const std::vector<MipLevel>& levels) noexcept;
+std::size_t				selectBaseLevel(
+	const std::vector<MipLevel>& levels,
+	std::size_t max_size
+) noexcept;
+
+void					downsampleImage(
+	const uint32_t* src,
+	std::size_t width,
+	std::size_t height,
+	uint32_t* dst,
+	std::size_t nb_threads = 0
+);
+void					generateMipChain(
+	uint32_t* chain,
+	const std::vector<MipLevel>& levels,
+	std::size_t nb_threads = 0
+);
+
+} // namespace scop
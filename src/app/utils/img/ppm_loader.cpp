@@ -11,33 +11,384 @@
 /* ************************************************************************** */
 
 #include "ppm_loader.hpp"
-#include "utils.hpp"
+#include "simd.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>	// std::min, std::max, std::count
+#include <cstring>		// std::memcpy
 
 namespace scop {
 
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Builds a pixel from RGB values.
+ *
+ * @note	- Alpha is set to 255.
+ * @note	- RGB values are reversed (ABGR).
+*/
+static inline uint32_t	packPixel(uint8_t r, uint8_t g, uint8_t b) noexcept {
+	return 0xff000000 | (b << 16) | (g << 8) | r;
+}
+
+/**
+ * @brief Channel value from [0, max_color] to [0, 255], scale being
+ * 255 / max_color.
+ *
+ * @note Same float operations as rescaleBytes, for the same results.
+*/
+static inline uint8_t	rescaleChannel(uint32_t value, float scale) noexcept {
+	const int	res = static_cast<int>(static_cast<float>(value) * scale + 0.5f);
+	return static_cast<uint8_t>(res < 255 ? res : 255);
+}
+
+# if SCOP_SIMD_SSE2
+
+/**
+ * @brief Spreads 4 RGB pixels (the first 12 bytes) to a 32 bits lane
+ * each, the alpha byte left null.
+*/
+static inline __m128i	spreadRgb(__m128i rgb) noexcept {
+#  if SCOP_SIMD_SSSE3
+	return _mm_shuffle_epi8(
+		rgb,
+		_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1)
+	);
+#  else
+	const __m128i	p01 = _mm_unpacklo_epi32(rgb, _mm_srli_si128(rgb, 3));
+	const __m128i	p23 = _mm_unpacklo_epi32(_mm_srli_si128(rgb, 6), _mm_srli_si128(rgb, 9));
+	return _mm_and_si128(_mm_unpacklo_epi64(p01, p23), _mm_set1_epi32(0x00ffffff));
+#  endif
+}
+
+/**
+ * @brief rescaleChannel on 16 bytes.
+*/
+static inline __m128i	rescaleBytes(__m128i bytes, __m128 scale) noexcept {
+	const __m128i	zero = _mm_setzero_si128();
+	const __m128	half = _mm_set1_ps(0.5f);
+	const __m128i	words[2] = {
+		_mm_unpacklo_epi8(bytes, zero),
+		_mm_unpackhi_epi8(bytes, zero)
+	};
+	__m128i			res[4];
+
+	for (int i = 0; i < 4; ++i) {
+		const __m128i	dwords = i % 2 ?
+			_mm_unpackhi_epi16(words[i / 2], zero) :
+			_mm_unpacklo_epi16(words[i / 2], zero);
+		res[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(dwords), scale), half));
+	}
+	// Saturated down to bytes, as rescaleChannel clamps
+	return _mm_packus_epi16(_mm_packs_epi32(res[0], res[1]), _mm_packs_epi32(res[2], res[3]));
+}
+
+# endif
+
+/**
+ * @brief Expands count RGB pixels to packed pixels, 4 at a time with SSE2
+ * (byte shuffles with SSSE3), rescaling the channels if asked.
+*/
+template<bool Rescale>
+static void	expandPixels(
+	const uint8_t* src,
+	uint32_t* dst,
+	std::size_t count,
+	float scale
+) noexcept {
+	std::size_t	i = 0;
+
+# if SCOP_SIMD_SSE2
+	const __m128i	alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+	const __m128	scales = _mm_set1_ps(scale);
+
+	// 16 bytes loads for 12 bytes used: stop before reading past the end
+	for (; i + 6 <= count; i += 4) {
+		__m128i	pixels = spreadRgb(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3))
+		);
+		if (Rescale) {
+			pixels = rescaleBytes(pixels, scales);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(pixels, alpha));
+	}
+# endif
+
+	for (; i < count; ++i) {
+		const uint8_t*	rgb = src + i * 3;
+		dst[i] = Rescale ?
+			packPixel(
+				rescaleChannel(rgb[0], scale),
+				rescaleChannel(rgb[1], scale),
+				rescaleChannel(rgb[2], scale)
+			) :
+			packPixel(rgb[0], rgb[1], rgb[2]);
+	}
+}
+
+/* ========================================================================== */
+
+/**
+ * Scan of a chunk of an ASCII body.
+*/
+struct AsciiChunk {
+	std::size_t	nb_values;	// Numbers starting in the chunk, up to invalid
+	std::size_t	invalid;	// First byte neither a digit nor a whitespace, or end
+};
+
+static inline bool	isDigit(uint8_t c) noexcept {
+	return static_cast<unsigned>(c - '0') < 10u;
+}
+
+static inline bool	isSpace(uint8_t c) noexcept {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief Counts the numbers starting in body[begin, end), and finds the first
+ * invalid byte, 16 bytes at a time with SSE2.
+*/
+static AsciiChunk	scanChunk(
+	const uint8_t* body,
+	std::size_t begin,
+	std::size_t end
+) noexcept {
+	AsciiChunk	chunk{ 0, end };
+	unsigned	prev_digit = begin > 0 && isDigit(body[begin - 1]);
+	std::size_t	i = begin;
+
+# if SCOP_SIMD_SSE2
+	const __m128i	zero_below = _mm_set1_epi8('0' - 1);
+	const __m128i	nine_above = _mm_set1_epi8('9' + 1);
+	const __m128i	space = _mm_set1_epi8(' ');
+	const __m128i	tab_below = _mm_set1_epi8('\t' - 1);
+	const __m128i	cr_above = _mm_set1_epi8('\r' + 1);
+
+	for (; i + 16 <= end; i += 16) {
+		const __m128i	bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(body + i));
+		const __m128i	digits = _mm_and_si128(
+			_mm_cmpgt_epi8(bytes, zero_below),
+			_mm_cmplt_epi8(bytes, nine_above)
+		);
+		const __m128i	spaces = _mm_or_si128(
+			_mm_cmpeq_epi8(bytes, space),
+			_mm_and_si128(_mm_cmpgt_epi8(bytes, tab_below), _mm_cmplt_epi8(bytes, cr_above))
+		);
+		const unsigned	digit_mask = _mm_movemask_epi8(digits);
+		const unsigned	valid_mask = _mm_movemask_epi8(_mm_or_si128(digits, spaces));
+
+		if (valid_mask != 0xffff) {
+			// Finish the block byte by byte, up to the invalid one
+			break;
+		}
+		// Numbers start on digits following a non digit
+		chunk.nb_values += __builtin_popcount(digit_mask & ~((digit_mask << 1) | prev_digit));
+		prev_digit = digit_mask >> 15;
+	}
+# endif
+
+	for (; i < end; ++i) {
+		const bool	digit = isDigit(body[i]);
+		if (!digit && !isSpace(body[i])) {
+			chunk.invalid = i;
+			break;
+		}
+		chunk.nb_values += digit && !prev_digit;
+		prev_digit = digit;
+	}
+	return chunk;
+}
+
+/**
+ * @brief Parses the number at ptr, moving past it.
+ *
+ * @note Values are clamped to 16 bits, as they would be when rescaled.
+*/
+static inline uint32_t	parseNumber(const uint8_t*& ptr, const uint8_t* end) noexcept {
+	uint32_t	nb = 0;
+	while (ptr < end && isDigit(*ptr)) {
+		nb = std::min<uint32_t>(nb * 10 + (*ptr++ - '0'), 0xffff);
+	}
+	return nb;
+}
+
+# if SCOP_SIMD_SSE2
+
+/**
+ * @brief Bit i set if ptr[i] is a digit, for 16 bytes.
+*/
+static inline uint32_t	digitMask(const uint8_t* ptr) noexcept {
+	const __m128i	bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+	return _mm_movemask_epi8(_mm_and_si128(
+		_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+		_mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1))
+	));
+}
+
+# endif
+
+/**
+ * @brief Parses the numbers starting in body[begin, end) as channels
+ * first_value on, the last one possibly ending past end.
+ *
+ * @note With SSE2, numbers are found from the digit masks of 16 bytes blocks,
+ * and the ones up to 3 digits long converted without branches.
+ * @note Values above 255 are clamped, as they would be when rescaled.
+*/
+static void	parseChunk(
+	const uint8_t* body,
+	std::size_t size,
+	std::size_t begin,
+	std::size_t end,
+	std::size_t first_value,
+	std::size_t nb_values,
+	uint8_t* channels
+) noexcept {
+	std::size_t	i = begin;
+	std::size_t	value = first_value;
+
+	// Number started in the previous chunk
+	if (begin > 0 && isDigit(body[begin - 1])) {
+		while (i < end && isDigit(body[i])) {
+			++i;
+		}
+	}
+
+# if SCOP_SIMD_SSE2
+	// Masks over the block and the next one, for the numbers crossing over
+	std::size_t	next = i;
+	uint32_t	prev_digit = 0;
+	for (; i + 16 <= end && i + 32 <= size && value < nb_values; i += 16) {
+		const uint32_t	mask = digitMask(body + i) | digitMask(body + i + 16) << 16;
+		uint32_t		starts = mask & ~((mask << 1) | prev_digit) & 0xffff;
+
+		prev_digit = (mask >> 15) & 1;
+		while (starts != 0 && value < nb_values) {
+			const unsigned	pos = __builtin_ctz(starts);
+			const unsigned	length = __builtin_ctzll(~(static_cast<uint64_t>(mask) >> pos));
+			const uint8_t*	digits = body + i + pos;
+			uint32_t		nb;
+
+			starts &= starts - 1;
+			if (length <= 3) {
+				// Digits right aligned in the low 3 bytes, the others shifted out
+				uint32_t	word;
+				std::memcpy(&word, digits, sizeof(word));
+				word = (word - 0x30303030u) << (8 * (3 - length));
+				nb = (word & 0xff) * 100 + (word >> 8 & 0xff) * 10 + (word >> 16 & 0xff);
+				next = i + pos + length;
+			} else {
+				nb = parseNumber(digits, body + size);
+				next = digits - body;
+			}
+			channels[value++] = static_cast<uint8_t>(std::min<uint32_t>(nb, 255));
+		}
+	}
+	// Past the last number parsed
+	i = std::max(i, next);
+# endif
+
+	while (value < nb_values) {
+		while (i < end && !isDigit(body[i])) {
+			++i;
+		}
+		if (i >= end) {
+			break;
+		}
+
+		const uint8_t*	digits = body + i;
+		const uint32_t	nb = parseNumber(digits, body + size);
+		channels[value++] = static_cast<uint8_t>(std::min<uint32_t>(nb, 255));
+		i = digits - body;
+	}
+}
+
 /* ========================================================================== */
 /*                                   PUBLIC                                   */
 /* ========================================================================== */
 
 PpmLoader::PpmLoader(const std::string& _path):
 	base(_path, ImageType::PPM) {
-		base::data = utils::readFile(_path);
+		if (!base::file.open(_path)) {
+			throw base::FailedToLoadImage(_path, "could not open file");
+		}
 }
 
 /* ========================================================================== */
 
-Image	PpmLoader::load() {
+/**
+ * Parses the header, for the image size. Done once, the following calls
+ * do nothing.
+ *
+ * @note P6 bodies are checked to be complete here already.
+*/
+void	PpmLoader::readHeader() {
+	if (header_read) {
+		return;
+	}
 	try {
 		parseHeader();
-		Pixels	pixels = parseBody();
+		if (
+			format == Format::P6 &&
+			base::file.size() - cursor < base::width * base::height * 3
+		) {
+			throw PpmParseError("unexpected end of file");
+		}
+	} catch (...) {
+		rethrowAtLine();
+	}
+	header_read = true;
+	body_cursor = cursor;
+	body_line = line;
+}
 
-		return Image(
-			base::path,
-			// base::type,
-			std::move(pixels),
-			width,
-			height
-		);
+/**
+ * Decodes the pixels into width * height packed pixels, from the mapped
+ * file, with no intermediate copy for P6 bodies.
+ *
+ * @note Can be called again, the body being parsed from its start each time.
+*/
+void	PpmLoader::decodeInto(uint32_t* pixels) {
+	readHeader();
+	cursor = body_cursor;
+	line = body_line;
+	try {
+		parseBody(pixels);
+	} catch (...) {
+		rethrowAtLine();
+	}
+}
+
+/**
+ * Decodes the whole image into its own pixels.
+*/
+Image	PpmLoader::load() {
+	readHeader();
+
+	Pixels	pixels(base::width * base::height);
+	decodeInto(pixels.data());
+	return Image(
+		base::path,
+		// base::type,
+		std::move(pixels),
+		width,
+		height
+	);
+}
+
+/* ========================================================================== */
+/*                                   PRIVATE                                  */
+/* ========================================================================== */
+
+/**
+ * Rethrows the exception being handled, parse errors with the line they
+ * happened at.
+*/
+void	PpmLoader::rethrowAtLine() const {
+	try {
+		throw;
 	} catch (const PpmParseError& e) {
 		throw base::FailedToLoadImage(
 			base::path,
@@ -50,10 +401,6 @@ Image	PpmLoader::load() {
 	}
 }
 
-/* ========================================================================== */
-/*                                   PRIVATE                                  */
-/* ========================================================================== */
-
 /**
  * Parses the body of a file.
  * 
@@ -78,63 +425,145 @@ void	PpmLoader::parseHeader() {
 	}
 	if (max_color > std::numeric_limits<uint8_t>::max()) {
 		throw PpmParseError("max color value is too high, expecting 8 bits (255)");
+	} else if (max_color == 0) {
+		throw PpmParseError("max color value must be positive");
 	}
 }
 
 /**
  * Parses the image body.
+ *
+ * @note Channels are rescaled to [0, 255] when max_color is lower.
 */
-PpmLoader::Pixels	PpmLoader::parseBody() {
-	// Reads a character.
-	ParseNumberFn	readExcept = [this]() -> uint8_t {
-		if (cursor >= base::data.size()) {
-			throw PpmParseError("unexpected end of file");
-		}
-		return static_cast<uint8_t>(base::data[cursor++]);
-	};
+void	PpmLoader::parseBody(uint32_t* pixels) {
+	if (format == Format::P6) {
+		parseBinaryBody(pixels);
+	} else {
+		parseAsciiBody(pixels);
+	}
+}
 
-	// Reads a number.
-	ParseNumberFn	readNb = [this]() -> uint32_t {
-		while (skipWhitespace()) {
-			;
-		}
-		uint32_t	nb = 0;
-		uint8_t		c;
-
-		while (cursor < base::data.size()) {
-			c = static_cast<uint8_t>(base::data[cursor++]);
-			if (c >= '0' && c <= '9') {
-				nb = nb * 10 + (c - '0');
-			} else if (std::isspace(c)) {
-				return nb;
-			} else {
-				throw PpmParseError("expecting number");
-			}
-		}
+/**
+ * Parses a binary (P6) body: one byte per channel, checked to be all there
+ * at once, then expanded to pixels in bulk.
+*/
+void	PpmLoader::parseBinaryBody(uint32_t* pixels) {
+	const std::size_t	nb_values = base::width * base::height * 3;
+	if (base::file.size() - cursor < nb_values) {
 		throw PpmParseError("unexpected end of file");
-	};
+	}
+
+	const uint8_t*	channels = reinterpret_cast<const uint8_t*>(base::file.data() + cursor);
+	cursor += nb_values;
+	expandBody(
+		channels,
+		pixels,
+		scop::parallel::threadCount(nb_values, SCOP_PPM_PARALLEL_THRESHOLD, 0)
+	);
+}
 
-	ParseNumberFn	parseChannelFn(format == Format::P6 ? readExcept : readNb);
-	PpmLoader::Pixels	pixels(base::width * base::height * sizeof(uint32_t));
-	std::size_t	row = 0;
+/**
+ * Parses an ASCII (P3) body: decimal channels separated by whitespace.
+ *
+ * The body is split in one chunk per thread. Each chunk is scanned for
+ * where its numbers start, giving the index of the first channel of each
+ * chunk, then all the chunks are parsed at once into the channels.
+ *
+ * @note Values past the last pixel are ignored, as what follows them.
+*/
+void	PpmLoader::parseAsciiBody(uint32_t* pixels) {
+	const uint8_t*		body = reinterpret_cast<const uint8_t*>(base::file.data() + cursor);
+	const std::size_t	size = base::file.size() - cursor;
+	const std::size_t	nb_values = base::width * base::height * 3;
+	const std::size_t	nb_threads = scop::parallel::threadCount(
+		size,
+		SCOP_PPM_PARALLEL_THRESHOLD,
+		0
+	);
+	const std::size_t	chunk_size = (size + nb_threads - 1) / nb_threads;
 
-	while (row < base::height) {
-		uint8_t	r, g, b;
+	// Reports the error at that point of the body
+	auto	fail = [&](std::size_t offset, const std::string& spec) {
+		line += std::count(body, body + offset, '\n');
+		cursor += offset;
+		throw PpmParseError(spec);
+	};
 
-		for (size_t i = 0; i < base::width; ++i) {
-			// Read 3 bytes (RGB)
-			r = parseChannelFn();
-			g = parseChannelFn();
-			b = parseChannelFn();
+	std::vector<AsciiChunk>	chunks(nb_threads);
+	scop::parallel::runRanges(
+		nb_threads,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			for (std::size_t c = begin; c < end; ++c) {
+				chunks[c] = scanChunk(
+					body,
+					std::min(size, c * chunk_size),
+					std::min(size, (c + 1) * chunk_size)
+				);
+			}
+		}
+	);
 
-			pixels[row * base::width + i] = createPixel(r, g, b);
+	// First channel of each chunk, up to the invalid byte if any
+	std::vector<std::size_t>	first_values(nb_threads + 1, 0);
+	for (std::size_t c = 0; c < nb_threads; ++c) {
+		first_values[c + 1] = first_values[c] + chunks[c].nb_values;
+		if (
+			first_values[c + 1] < nb_values &&
+			chunks[c].invalid < std::min(size, (c + 1) * chunk_size)
+		) {
+			fail(chunks[c].invalid, "expecting number");
 		}
-		++row;
 	}
-	if (row != base::height) {
-		throw PpmParseError("invalid number of rows");
+	if (first_values[nb_threads] < nb_values) {
+		fail(size, "unexpected end of file");
 	}
-	return pixels;
+
+	std::vector<uint8_t>	channels(nb_values);
+	scop::parallel::runRanges(
+		nb_threads,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			for (std::size_t c = begin; c < end; ++c) {
+				parseChunk(
+					body,
+					size,
+					std::min(size, c * chunk_size),
+					std::min(size, (c + 1) * chunk_size),
+					first_values[c],
+					nb_values,
+					channels.data()
+				);
+			}
+		}
+	);
+	cursor += size;
+	expandBody(channels.data(), pixels, nb_threads);
+}
+
+/**
+ * @brief Packs the RGB channels into the width * height pixels, rescaled
+ * to [0, 255] if max_color is lower, split in pixel ranges over nb_threads.
+*/
+void	PpmLoader::expandBody(
+	const uint8_t* channels,
+	uint32_t* pixels,
+	std::size_t nb_threads
+) const {
+	const bool			rescale = max_color < std::numeric_limits<uint8_t>::max();
+	const float			scale = 255.0f / max_color;
+
+	scop::parallel::runRanges(
+		base::width * base::height,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			if (rescale) {
+				expandPixels<true>(channels + begin * 3, pixels + begin, end - begin, scale);
+			} else {
+				expandPixels<false>(channels + begin * 3, pixels + begin, end - begin, scale);
+			}
+		}
+	);
 }
 
 /* ========================================================================== */
@@ -146,17 +575,18 @@ PpmLoader::Pixels	PpmLoader::parseBody() {
  * {"P3" | "P6"}
 */
 PpmLoader::Format	PpmLoader::expectFormat() {
+	const char*	data = base::file.data();
 	if (
-		cursor > base::data.size() ||
-		base::data[cursor] != 'P' || (
-			base::data[cursor + 1] != '3' &&
-			base::data[cursor + 1] != '6'
+		cursor + 2 > base::file.size() ||
+		data[cursor] != 'P' || (
+			data[cursor + 1] != '3' &&
+			data[cursor + 1] != '6'
 		)
 	) {
 		throw PpmParseError("Invalid PPM format");
 	}
 
-	Format	file_format = (base::data[cursor + 1] == '3') ? Format::P3 : Format::P6;
+	Format	file_format = (data[cursor + 1] == '3') ? Format::P3 : Format::P6;
 	cursor += 2;
 	return file_format;
 }
@@ -165,24 +595,24 @@ PpmLoader::Format	PpmLoader::expectFormat() {
  * Returns number.
 */
 uint32_t	PpmLoader::expectNumber() {
-	if (cursor >= base::data.size()) {
+	const char*	data = base::file.data();
+	if (cursor >= base::file.size()) {
 		throw PpmParseError("missing value");
 	}
 
+	// Bounded by the file size, the mapping not being null terminated
 	std::size_t	start = cursor;
 	while (
-		base::data[cursor] >= '0' &&
-		base::data[cursor] <= '9'
+		cursor < base::file.size() &&
+		data[cursor] >= '0' &&
+		data[cursor] <= '9'
 	) {
 		++cursor;
 	}
 	if (start == cursor) {
 		throw PpmParseError("expecting number");
 	}
-	std::string	str(
-		base::data.cbegin() + start,
-		base::data.cbegin() + cursor + 1
-	);
+	std::string	str(data + start, cursor - start);
 	return std::stoul(str);
 }
 
@@ -192,17 +622,17 @@ uint32_t	PpmLoader::expectNumber() {
  * Skips single whitespace.
 */
 bool	PpmLoader::skipWhitespace() noexcept {
-	if (cursor < base::data.size()) {
+	if (cursor < base::file.size()) {
 		if (
-			base::data[cursor] == '\n' ||
-			base::data[cursor] == '\r'
+			base::file.data()[cursor] == '\n' ||
+			base::file.data()[cursor] == '\r'
 		) {
 			++line;
 		} else if (
-			base::data[cursor] != ' ' &&
-			base::data[cursor] != '\t' &&
-			base::data[cursor] != '\v' &&
-			base::data[cursor] != '\f'
+			base::file.data()[cursor] != ' ' &&
+			base::file.data()[cursor] != '\t' &&
+			base::file.data()[cursor] != '\v' &&
+			base::file.data()[cursor] != '\f'
 		) {
 			return false;
 		}
@@ -217,13 +647,13 @@ bool	PpmLoader::skipWhitespace() noexcept {
 */
 bool	PpmLoader::skipComment() noexcept {
 	if (
-		cursor < base::data.size() &&
-		base::data[cursor] == '#'
+		cursor < base::file.size() &&
+		base::file.data()[cursor] == '#'
 	) {
-		while (cursor < base::data.size()) {
+		while (cursor < base::file.size()) {
 			if (
-				base::data[cursor] == '\n' ||
-				base::data[cursor] == '\r'
+				base::file.data()[cursor] == '\n' ||
+				base::file.data()[cursor] == '\r'
 			) {
 				++line;
 				++cursor;
@@ -242,14 +672,4 @@ void	PpmLoader::ignoreChunk() noexcept {
 	while (skipComment() || skipWhitespace()) { ; }
 }
 
-/**
- * Builds a pixel from RGB values.
- * 
- * @note	- Alpha is set to 255.
- * @note	- RGB values are reversed (ABGR).
-*/
-uint32_t	PpmLoader::createPixel(uint8_t r, uint8_t g, uint8_t b) const noexcept {
-	return 0xff000000 | (b << 16) | (g << 8) | r;
-}
-
 } // namespace scop
\ No newline at end of file
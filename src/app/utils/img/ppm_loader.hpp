@@ -15,11 +15,15 @@
 // Std
 # include <string>
 # include <fstream>
-# include <functional>
 
 # include "image_loader.hpp"
 # include "image_handler.hpp"
 
+/**
+ * Bodies larger than this (bytes) get decoded on several threads.
+*/
+# define SCOP_PPM_PARALLEL_THRESHOLD (1 << 20)
+
 namespace scop {
 
 enum FormatPPM {
@@ -47,6 +51,8 @@ public:
 
 	/* ========================================================================= */
 
+	void			readHeader() override;
+	void			decodeInto(uint32_t* pixels) override;
 	scop::Image		load() override;
 
 private:
@@ -57,21 +63,32 @@ private:
 	typedef		ImageLoader					base;
 	typedef		std::vector<uint32_t>		Pixels;
 	typedef		enum FormatPPM				Format;
-	typedef		std::function<uint8_t()>	ParseNumberFn;
 
 	/* ========================================================================= */
 	/*                               CLASS MEMBERS                               */
 	/* ========================================================================= */
 
 	Format		format;
-	uint8_t		max_color;
+	uint32_t	max_color;
 	std::size_t	cursor = 0;	// Used to parse the file
 	std::size_t	line = 1;
+	bool		header_read = false;
+	std::size_t	body_cursor = 0;	// Where the body starts, to decode it again
+	std::size_t	body_line = 1;
 
 	/* ========================================================================= */
 
 	void		parseHeader();
-	Pixels		parseBody();
+	void		parseBody(uint32_t* pixels);
+	void		parseBinaryBody(uint32_t* pixels);
+	void		parseAsciiBody(uint32_t* pixels);
+	void		expandBody(
+		const uint8_t* channels,
+		uint32_t* pixels,
+		std::size_t nb_threads
+	) const;
+	[[noreturn]]
+	void		rethrowAtLine() const;
 
 	Format		expectFormat();
 	uint32_t	expectNumber();
@@ -80,8 +97,6 @@ private:
 	bool		skipComment() noexcept;
 	void		ignoreChunk() noexcept;
 
-	uint32_t	createPixel(uint8_t r, uint8_t g, uint8_t b) const noexcept;
-
 	/* ========================================================================= */
 	/*                                 EXCEPTION                                 */
 	/* ========================================================================= */
@@ -0,0 +1,209 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   texture_cache.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 16:21:37 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 16:21:37 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "texture_cache.hpp"
+#include "mipmap.hpp"
+#include "utils.hpp"	// LOG
+#include "file_cache.hpp"
+
+#include <fstream>		// std::ofstream
+#include <cstdio>		// std::rename, std::remove
+#include <cstring>		// std::memcpy, std::memcmp
+
+namespace scop {
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Maps the cache of a texture, if it exists and still matches
+ * the source file.
+ *
+ * @return false if there is no valid cache.
+*/
+bool	TextureCache::load(const std::string& texture_path) {
+	levels.clear();
+	if (
+		!file.open(getCachePath(texture_path)) ||
+		file.size() < sizeof(Header)
+	) {
+		file.close();
+		return false;
+	}
+	std::memcpy(&header, file.data(), sizeof(Header));
+
+	// Check format, then the level table
+	bool	valid =
+		std::memcmp(header.magic, "SCOPTEX", sizeof(header.magic)) == 0 &&
+		header.version == SCOP_TEXTURE_CACHE_VERSION &&
+		(header.format == BLOCK_FORMAT_BC1 || header.format == BLOCK_FORMAT_BC7) &&
+		header.nb_levels <= 64 &&
+		header.data_offset % 16 == 0 &&
+		header.data_offset >= sizeof(Header) + header.nb_levels * sizeof(Level) &&
+		header.data_offset <= file.size();
+
+	if (valid) {
+		levels.resize(header.nb_levels);
+		std::memcpy(
+			levels.data(),
+			file.data() + sizeof(Header),
+			header.nb_levels * sizeof(Level)
+		);
+		valid = checkLevels();
+	}
+
+	// Check source: same size and mtime
+	utils::FileKey	source;
+	valid =
+		valid &&
+		utils::getFileKey(texture_path, source) &&
+		source.size == header.source_size &&
+		source.mtime == header.source_mtime;
+
+	if (!valid) {
+		levels.clear();
+		file.close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Writes the cache of a texture, once its chain is compressed.
+ *
+ * @param source Key of the file the compressed pixels were decoded from.
+ * @param levels The whole chain, offsets from the start of data.
+ * @note Failing to write the cache is not an error, the texture
+ * will just be compressed again next time.
+*/
+void	TextureCache::save(
+	const std::string& texture_path,
+	const utils::FileKey& source,
+	BlockFormat format,
+	const std::vector<uint8_t>& data,
+	const std::vector<Level>& levels
+) noexcept {
+	const std::string	cache_path = getCachePath(texture_path);
+	const std::string	tmp_path = cache_path + ".tmp";
+
+	if (levels.empty()) {
+		return;
+	}
+	try {
+		Header	header{};
+
+		std::memcpy(header.magic, "SCOPTEX", sizeof(header.magic));
+		header.version = SCOP_TEXTURE_CACHE_VERSION;
+		header.format = format;
+		header.width = levels.front().width;
+		header.height = levels.front().height;
+		header.nb_levels = static_cast<uint32_t>(levels.size());
+		header.data_offset = static_cast<uint32_t>(
+			(sizeof(Header) + levels.size() * sizeof(Level) + 15) & ~std::size_t(15)
+		);
+		header.source_size = source.size;
+		header.source_mtime = source.mtime;
+
+		// Written aside then renamed, so a partial cache is never loaded
+		static const char	padding[16] = {};
+		std::ofstream		out(tmp_path, std::ios::binary | std::ios::trunc);
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		out.write(
+			reinterpret_cast<const char*>(levels.data()),
+			levels.size() * sizeof(Level)
+		);
+		out.write(
+			padding,
+			header.data_offset - sizeof(Header) - levels.size() * sizeof(Level)
+		);
+		out.write(reinterpret_cast<const char*>(data.data()), data.size());
+		out.close();
+
+		if (!out || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+			std::remove(tmp_path.c_str());
+			LOG("Could not write texture cache " << cache_path);
+		}
+	} catch (const std::exception& e) {
+		std::remove(tmp_path.c_str());
+		LOG("Could not write texture cache " << cache_path << ": " << e.what());
+	}
+}
+
+/* ========================================================================== */
+
+BlockFormat	TextureCache::getFormat() const noexcept {
+	return static_cast<BlockFormat>(header.format);
+}
+
+std::size_t	TextureCache::getWidth() const noexcept {
+	return header.width;
+}
+
+std::size_t	TextureCache::getHeight() const noexcept {
+	return header.height;
+}
+
+const std::vector<TextureCache::Level>&	TextureCache::getLevels() const noexcept {
+	return levels;
+}
+
+/**
+ * @brief Start of the level data, 16 bytes aligned in the mapping.
+*/
+const uint8_t*	TextureCache::getData() const noexcept {
+	return reinterpret_cast<const uint8_t*>(file.data() + header.data_offset);
+}
+
+/* ========================================================================== */
+/*                                   PRIVATE                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Cache file path: the texture path, with the cache extension
+ * appended, so that images differing by their extension only do not
+ * share a cache.
+*/
+std::string	TextureCache::getCachePath(const std::string& texture_path) {
+	return texture_path + SCOP_TEXTURE_CACHE_EXTENSION;
+}
+
+/**
+ * @brief Whether the levels are the whole chain of the texture,
+ * each of the right size, 16 bytes aligned, within the file.
+*/
+bool	TextureCache::checkLevels() const {
+	const std::vector<MipLevel>	chain = getMipChain(header.width, header.height);
+	const std::size_t			data_size = file.size() - header.data_offset;
+
+	if (chain.empty() || chain.size() != levels.size()) {
+		return false;
+	}
+	for (std::size_t i = 0; i < levels.size(); ++i) {
+		const Level&	level = levels[i];
+
+		if (
+			level.width != chain[i].width ||
+			level.height != chain[i].height ||
+			level.size != getCompressedSize(getFormat(), level.width, level.height) ||
+			level.offset % 16 != 0 ||
+			level.offset > data_size ||
+			level.size > data_size - level.offset
+		) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace scop
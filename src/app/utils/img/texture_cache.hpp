@@ -0,0 +1,126 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   texture_cache.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 16:21:37 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 16:21:37 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <string> // std::string
+# include <vector> // std::vector
+# include <cstdint> // uint32_t, uint64_t
+
+# include "block_compression.hpp"
+# include "mapped_file.hpp"
+
+/**
+ * 1 to upload the textures block compressed when the device supports it,
+ * compressed on first load then cached, 0 for RGBA8 only.
+*/
+# ifndef SCOP_TEXTURE_COMPRESSION
+#  define SCOP_TEXTURE_COMPRESSION 1
+# endif
+
+# define SCOP_TEXTURE_CACHE_EXTENSION ".scoptex"
+# define SCOP_TEXTURE_CACHE_VERSION 1
+
+namespace scop {
+
+/**
+ * Binary cache of a compressed texture (.scoptex), written next to the
+ * image file, its name followed by the cache extension.
+ *
+ * Holds its whole mip chain, block compressed (see block_compression.hpp),
+ * each level 16 bytes aligned, to be copied as is from the mapping
+ * to the staging buffer.
+*/
+class TextureCache {
+public:
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	/**
+	 * Level of the chain, its offset from the start of the data.
+	*/
+	struct Level {
+		uint64_t				offset;
+		uint64_t				size;
+		uint32_t				width;
+		uint32_t				height;
+	};
+
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	TextureCache() = default;
+	TextureCache(TextureCache&& x) = default;
+	~TextureCache() = default;
+
+	TextureCache(const TextureCache& x) = delete;
+	TextureCache&	operator=(const TextureCache& x) = delete;
+
+	/* ========================================================================= */
+
+	bool					load(const std::string& texture_path);
+	static void				save(
+		const std::string& texture_path,
+		const utils::FileKey& source,
+		BlockFormat format,
+		const std::vector<uint8_t>& data,
+		const std::vector<Level>& levels
+	) noexcept;
+
+	BlockFormat				getFormat() const noexcept;
+	std::size_t				getWidth() const noexcept;
+	std::size_t				getHeight() const noexcept;
+	const std::vector<Level>&	getLevels() const noexcept;
+	const uint8_t*			getData() const noexcept;
+
+private:
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	/**
+	 * Cache file header, followed by the levels, then their data.
+	*/
+	struct Header {
+		char					magic[8];
+		uint32_t				version;
+		uint32_t				format;
+		uint32_t				width;
+		uint32_t				height;
+		uint32_t				nb_levels;
+		uint32_t				data_offset;
+
+		// Source file key
+		uint64_t				source_size;
+		int64_t					source_mtime;
+	};
+
+	/* ========================================================================= */
+	/*                               CLASS MEMBERS                               */
+	/* ========================================================================= */
+
+	utils::MappedFile		file;
+	Header					header{};
+	std::vector<Level>		levels;
+
+	/* ========================================================================= */
+
+	static std::string		getCachePath(const std::string& texture_path);
+
+	bool					checkLevels() const;
+
+}; // class TextureCache
+
+} // namespace scop
@@ -0,0 +1,193 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bounds.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:04:38 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:04:38 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "bounds.hpp"
+#include "simd.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>	// std::min, std::max
+#include <cmath>		// std::abs
+#include <limits>		// std::numeric_limits
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Vertices reduced together in single precision, before their sum is
+ * added in double precision. Fixed so that the result does not depend
+ * on the number of threads.
+*/
+static constexpr std::size_t	block_size = 1024;
+
+/**
+ * Box and position sum of a block of vertices.
+*/
+struct BlockBounds {
+	float	min[3];
+	float	max[3];
+	double	sum[3];
+};
+
+/**
+ * @brief Reduces the positions of vertices [begin, end), four at a time.
+*/
+static BlockBounds	reduceBlock(
+	const std::vector<Vertex>& vertices,
+	std::size_t begin,
+	std::size_t end
+) noexcept {
+	using namespace scop::simd;
+
+	const float	inf = std::numeric_limits<float>::infinity();
+	Float4		lanes_min[3] = { splat(inf), splat(inf), splat(inf) };
+	Float4		lanes_max[3] = { splat(-inf), splat(-inf), splat(-inf) };
+	Float4		lanes_sum[3] = { splat(0.0f), splat(0.0f), splat(0.0f) };
+
+	std::size_t	i = begin;
+	for (; i + 4 <= end; i += 4) {
+		float	coords[3][4];
+		for (std::size_t lane = 0; lane < 4; ++lane) {
+			const scop::Vect3&	pos = vertices[i + lane].pos;
+			coords[0][lane] = pos.x;
+			coords[1][lane] = pos.y;
+			coords[2][lane] = pos.z;
+		}
+		for (std::size_t axis = 0; axis < 3; ++axis) {
+			const Float4	value = load(coords[axis]);
+			lanes_min[axis] = min(lanes_min[axis], value);
+			lanes_max[axis] = max(lanes_max[axis], value);
+			lanes_sum[axis] = lanes_sum[axis] + value;
+		}
+	}
+
+	// Fold the lanes, then the remaining vertices
+	BlockBounds	block;
+	for (std::size_t axis = 0; axis < 3; ++axis) {
+		float	out_min[4];
+		float	out_max[4];
+		float	out_sum[4];
+		store(out_min, lanes_min[axis]);
+		store(out_max, lanes_max[axis]);
+		store(out_sum, lanes_sum[axis]);
+
+		block.min[axis] = std::min(std::min(out_min[0], out_min[1]), std::min(out_min[2], out_min[3]));
+		block.max[axis] = std::max(std::max(out_max[0], out_max[1]), std::max(out_max[2], out_max[3]));
+		block.sum[axis] =
+			static_cast<double>(out_sum[0]) + out_sum[1] + out_sum[2] + out_sum[3];
+	}
+	for (; i < end; ++i) {
+		const float	coords[3] = { vertices[i].pos.x, vertices[i].pos.y, vertices[i].pos.z };
+		for (std::size_t axis = 0; axis < 3; ++axis) {
+			block.min[axis] = std::min(block.min[axis], coords[axis]);
+			block.max[axis] = std::max(block.max[axis], coords[axis]);
+			block.sum[axis] += coords[axis];
+		}
+	}
+	return block;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Computes the barycenter, the box and the bounding sphere of the
+ * vertex positions, in a single pass.
+ *
+ * @param nb_threads 0 picks the number of hardware threads for large
+ * meshes, 1 computes on the calling thread.
+ *
+ * @note The result does not depend on the number of threads.
+*/
+Bounds	computeBounds(
+	const std::vector<Vertex>& vertices,
+	std::size_t nb_threads
+) {
+	Bounds				bounds{};
+	const std::size_t	nb_vertices = vertices.size();
+	const std::size_t	nb_blocks = (nb_vertices + block_size - 1) / block_size;
+
+	if (nb_vertices == 0) {
+		bounds.radius = 0.0f;
+		return bounds;
+	}
+
+	// One partial result per block, folded in order
+	std::vector<BlockBounds>	blocks(nb_blocks);
+	scop::parallel::runRanges(
+		nb_blocks,
+		scop::parallel::threadCount(
+			nb_vertices,
+			SCOP_BOUNDS_PARALLEL_THRESHOLD,
+			nb_threads
+		),
+		[&](std::size_t begin, std::size_t end) {
+			for (std::size_t block = begin; block < end; ++block) {
+				blocks[block] = reduceBlock(
+					vertices,
+					block * block_size,
+					std::min(nb_vertices, (block + 1) * block_size)
+				);
+			}
+		}
+	);
+
+	BlockBounds	total = blocks[0];
+	for (std::size_t block = 1; block < nb_blocks; ++block) {
+		for (std::size_t axis = 0; axis < 3; ++axis) {
+			total.min[axis] = std::min(total.min[axis], blocks[block].min[axis]);
+			total.max[axis] = std::max(total.max[axis], blocks[block].max[axis]);
+			total.sum[axis] += blocks[block].sum[axis];
+		}
+	}
+
+	bounds.barycenter = scop::Vect3(
+		static_cast<float>(total.sum[0] / nb_vertices),
+		static_cast<float>(total.sum[1] / nb_vertices),
+		static_cast<float>(total.sum[2] / nb_vertices)
+	);
+	bounds.min = scop::Vect3(total.min[0], total.min[1], total.min[2]);
+	bounds.max = scop::Vect3(total.max[0], total.max[1], total.max[2]);
+	bounds.center = (bounds.min + bounds.max) * 0.5f;
+	bounds.radius = scop::norm(bounds.max - bounds.min) * 0.5f;
+	return bounds;
+}
+
+/**
+ * @brief Moves the bounds along with the vertices.
+*/
+void	translateBounds(Bounds& bounds, const scop::Vect3& offset) noexcept {
+	bounds.barycenter += offset;
+	bounds.min += offset;
+	bounds.max += offset;
+	bounds.center += offset;
+}
+
+/**
+ * @brief Radius of the sphere centered on the model origin that holds
+ * the box, i.e. the distance to its farthest corner.
+*/
+float	computeOriginRadius(const Bounds& bounds) noexcept {
+	const scop::Vect3	farthest(
+		std::max(std::abs(bounds.min.x), std::abs(bounds.max.x)),
+		std::max(std::abs(bounds.min.y), std::abs(bounds.max.y)),
+		std::max(std::abs(bounds.min.z), std::abs(bounds.max.z))
+	);
+	return scop::norm(farthest);
+}
+
+} // namespace mesh
+} // namespace scop
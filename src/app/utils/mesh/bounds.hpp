@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bounds.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:04:38 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:04:38 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+
+# include "vertex.hpp"
+
+/**
+ * Meshes with more vertices than this get their bounds computed
+ * on several threads, unless a thread count is given.
+*/
+# define SCOP_BOUNDS_PARALLEL_THRESHOLD	(1 << 18)
+
+namespace scop {
+namespace mesh {
+
+/**
+ * Bounds of the vertex positions, in model space.
+ *
+ * @note The sphere is the one around the box: its radius is at most
+ * sqrt(3) times the tightest one, but it comes from the same pass.
+*/
+struct Bounds {
+	scop::Vect3		barycenter;
+	scop::Vect3		min;
+	scop::Vect3		max;
+	scop::Vect3		center;
+	float			radius;
+};
+
+Bounds	computeBounds(
+	const std::vector<Vertex>& vertices,
+	std::size_t nb_threads = 0
+);
+void	translateBounds(Bounds& bounds, const scop::Vect3& offset) noexcept;
+float	computeOriginRadius(const Bounds& bounds) noexcept;
+
+} // namespace mesh
+} // namespace scop
@@ -0,0 +1,497 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   codec.cpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:41:20 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:41:20 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "codec.hpp"
+#include "simd.hpp"
+
+#include <algorithm> // std::min, std::max
+#include <cstring> // std::memcpy, std::memset
+#include <stdexcept> // std::invalid_argument
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Vertices coded together: differences go on from the previous block's
+ * last vertex, byte planes are sized for a block.
+*/
+static constexpr std::size_t	vertex_block_size = 256;
+
+/**
+ * Bytes of a plane coded with a single mode.
+*/
+static constexpr std::size_t	group_size = 16;
+
+/**
+ * Largest vertex handled, in bytes.
+*/
+static constexpr std::size_t	max_vertex_size = 256;
+
+/**
+ * Padding after the index stream, so that values are read 4 bytes at once.
+*/
+static constexpr std::size_t	index_padding = 3;
+
+/**
+ * For each control byte of the index stream: bytes taken by its 4 values,
+ * and the shuffle moving them into 4 words.
+*/
+static const struct ControlTable {
+	uint8_t		lengths[256];
+	uint8_t		shuffles[256][16];
+}	control_table = []() {
+	ControlTable	table{};
+
+	for (uint32_t control = 0; control < 256; ++control) {
+		uint8_t	offset = 0;
+		for (uint32_t lane = 0; lane < 4; ++lane) {
+			const uint8_t	length = ((control >> (lane * 2)) & 3) + 1;
+			for (uint8_t byte = 0; byte < 4; ++byte) {
+				table.shuffles[control][lane * 4 + byte] =
+					byte < length ? static_cast<uint8_t>(offset + byte) : 0x80;
+			}
+			offset += length;
+		}
+		table.lengths[control] = offset;
+	}
+	return table;
+}();
+
+/**
+ * How a group of 16 bytes of a plane is stored.
+*/
+enum GroupMode {
+	GROUP_MODE_ZERO = 0,	// all zero, nothing stored
+	GROUP_MODE_NIBBLE = 1,	// all under 16, two per byte
+	GROUP_MODE_RAW = 2		// as is
+};
+
+inline uint32_t	zigzag(uint32_t value) noexcept {
+	return (value << 1) ^ (0U - (value >> 31));
+}
+
+inline uint32_t	unzigzag(uint32_t value) noexcept {
+	return (value >> 1) ^ (0U - (value & 1));
+}
+
+/**
+ * @brief Rebuilds a group of 16 words from the zigzagged differences
+ * stored in their 4 byte planes, starting from previous.
+ *
+ * @return The last word, to start the next group from.
+*/
+inline uint32_t	decodeGroup(
+	const uint8_t* const planes[4],
+	uint32_t* words,
+	uint32_t previous
+) noexcept {
+# if SCOP_SIMD_SSE2
+	const __m128i	b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0]));
+	const __m128i	b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1]));
+	const __m128i	b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2]));
+	const __m128i	b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[3]));
+
+	// Byte planes back to words
+	const __m128i	b01_lo = _mm_unpacklo_epi8(b0, b1);
+	const __m128i	b01_hi = _mm_unpackhi_epi8(b0, b1);
+	const __m128i	b23_lo = _mm_unpacklo_epi8(b2, b3);
+	const __m128i	b23_hi = _mm_unpackhi_epi8(b2, b3);
+	__m128i			quads[4] = {
+		_mm_unpacklo_epi16(b01_lo, b23_lo),
+		_mm_unpackhi_epi16(b01_lo, b23_lo),
+		_mm_unpacklo_epi16(b01_hi, b23_hi),
+		_mm_unpackhi_epi16(b01_hi, b23_hi)
+	};
+
+	__m128i	carry = _mm_set1_epi32(static_cast<int>(previous));
+	for (__m128i& d: quads) {
+		// Unzigzag, then prefix sum over the 4 lanes
+		d = _mm_xor_si128(
+			_mm_srli_epi32(d, 1),
+			_mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(d, _mm_set1_epi32(1)))
+		);
+		d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+		d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+		d = _mm_add_epi32(d, carry);
+		carry = _mm_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	for (std::size_t i = 0; i < 4; ++i) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(words + i * 4), quads[i]);
+	}
+	return words[group_size - 1];
+# else
+	for (std::size_t i = 0; i < group_size; ++i) {
+		const uint32_t	delta =
+			static_cast<uint32_t>(planes[0][i]) |
+			static_cast<uint32_t>(planes[1][i]) << 8 |
+			static_cast<uint32_t>(planes[2][i]) << 16 |
+			static_cast<uint32_t>(planes[3][i]) << 24;
+		previous += unzigzag(delta);
+		words[i] = previous;
+	}
+	return previous;
+# endif
+}
+
+/**
+ * @brief Reads the groups of one byte plane of a block.
+ *
+ * @return The position after the plane, nullptr if past end.
+*/
+static const uint8_t*	readPlane(
+	const uint8_t* data,
+	const uint8_t* end,
+	uint8_t* deltas,
+	std::size_t nb_groups
+) noexcept {
+	const uint8_t*	modes = data;
+	data += (nb_groups + 3) / 4;
+	if (data > end) {
+		return nullptr;
+	}
+
+	for (std::size_t group = 0; group < nb_groups; ++group) {
+		const uint32_t	mode = (modes[group / 4] >> (group % 4 * 2)) & 3;
+		uint8_t*		out = deltas + group * group_size;
+
+		if (mode == GROUP_MODE_ZERO) {
+			std::memset(out, 0, group_size);
+		} else if (mode == GROUP_MODE_NIBBLE) {
+			if (end - data < static_cast<std::ptrdiff_t>(group_size / 2)) {
+				return nullptr;
+			}
+# if SCOP_SIMD_SSE2
+			const __m128i	packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+			const __m128i	mask = _mm_set1_epi8(0x0F);
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(out),
+				_mm_unpacklo_epi8(
+					_mm_and_si128(packed, mask),
+					_mm_and_si128(_mm_srli_epi16(packed, 4), mask)
+				)
+			);
+# else
+			for (std::size_t i = 0; i < group_size / 2; ++i) {
+				out[i * 2] = data[i] & 0x0F;
+				out[i * 2 + 1] = data[i] >> 4;
+			}
+# endif
+			data += group_size / 2;
+		} else if (mode == GROUP_MODE_RAW) {
+			if (end - data < static_cast<std::ptrdiff_t>(group_size)) {
+				return nullptr;
+			}
+			std::memcpy(out, data, group_size);
+			data += group_size;
+		} else {
+			return nullptr;
+		}
+	}
+	return data;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Encodes an index buffer: each index as the zigzagged difference
+ * with the previous one, stored on 1 to 4 bytes.
+ *
+ * Lengths are grouped in control bytes (2 bits per index) ahead of the
+ * values, so that decoding never branches on the data.
+ * With vertex fetch ordered meshes, most indices take a single byte.
+*/
+std::vector<uint8_t>	encodeIndices(const std::vector<uint32_t>& indices) {
+	const std::size_t		nb_controls = (indices.size() + 3) / 4;
+	std::vector<uint8_t>	encoded(nb_controls, 0);
+	uint32_t				previous = 0;
+
+	encoded.reserve(nb_controls + indices.size() * 2 + index_padding);
+	for (std::size_t i = 0; i < indices.size(); ++i) {
+		const uint32_t	value = zigzag(indices[i] - previous);
+		const uint32_t	length =
+			value < (1U << 8) ? 1 :
+			value < (1U << 16) ? 2 :
+			value < (1U << 24) ? 3 :
+			4;
+
+		encoded[i / 4] |= static_cast<uint8_t>((length - 1) << (i % 4 * 2));
+		for (uint32_t byte = 0; byte < length; ++byte) {
+			encoded.push_back(static_cast<uint8_t>(value >> (byte * 8)));
+		}
+		previous = indices[i];
+	}
+	encoded.insert(encoded.end(), index_padding, 0);
+	return encoded;
+}
+
+/**
+ * @brief Decodes nb_indices indices written by encodeIndices.
+ *
+ * @return false if the data does not hold exactly nb_indices indices.
+*/
+bool	decodeIndices(
+	const uint8_t* data,
+	std::size_t size,
+	uint32_t* indices,
+	std::size_t nb_indices
+) noexcept {
+	static constexpr uint32_t	masks[4] = {
+		0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF
+	};
+	const std::size_t	nb_controls = (nb_indices + 3) / 4;
+
+	// Check the stream size from the lengths first
+	if (size < nb_controls + index_padding) {
+		return false;
+	}
+	std::size_t	data_size = 0;
+	for (std::size_t i = 0; i < nb_indices / 4; ++i) {
+		data_size += control_table.lengths[data[i]];
+	}
+	for (std::size_t i = nb_indices / 4 * 4; i < nb_indices; ++i) {
+		data_size += ((data[i / 4] >> (i % 4 * 2)) & 3) + 1;
+	}
+	if (nb_controls + data_size + index_padding != size) {
+		return false;
+	}
+
+	const uint8_t*	controls = data;
+	const uint8_t*	values = data + nb_controls;
+	uint32_t		previous = 0;
+	std::size_t		i = 0;
+
+# if SCOP_SIMD_SSSE3
+	// 4 indices at once, while 16 bytes can be read
+	const uint8_t*	end = data + size;
+	__m128i			carry = _mm_setzero_si128();
+	for (; i + 4 <= nb_indices && end - values >= 16; i += 4) {
+		const uint8_t	control = controls[i / 4];
+		__m128i			d = _mm_shuffle_epi8(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(control_table.shuffles[control]))
+		);
+
+		d = _mm_xor_si128(
+			_mm_srli_epi32(d, 1),
+			_mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(d, _mm_set1_epi32(1)))
+		);
+		d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+		d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+		d = _mm_add_epi32(d, carry);
+		carry = _mm_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), d);
+		values += control_table.lengths[control];
+	}
+	previous = static_cast<uint32_t>(_mm_cvtsi128_si32(carry));
+# endif
+
+	for (; i < nb_indices; ++i) {
+		const uint32_t	length_code = (controls[i / 4] >> (i % 4 * 2)) & 3;
+		const uint32_t	value =
+			static_cast<uint32_t>(values[0]) |
+			static_cast<uint32_t>(values[1]) << 8 |
+			static_cast<uint32_t>(values[2]) << 16 |
+			static_cast<uint32_t>(values[3]) << 24;
+
+		values += length_code + 1;
+		previous += unzigzag(value & masks[length_code]);
+		indices[i] = previous;
+	}
+	return true;
+}
+
+/**
+ * @brief Encodes vertices of vertex_size bytes (a multiple of 4),
+ * as any plain struct of 32 bits fields.
+ *
+ * By blocks of 256 vertices, each word of the vertex is replaced with its
+ * zigzagged difference from the previous vertex, then stored as 4 byte
+ * planes. Smooth attributes, floats included, give small differences:
+ * their high planes are stored as nibbles, or not at all when null.
+ *
+ * @note Lossless.
+*/
+std::vector<uint8_t>	encodeVertices(
+	const void* vertices,
+	std::size_t nb_vertices,
+	std::size_t vertex_size
+) {
+	const uint8_t*			src = static_cast<const uint8_t*>(vertices);
+	const std::size_t		nb_words = vertex_size / sizeof(uint32_t);
+	std::vector<uint8_t>	encoded;
+	std::vector<uint32_t>	previous(nb_words, 0);
+	uint8_t					plane[vertex_block_size];
+
+	if (vertex_size % sizeof(uint32_t) != 0 || vertex_size > max_vertex_size) {
+		throw std::invalid_argument("vertex size not supported by the codec");
+	}
+
+	for (std::size_t first = 0; first < nb_vertices; first += vertex_block_size) {
+		const std::size_t	count = std::min(vertex_block_size, nb_vertices - first);
+		const std::size_t	nb_groups = (count + group_size - 1) / group_size;
+
+		for (std::size_t w = 0; w < nb_words; ++w) {
+			// Differences along the block, zero past its end
+			uint32_t	deltas[vertex_block_size] = {};
+			for (std::size_t i = 0; i < count; ++i) {
+				uint32_t	word;
+				std::memcpy(&word, src + (first + i) * vertex_size + w * sizeof(uint32_t), sizeof(uint32_t));
+				deltas[i] = zigzag(word - previous[w]);
+				previous[w] = word;
+			}
+
+			for (std::size_t byte = 0; byte < sizeof(uint32_t); ++byte) {
+				for (std::size_t i = 0; i < vertex_block_size; ++i) {
+					plane[i] = static_cast<uint8_t>(deltas[i] >> (byte * 8));
+				}
+
+				// Mode of each group, then their content
+				const std::size_t	modes_offset = encoded.size();
+				encoded.insert(encoded.end(), (nb_groups + 3) / 4, 0);
+				for (std::size_t group = 0; group < nb_groups; ++group) {
+					const uint8_t*	in = plane + group * group_size;
+					const uint8_t	largest = *std::max_element(in, in + group_size);
+
+					GroupMode	mode;
+					if (largest == 0) {
+						mode = GROUP_MODE_ZERO;
+					} else if (largest < 16) {
+						mode = GROUP_MODE_NIBBLE;
+						for (std::size_t i = 0; i < group_size; i += 2) {
+							encoded.push_back(static_cast<uint8_t>(in[i] | (in[i + 1] << 4)));
+						}
+					} else {
+						mode = GROUP_MODE_RAW;
+						encoded.insert(encoded.end(), in, in + group_size);
+					}
+					encoded[modes_offset + group / 4] |=
+						static_cast<uint8_t>(mode << (group % 4 * 2));
+				}
+			}
+		}
+	}
+	return encoded;
+}
+
+/**
+ * @brief Checks that the data holds exactly nb_vertices vertices written
+ * by encodeVertices, from the group modes alone, so that decoding them
+ * later on (e.g. straight to the gpu) cannot fail.
+*/
+bool	checkVertices(
+	const uint8_t* data,
+	std::size_t size,
+	std::size_t nb_vertices,
+	std::size_t vertex_size
+) noexcept {
+	if (vertex_size % sizeof(uint32_t) != 0 || vertex_size > max_vertex_size) {
+		return false;
+	}
+
+	const std::size_t	nb_planes = vertex_size;
+	std::size_t			offset = 0;
+
+	for (std::size_t first = 0; first < nb_vertices; first += vertex_block_size) {
+		const std::size_t	count = std::min(vertex_block_size, nb_vertices - first);
+		const std::size_t	nb_groups = (count + group_size - 1) / group_size;
+
+		for (std::size_t plane = 0; plane < nb_planes; ++plane) {
+			const std::size_t	modes = offset;
+
+			offset += (nb_groups + 3) / 4;
+			if (offset > size) {
+				return false;
+			}
+			for (std::size_t group = 0; group < nb_groups; ++group) {
+				const uint32_t	mode = (data[modes + group / 4] >> (group % 4 * 2)) & 3;
+
+				if (mode == GROUP_MODE_NIBBLE) {
+					offset += group_size / 2;
+				} else if (mode == GROUP_MODE_RAW) {
+					offset += group_size;
+				} else if (mode != GROUP_MODE_ZERO) {
+					return false;
+				}
+			}
+			if (offset > size) {
+				return false;
+			}
+		}
+	}
+	return offset == size;
+}
+
+/**
+ * @brief Decodes nb_vertices vertices written by encodeVertices.
+ *
+ * @return false if the data does not hold exactly nb_vertices vertices.
+*/
+bool	decodeVertices(
+	const uint8_t* data,
+	std::size_t size,
+	void* vertices,
+	std::size_t nb_vertices,
+	std::size_t vertex_size
+) noexcept {
+	if (vertex_size % sizeof(uint32_t) != 0 || vertex_size > max_vertex_size) {
+		return false;
+	}
+
+	const std::size_t	nb_words = vertex_size / sizeof(uint32_t);
+	uint8_t*			dst = static_cast<uint8_t*>(vertices);
+	const uint8_t*		end = data + size;
+	uint32_t			previous[max_vertex_size / sizeof(uint32_t)] = {};
+	uint8_t				planes[sizeof(uint32_t)][vertex_block_size];
+	uint32_t			words[vertex_block_size];
+
+	for (std::size_t first = 0; first < nb_vertices; first += vertex_block_size) {
+		const std::size_t	count = std::min(vertex_block_size, nb_vertices - first);
+		const std::size_t	nb_groups = (count + group_size - 1) / group_size;
+
+		for (std::size_t w = 0; w < nb_words; ++w) {
+			for (std::size_t byte = 0; byte < sizeof(uint32_t); ++byte) {
+				data = readPlane(data, end, planes[byte], nb_groups);
+				if (data == nullptr) {
+					return false;
+				}
+			}
+
+			// Padding differences are zero: the last group ends on the last word
+			for (std::size_t group = 0; group < nb_groups; ++group) {
+				const uint8_t* const	group_planes[4] = {
+					planes[0] + group * group_size,
+					planes[1] + group * group_size,
+					planes[2] + group * group_size,
+					planes[3] + group * group_size
+				};
+				previous[w] = decodeGroup(group_planes, words + group * group_size, previous[w]);
+			}
+
+			// Back in place in the vertices
+			uint8_t*	out = dst + first * vertex_size + w * sizeof(uint32_t);
+			for (std::size_t i = 0; i < count; ++i, out += vertex_size) {
+				std::memcpy(out, words + i, sizeof(uint32_t));
+			}
+		}
+	}
+	return data == end;
+}
+
+} // namespace mesh
+} // namespace scop
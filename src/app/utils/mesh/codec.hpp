@@ -0,0 +1,50 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   codec.hpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:41:20 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:41:20 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint8_t, uint32_t
+
+namespace scop {
+namespace mesh {
+
+std::vector<uint8_t>	encodeIndices(const std::vector<uint32_t>& indices);
+bool					decodeIndices(
+	const uint8_t* data,
+	std::size_t size,
+	uint32_t* indices,
+	std::size_t nb_indices
+) noexcept;
+
+std::vector<uint8_t>	encodeVertices(
+	const void* vertices,
+	std::size_t nb_vertices,
+	std::size_t vertex_size
+);
+bool					checkVertices(
+	const uint8_t* data,
+	std::size_t size,
+	std::size_t nb_vertices,
+	std::size_t vertex_size
+) noexcept;
+bool					decodeVertices(
+	const uint8_t* data,
+	std::size_t size,
+	void* vertices,
+	std::size_t nb_vertices,
+	std::size_t vertex_size
+) noexcept;
+
+} // namespace mesh
+} // namespace scop
@@ -0,0 +1,136 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lod.cpp                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 13:41:52 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 13:41:52 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "lod.hpp"
+#include "simplification.hpp"
+#include "vertex_cache.hpp"
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Triangle count of each level, relative to the full detail mesh.
+*/
+static constexpr float	lod_ratios[] = { 0.5f, 0.25f, 0.1f, 0.05f, 0.02f, 0.01f };
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Builds the levels of detail of the mesh, each one simplified
+ * from the previous one, and splits each of them into meshlets.
+ *
+ * @param indices Full detail mesh, replaced with all the levels one
+ * after the other.
+ * @param meshlets Filled with the meshlets of all the levels.
+ *
+ * @note The chain stops once the simplification is stuck (seams, borders)
+ * or the levels get too small.
+*/
+std::vector<Lod>	buildLods(
+	std::vector<uint32_t>& indices,
+	const std::vector<Vertex>& vertices,
+	std::vector<Meshlet>& meshlets,
+	bool uv_seams
+) {
+	std::vector<Lod>		lods;
+	std::vector<uint32_t>	level;
+	const std::size_t		nb_triangles = indices.size() / 3;
+	float					error = 0.0f;
+
+	level.swap(indices);
+	meshlets.clear();
+
+	auto	appendLevel = [&]() {
+		std::vector<Meshlet>	level_meshlets = buildMeshlets(level, vertices);
+		const Lod				lod{
+			static_cast<uint32_t>(indices.size()),
+			static_cast<uint32_t>(level.size()),
+			static_cast<uint32_t>(meshlets.size()),
+			static_cast<uint32_t>(level_meshlets.size()),
+			error
+		};
+
+		for (Meshlet& meshlet: level_meshlets) {
+			meshlet.first_index += lod.first_index;
+		}
+		indices.insert(indices.end(), level.begin(), level.end());
+		meshlets.insert(meshlets.end(), level_meshlets.begin(), level_meshlets.end());
+		lods.push_back(lod);
+	};
+
+	appendLevel();
+	for (float ratio: lod_ratios) {
+		const std::size_t	target_triangles = static_cast<std::size_t>(nb_triangles * ratio);
+		if (target_triangles < SCOP_LOD_MIN_TRIANGLES) {
+			break;
+		}
+
+		float					level_error;
+		std::vector<uint32_t>	simplified = simplifyMesh(
+			level,
+			vertices,
+			target_triangles * 3,
+			level_error,
+			uv_seams
+		);
+		if (simplified.size() * 10 > level.size() * 9) {
+			break;
+		}
+
+		// Errors add up along the chain
+		error += level_error;
+		level.swap(simplified);
+		optimizeVertexCache(level, vertices.size());
+		appendLevel();
+	}
+	return lods;
+}
+
+/**
+ * @brief Picks the coarsest level whose error, projected at the closest
+ * point of the model bounds, stays under SCOP_LOD_PIXEL_ERROR.
+ *
+ * @param radius Radius of the model bounding sphere.
+ * @param distance Distance from the eye to the model origin.
+ * @param pixel_scale Size in pixels of one unit at distance 1
+ * (viewport height / (2 * tan(fov / 2))).
+*/
+std::size_t	selectLod(
+	const std::vector<Lod>& lods,
+	float radius,
+	float distance,
+	float pixel_scale
+) noexcept {
+	const float	closest = distance - radius;
+	if (lods.empty() || closest <= 0.0f) {
+		return 0;
+	}
+
+	const float	pixels_per_unit = pixel_scale / closest;
+	std::size_t	selected = 0;
+	for (std::size_t i = 1; i < lods.size(); ++i) {
+		if (lods[i].error * pixels_per_unit > SCOP_LOD_PIXEL_ERROR) {
+			break;
+		}
+		selected = i;
+	}
+	return selected;
+}
+
+} // namespace mesh
+} // namespace scop
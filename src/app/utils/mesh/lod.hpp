@@ -0,0 +1,62 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lod.hpp                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 13:41:52 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 13:41:52 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint32_t
+
+# include "vertex.hpp"
+# include "meshlet.hpp"
+
+/**
+ * Largest simplification error drawn, in pixels.
+*/
+# define SCOP_LOD_PIXEL_ERROR		1.0f
+
+/**
+ * Smallest level of detail kept, in triangles.
+*/
+# define SCOP_LOD_MIN_TRIANGLES		64
+
+namespace scop {
+namespace mesh {
+
+/**
+ * Level of detail: range of the index buffer and of the meshlets.
+ *
+ * @note error is the distance to the full detail surface, in model units.
+*/
+struct Lod {
+	uint32_t		first_index;
+	uint32_t		index_count;
+	uint32_t		first_meshlet;
+	uint32_t		meshlet_count;
+	float			error;
+};
+
+std::vector<Lod>	buildLods(
+	std::vector<uint32_t>& indices,
+	const std::vector<Vertex>& vertices,
+	std::vector<Meshlet>& meshlets,
+	bool uv_seams = true
+);
+std::size_t			selectLod(
+	const std::vector<Lod>& lods,
+	float radius,
+	float distance,
+	float pixel_scale
+) noexcept;
+
+} // namespace mesh
+} // namespace scop
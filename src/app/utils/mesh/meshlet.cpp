@@ -0,0 +1,419 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   meshlet.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 11:03:25 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 11:03:25 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "meshlet.hpp"
+
+#include <algorithm>	// std::min, std::max
+#include <array>		// std::array
+#include <cmath>		// std::sqrt
+#include <cstring>	// std::memcpy
+#include <limits>		// std::numeric_limits
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Element (row, column) of a matrix, as read by the shaders
+ * (column major).
+*/
+static float	at(const scop::Mat4& mat, std::size_t row, std::size_t column) noexcept {
+	return mat.mat[column * 4 + row];
+}
+
+/**
+ * @brief Bounding sphere and normal cone of a meshlet.
+ *
+ * @param meshlet_vertices Vertices of the meshlet, each listed once.
+ * @param meshlet_triangles Triangles of the meshlet.
+ * @param normals Unit normal of each triangle, null if degenerate.
+*/
+static void	computeBounds(
+	Meshlet& meshlet,
+	const std::vector<uint32_t>& meshlet_vertices,
+	const std::vector<uint32_t>& meshlet_triangles,
+	const std::vector<Vertex>& vertices,
+	const std::vector<scop::Vect3>& normals
+) {
+	constexpr float	max = std::numeric_limits<float>::max();
+	scop::Vect3		min_pos(max, max, max);
+	scop::Vect3		max_pos(-max, -max, -max);
+
+	// Sphere centered on the bounding box
+	for (uint32_t v: meshlet_vertices) {
+		const scop::Vect3&	pos = vertices[v].pos;
+		min_pos.x = std::min(min_pos.x, pos.x);
+		min_pos.y = std::min(min_pos.y, pos.y);
+		min_pos.z = std::min(min_pos.z, pos.z);
+		max_pos.x = std::max(max_pos.x, pos.x);
+		max_pos.y = std::max(max_pos.y, pos.y);
+		max_pos.z = std::max(max_pos.z, pos.z);
+	}
+	meshlet.center = (min_pos + max_pos) * 0.5f;
+
+	float	radius_sq = 0.0f;
+	for (uint32_t v: meshlet_vertices) {
+		const scop::Vect3	offset = vertices[v].pos - meshlet.center;
+		radius_sq = std::max(radius_sq, scop::dot(offset, offset));
+	}
+	meshlet.radius = std::sqrt(radius_sq);
+
+	// Cone around the average of the (counter clockwise) face normals
+	scop::Vect3	axis(0.0f, 0.0f, 0.0f);
+	for (uint32_t triangle: meshlet_triangles) {
+		axis += normals[triangle];
+	}
+
+	const float	axis_length = scop::norm(axis);
+	meshlet.cone_axis = scop::Vect3(0.0f, 0.0f, 0.0f);
+	meshlet.cone_cutoff = 1.0f;
+	if (axis_length == 0.0f) {
+		return;
+	}
+	meshlet.cone_axis = axis * (1.0f / axis_length);
+
+	float	min_dot = 1.0f;
+	for (uint32_t triangle: meshlet_triangles) {
+		const scop::Vect3&	normal = normals[triangle];
+		if (normal.x != 0.0f || normal.y != 0.0f || normal.z != 0.0f) {
+			min_dot = std::min(min_dot, scop::dot(normal, meshlet.cone_axis));
+		}
+	}
+	if (min_dot > 0.0f) {
+		meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+	}
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Identifies the vertices sharing the same position,
+ * with an open addressing table on the position bits.
+ *
+ * @return The position id of each vertex, in [0, vertices.size()[.
+*/
+std::vector<uint32_t>	computePositionIds(const std::vector<Vertex>& vertices) {
+	std::size_t	capacity = 16;
+	while (capacity < vertices.size() * 2) {
+		capacity *= 2;
+	}
+
+	// Table slot: first vertex with this position
+	std::vector<uint32_t>	table(capacity, UINT32_MAX);
+	std::vector<uint32_t>	position_of(vertices.size());
+	uint32_t				nb_positions = 0;
+
+	for (std::size_t v = 0; v < vertices.size(); ++v) {
+		const scop::Vect3&	pos = vertices[v].pos;
+		uint32_t			bits[3];
+		std::memcpy(&bits[0], &pos.x, sizeof(float));
+		std::memcpy(&bits[1], &pos.y, sizeof(float));
+		std::memcpy(&bits[2], &pos.z, sizeof(float));
+
+		std::size_t	slot = (
+			(bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)
+		) & (capacity - 1);
+		while (table[slot] != UINT32_MAX) {
+			const scop::Vect3&	other = vertices[table[slot]].pos;
+			if (other.x == pos.x && other.y == pos.y && other.z == pos.z) {
+				break;
+			}
+			slot = (slot + 1) & (capacity - 1);
+		}
+		if (table[slot] == UINT32_MAX) {
+			table[slot] = static_cast<uint32_t>(v);
+			position_of[v] = nb_positions++;
+		} else {
+			position_of[v] = position_of[table[slot]];
+		}
+	}
+	return position_of;
+}
+
+/**
+ * @brief Splits the mesh into meshlets, and reorders the index buffer
+ * so that each meshlet is a contiguous range of it.
+ *
+ * @note - Meshlets are grown over the triangles sharing a position with
+ * them (across uv or normal seams), preferring the triangles adding the
+ * fewest vertices, then the ones closest to the average normal,
+ * for compact clusters with narrow normal cones.
+ * @note - A new meshlet starts on the first triangle left in the input
+ * order, so the cache and overdraw orders are kept at the meshlet level.
+*/
+std::vector<Meshlet>	buildMeshlets(
+	std::vector<uint32_t>& indices,
+	const std::vector<Vertex>& vertices,
+	std::size_t max_vertices,
+	std::size_t max_triangles
+) {
+	const std::size_t	nb_triangles = indices.size() / 3;
+
+	// Triangles around each position
+	const std::vector<uint32_t>	position_of = computePositionIds(vertices);
+	std::vector<uint32_t>		first_triangle(vertices.size() + 1, 0);
+	std::vector<uint32_t>		position_triangles(nb_triangles * 3);
+
+	for (std::size_t i = 0; i < nb_triangles * 3; ++i) {
+		++first_triangle[position_of[indices[i]] + 1];
+	}
+	for (std::size_t position = 0; position < vertices.size(); ++position) {
+		first_triangle[position + 1] += first_triangle[position];
+	}
+	std::vector<uint32_t>	fill(first_triangle.begin(), first_triangle.end() - 1);
+	for (std::size_t i = 0; i < nb_triangles * 3; ++i) {
+		position_triangles[fill[position_of[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	// Face normals
+	std::vector<scop::Vect3>	normals(nb_triangles);
+	for (std::size_t triangle = 0; triangle < nb_triangles; ++triangle) {
+		const scop::Vect3&	a = vertices[indices[triangle * 3]].pos;
+		const scop::Vect3	normal = scop::cross(
+			vertices[indices[triangle * 3 + 1]].pos - a,
+			vertices[indices[triangle * 3 + 2]].pos - a
+		);
+		const float			length = scop::norm(normal);
+
+		if (length > 0.0f) {
+			normals[triangle] = normal * (1.0f / length);
+		}
+	}
+
+	std::vector<Meshlet>	meshlets;
+	std::vector<uint32_t>	meshlet_of(vertices.size(), UINT32_MAX);
+	std::vector<uint32_t>	position_meshlet(vertices.size(), UINT32_MAX);
+	std::vector<uint8_t>	emitted(nb_triangles, false);
+	std::vector<uint32_t>	reordered;
+	std::vector<uint32_t>	candidates;
+	std::vector<uint32_t>	meshlet_vertices;
+	std::vector<uint32_t>	meshlet_triangles;
+	std::size_t				seed = 0;
+
+	reordered.reserve(nb_triangles * 3);
+	while (true) {
+		while (seed < nb_triangles && emitted[seed]) {
+			++seed;
+		}
+		if (seed == nb_triangles) {
+			break;
+		}
+
+		const uint32_t	id = static_cast<uint32_t>(meshlets.size());
+		Meshlet			meshlet{};
+		scop::Vect3		axis(0.0f, 0.0f, 0.0f);
+		std::size_t		next = seed;
+
+		// Vertices of a triangle not in the meshlet yet, each counted once
+		auto	countNew = [&](std::size_t triangle) -> std::size_t {
+			const uint32_t	a = indices[triangle * 3];
+			const uint32_t	b = indices[triangle * 3 + 1];
+			const uint32_t	c = indices[triangle * 3 + 2];
+
+			return
+				(meshlet_of[a] != id) +
+				(b != a && meshlet_of[b] != id) +
+				(c != a && c != b && meshlet_of[c] != id);
+		};
+
+		meshlet.first_index = static_cast<uint32_t>(reordered.size());
+		candidates.clear();
+		meshlet_vertices.clear();
+		meshlet_triangles.clear();
+		while (next != nb_triangles) {
+			// Add the triangle, and its neighbours to the candidates
+			emitted[next] = true;
+			axis += normals[next];
+			meshlet_triangles.push_back(static_cast<uint32_t>(next));
+			for (std::size_t corner = 0; corner < 3; ++corner) {
+				const uint32_t	v = indices[next * 3 + corner];
+				const uint32_t	position = position_of[v];
+
+				reordered.push_back(v);
+				if (meshlet_of[v] != id) {
+					meshlet_of[v] = id;
+					meshlet_vertices.push_back(v);
+				}
+				if (position_meshlet[position] == id) {
+					continue;
+				}
+				position_meshlet[position] = id;
+				for (uint32_t k = first_triangle[position]; k < first_triangle[position + 1]; ++k) {
+					if (!emitted[position_triangles[k]]) {
+						candidates.push_back(position_triangles[k]);
+					}
+				}
+			}
+			meshlet.index_count += 3;
+			if (meshlet.index_count / 3 == max_triangles) {
+				break;
+			}
+
+			// Pick the next triangle, around the last one first
+			std::size_t	best_new = max_vertices - meshlet_vertices.size();
+			float		best_dot = -2.0f;
+			auto		consider = [&](uint32_t triangle) {
+				const std::size_t	nb_new = countNew(triangle);
+
+				if (nb_new > best_new) {
+					return;
+				}
+				const float	alignment = scop::dot(normals[triangle], axis);
+				if (nb_new < best_new || alignment > best_dot) {
+					best_new = nb_new;
+					best_dot = alignment;
+					next = triangle;
+				}
+			};
+			const std::size_t	last = next;
+
+			next = nb_triangles;
+			for (std::size_t corner = 0; corner < 3; ++corner) {
+				const uint32_t	position = position_of[indices[last * 3 + corner]];
+
+				for (uint32_t k = first_triangle[position]; k < first_triangle[position + 1]; ++k) {
+					if (!emitted[position_triangles[k]]) {
+						consider(position_triangles[k]);
+					}
+				}
+			}
+			for (std::size_t k = 0; next == nb_triangles && k < candidates.size();) {
+				if (emitted[candidates[k]]) {
+					candidates[k] = candidates.back();
+					candidates.pop_back();
+				} else {
+					consider(candidates[k++]);
+				}
+			}
+		}
+		computeBounds(meshlet, meshlet_vertices, meshlet_triangles, vertices, normals);
+		meshlets.push_back(meshlet);
+	}
+	indices.swap(reordered);
+	return meshlets;
+}
+
+/**
+ * @brief Lists the index ranges of the meshlets that may be visible,
+ * merging the adjacent ones.
+ *
+ * @note - A meshlet is skipped when its bounding sphere is outside of
+ * the view frustum, or when all of its triangles face away from the eye:
+ * dot(center - eye, axis) >= cutoff * |center - eye| + radius * (1 + cutoff)
+ * @note - model is a rigid transform (rotation and translation).
+*/
+void	cullMeshlets(
+	const Meshlet* meshlets,
+	std::size_t nb_meshlets,
+	const scop::Mat4& model,
+	const scop::Mat4& view,
+	const scop::Mat4& proj,
+	std::vector<DrawRange>& ranges
+) {
+	ranges.clear();
+
+	// Frustum planes in world space, from the rows of proj * view
+	// (vulkan clip volume: -w <= x, y <= w, 0 <= z <= w)
+	float	view_proj[4][4];
+	for (std::size_t row = 0; row < 4; ++row) {
+		for (std::size_t column = 0; column < 4; ++column) {
+			view_proj[row][column] = 0.0f;
+			for (std::size_t k = 0; k < 4; ++k) {
+				view_proj[row][column] += at(proj, row, k) * at(view, k, column);
+			}
+		}
+	}
+
+	std::array<std::array<float, 4>, 6>	planes;
+	for (std::size_t column = 0; column < 4; ++column) {
+		planes[0][column] = view_proj[3][column] + view_proj[0][column];
+		planes[1][column] = view_proj[3][column] - view_proj[0][column];
+		planes[2][column] = view_proj[3][column] + view_proj[1][column];
+		planes[3][column] = view_proj[3][column] - view_proj[1][column];
+		planes[4][column] = view_proj[2][column];
+		planes[5][column] = view_proj[3][column] - view_proj[2][column];
+	}
+	for (auto& plane: planes) {
+		const float	length = std::sqrt(
+			plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]
+		);
+		if (length > 0.0f) {
+			for (float& coefficient: plane) {
+				coefficient /= length;
+			}
+		}
+	}
+
+	// Eye position, from the rigid view transform: eye = -R^T * t
+	scop::Vect3	eye;
+	for (std::size_t column = 0; column < 3; ++column) {
+		float	sum = 0.0f;
+		for (std::size_t row = 0; row < 3; ++row) {
+			sum += at(view, row, column) * at(view, row, 3);
+		}
+		eye[column] = -sum;
+	}
+
+	for (std::size_t i = 0; i < nb_meshlets; ++i) {
+		const Meshlet&	meshlet = meshlets[i];
+
+		// Bounds to world space
+		scop::Vect3	center;
+		scop::Vect3	axis;
+		for (std::size_t row = 0; row < 3; ++row) {
+			center[row] = at(model, row, 3);
+			axis[row] = 0.0f;
+			for (std::size_t k = 0; k < 3; ++k) {
+				center[row] += at(model, row, k) * meshlet.center[k];
+				axis[row] += at(model, row, k) * meshlet.cone_axis[k];
+			}
+		}
+
+		bool	visible = true;
+		for (const auto& plane: planes) {
+			const float	distance =
+				plane[0] * center.x + plane[1] * center.y +
+				plane[2] * center.z + plane[3];
+			if (distance < -meshlet.radius) {
+				visible = false;
+				break;
+			}
+		}
+
+		if (visible && meshlet.cone_cutoff < 1.0f) {
+			const scop::Vect3	to_center = center - eye;
+			visible = scop::dot(to_center, axis) < (
+				meshlet.cone_cutoff * scop::norm(to_center) +
+				meshlet.radius * (1.0f + meshlet.cone_cutoff)
+			);
+		}
+
+		if (!visible) {
+			continue;
+		} else if (
+			!ranges.empty() &&
+			ranges.back().first_index + ranges.back().index_count == meshlet.first_index
+		) {
+			ranges.back().index_count += meshlet.index_count;
+		} else {
+			ranges.push_back({ meshlet.first_index, meshlet.index_count });
+		}
+	}
+}
+
+} // namespace mesh
+} // namespace scop
@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   meshlet.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 11:03:25 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 11:03:25 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint32_t
+
+# include "vertex.hpp"
+# include "vector.hpp"
+# include "matrix.hpp"
+
+/**
+ * Meshlet size limits (usual mesh shading limits).
+*/
+# define SCOP_MESHLET_MAX_VERTICES	64
+# define SCOP_MESHLET_MAX_TRIANGLES	124
+
+namespace scop {
+namespace mesh {
+
+/**
+ * Cluster of triangles, stored as a contiguous range of the index buffer.
+ *
+ * @note cone_cutoff is the sine of the normal cone half angle,
+ * 1 if the cluster can't be back-face culled.
+*/
+struct Meshlet {
+	uint32_t		first_index;
+	uint32_t		index_count;
+	scop::Vect3		center;
+	float			radius;
+	scop::Vect3		cone_axis;
+	float			cone_cutoff;
+};
+
+/**
+ * Range of the index buffer to draw.
+*/
+struct DrawRange {
+	uint32_t		first_index;
+	uint32_t		index_count;
+};
+
+std::vector<uint32_t>	computePositionIds(const std::vector<Vertex>& vertices);
+std::vector<Meshlet>	buildMeshlets(
+	std::vector<uint32_t>& indices,
+	const std::vector<Vertex>& vertices,
+	std::size_t max_vertices = SCOP_MESHLET_MAX_VERTICES,
+	std::size_t max_triangles = SCOP_MESHLET_MAX_TRIANGLES
+);
+void					cullMeshlets(
+	const Meshlet* meshlets,
+	std::size_t nb_meshlets,
+	const scop::Mat4& model,
+	const scop::Mat4& view,
+	const scop::Mat4& proj,
+	std::vector<DrawRange>& ranges
+);
+
+} // namespace mesh
+} // namespace scop
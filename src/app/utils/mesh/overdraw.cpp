@@ -0,0 +1,322 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   overdraw.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 12:21:36 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 12:21:36 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "overdraw.hpp"
+
+#include <algorithm>	// std::stable_sort, std::min, std::max
+#include <numeric>		// std::iota
+#include <limits>		// std::numeric_limits
+#include <cmath>		// std::ceil, std::floor
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Directions the overdraw is measured from: along the axes and the diagonals.
+*/
+static constexpr float	overdraw_views[][3] = {
+	{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+	{ 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+	{ 1.0f, 1.0f, 1.0f }, { -1.0f, -1.0f, -1.0f },
+	{ 1.0f, 1.0f, -1.0f }, { -1.0f, -1.0f, 1.0f },
+	{ 1.0f, -1.0f, 1.0f }, { -1.0f, 1.0f, -1.0f },
+	{ -1.0f, 1.0f, 1.0f }, { 1.0f, -1.0f, -1.0f }
+};
+
+/**
+ * @brief Renders the front faces with a depth test, in index buffer order,
+ * orthographically along view_dir, and counts the pixels shaded and covered.
+ *
+ * @param depth Depth buffer, SCOP_OVERDRAW_VIEWPORT squared.
+*/
+static void	rasterizeView(
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions,
+	const scop::Vect3& center,
+	float scale,
+	const scop::Vect3& view_dir,
+	std::vector<float>& depth,
+	std::size_t& shaded,
+	std::size_t& covered
+) {
+	const int	size = SCOP_OVERDRAW_VIEWPORT;
+	const float	half_size = 0.5f * size;
+
+	// Camera basis, right x up facing the viewer
+	const scop::Vect3	up_hint = std::abs(view_dir.y) < 0.9f ?
+		scop::Vect3(0.0f, 1.0f, 0.0f) :
+		scop::Vect3(1.0f, 0.0f, 0.0f);
+	const scop::Vect3	right = scop::normalize(scop::cross(view_dir, up_hint));
+	const scop::Vect3	up = scop::cross(right, view_dir);
+
+	std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::infinity());
+	for (std::size_t t = 0; t + 2 < indices.size(); t += 3) {
+		float	x[3];
+		float	y[3];
+		float	z[3];
+		for (std::size_t corner = 0; corner < 3; ++corner) {
+			const scop::Vect3	pos = positions[indices[t + corner]] - center;
+			x[corner] = scop::dot(pos, right) * scale + half_size;
+			y[corner] = scop::dot(pos, up) * scale + half_size;
+			z[corner] = scop::dot(pos, view_dir);
+		}
+
+		// Counter clockwise front faces only, as the pipeline culls
+		const float	area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area <= 0.0f) {
+			continue;
+		}
+
+		// Pixel centers within the triangle bounding box
+		const int	min_x = std::max(0, static_cast<int>(std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5f)));
+		const int	max_x = std::min(size - 1, static_cast<int>(std::floor(std::max({ x[0], x[1], x[2] }) - 0.5f)));
+		const int	min_y = std::max(0, static_cast<int>(std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5f)));
+		const int	max_y = std::min(size - 1, static_cast<int>(std::floor(std::max({ y[0], y[1], y[2] }) - 0.5f)));
+		const float	inv_area = 1.0f / area;
+
+		for (int py = min_y; py <= max_y; ++py) {
+			const float	cy = py + 0.5f;
+			for (int px = min_x; px <= max_x; ++px) {
+				const float	cx = px + 0.5f;
+				const float	w0 = (x[2] - x[1]) * (cy - y[1]) - (y[2] - y[1]) * (cx - x[1]);
+				const float	w1 = (x[0] - x[2]) * (cy - y[2]) - (y[0] - y[2]) * (cx - x[2]);
+				const float	w2 = (x[1] - x[0]) * (cy - y[0]) - (y[1] - y[0]) * (cx - x[0]);
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+					continue;
+				}
+
+				const float	d = (w0 * z[0] + w1 * z[1] + w2 * z[2]) * inv_area;
+				float&		stored = depth[py * size + px];
+				if (d < stored) {
+					stored = d;
+					++shaded;
+				}
+			}
+		}
+	}
+	for (const float d: depth) {
+		covered += d != std::numeric_limits<float>::infinity();
+	}
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Estimated overdraw of the index buffer: pixels shaded for each
+ * pixel covered, the triangles being drawn in order with a depth test,
+ * over views from several directions around the mesh.
+ *
+ * @note 1 means that no pixel is shaded twice. Orthographic views,
+ * SCOP_OVERDRAW_VIEWPORT pixels wide, framing the bounding sphere.
+*/
+float	analyzeOverdraw(
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions
+) {
+	if (positions.empty() || indices.size() < 3) {
+		return 0.0f;
+	}
+
+	// Bounding sphere, around the box center
+	scop::Vect3	min = positions[0];
+	scop::Vect3	max = positions[0];
+	for (const scop::Vect3& pos: positions) {
+		min = scop::Vect3(std::min(min.x, pos.x), std::min(min.y, pos.y), std::min(min.z, pos.z));
+		max = scop::Vect3(std::max(max.x, pos.x), std::max(max.y, pos.y), std::max(max.z, pos.z));
+	}
+	const scop::Vect3	center = (min + max) * 0.5f;
+	float				radius = 0.0f;
+	for (const scop::Vect3& pos: positions) {
+		radius = std::max(radius, scop::norm(pos - center));
+	}
+	if (radius <= 0.0f) {
+		return 0.0f;
+	}
+	const float	scale = 0.5f * SCOP_OVERDRAW_VIEWPORT / radius;
+
+	std::vector<float>	depth(SCOP_OVERDRAW_VIEWPORT * SCOP_OVERDRAW_VIEWPORT);
+	std::size_t			shaded = 0;
+	std::size_t			covered = 0;
+	for (const auto& view: overdraw_views) {
+		rasterizeView(
+			indices,
+			positions,
+			center,
+			scale,
+			scop::normalize(scop::Vect3(view[0], view[1], view[2])),
+			depth,
+			shaded,
+			covered
+		);
+	}
+	return covered > 0 ? static_cast<float>(shaded) / covered : 0.0f;
+}
+
+/**
+ * @brief Reorders clusters of triangles so that the ones facing out,
+ * and far from the mesh center, are drawn first (Sander et al. 2007).
+ *
+ * @param indices Index buffer, already optimized for the vertex cache.
+ * @param positions Position of each vertex id.
+ * @param threshold Maximum ACMR ratio allowed for each cluster, compared to
+ * its own ACMR in the input order (e.g. 1.05 for 5%). Smaller clusters
+ * give a better sort, at the price of more cache misses.
+ *
+ * @note - Clusters start where the input order breaks vertex reuse
+ * (triangles with 3 cache misses), then are split wherever the ACMR
+ * of the partial cluster drops under the threshold.
+ * @note - Sorting on dot(centroid - mesh_center, normal) approximates
+ * a front-to-back order for all view directions at once.
+*/
+void	optimizeOverdraw(
+	std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions,
+	float threshold,
+	std::size_t cache_size
+) {
+	const std::size_t	nb_triangles = indices.size() / 3;
+
+	if (nb_triangles == 0) {
+		return;
+	}
+
+	// FIFO cache simulation, returns the number of misses of a triangle
+	std::vector<std::size_t>	cache_time(positions.size(), 0);
+	std::size_t					time = cache_size + 1;
+	auto						countMisses = [&](std::size_t triangle) -> std::size_t {
+		std::size_t	misses = 0;
+		for (std::size_t corner = 0; corner < 3; ++corner) {
+			const uint32_t	v = indices[triangle * 3 + corner];
+			if (time - cache_time[v] > cache_size) {
+				cache_time[v] = time++;
+				++misses;
+			}
+		}
+		return misses;
+	};
+	auto						flushCache = [&]() {
+		time += cache_size + 1;
+	};
+
+	// Hard boundaries: the cache optimizer jumped to a disjoint patch
+	std::vector<std::size_t>	hard_boundaries;
+	for (std::size_t i = 0; i < nb_triangles; ++i) {
+		if (countMisses(i) == 3 || i == 0) {
+			hard_boundaries.emplace_back(i);
+		}
+	}
+	hard_boundaries.emplace_back(nb_triangles);
+
+	// Soft boundaries: split clusters while the ACMR stays close enough
+	std::vector<std::size_t>	boundaries;
+	for (std::size_t c = 0; c + 1 < hard_boundaries.size(); ++c) {
+		const std::size_t	start = hard_boundaries[c];
+		const std::size_t	end = hard_boundaries[c + 1];
+
+		flushCache();
+		std::size_t	cluster_misses = 0;
+		for (std::size_t i = start; i < end; ++i) {
+			cluster_misses += countMisses(i);
+		}
+		const float	cluster_threshold =
+			threshold * static_cast<float>(cluster_misses) / (end - start);
+
+		boundaries.emplace_back(start);
+		flushCache();
+		std::size_t	misses = 0;
+		std::size_t	nb_faces = 0;
+		for (std::size_t i = start; i < end; ++i) {
+			misses += countMisses(i);
+			++nb_faces;
+			if (static_cast<float>(misses) / nb_faces <= cluster_threshold) {
+				boundaries.emplace_back(i + 1);
+				flushCache();
+				misses = 0;
+				nb_faces = 0;
+			}
+		}
+		// The last split is below the threshold: merge the leftover with it
+		if (boundaries.back() != start) {
+			boundaries.pop_back();
+		}
+	}
+	boundaries.emplace_back(nb_triangles);
+
+	// Mesh center
+	scop::Vect3	mesh_center{};
+	for (const scop::Vect3& position: positions) {
+		mesh_center += position;
+	}
+	if (!positions.empty()) {
+		mesh_center /= static_cast<float>(positions.size());
+	}
+
+	// Sort key of each cluster, from its area weighted centroid and normal
+	const std::size_t	nb_clusters = boundaries.size() - 1;
+	std::vector<float>	sort_keys(nb_clusters, 0.0f);
+
+	for (std::size_t c = 0; c < nb_clusters; ++c) {
+		scop::Vect3	centroid{};
+		scop::Vect3	normal{};
+		float		area = 0.0f;
+
+		for (std::size_t i = boundaries[c]; i < boundaries[c + 1]; ++i) {
+			const scop::Vect3&	p0 = positions[indices[i * 3 + 0]];
+			const scop::Vect3&	p1 = positions[indices[i * 3 + 1]];
+			const scop::Vect3&	p2 = positions[indices[i * 3 + 2]];
+			const scop::Vect3	face_normal = scop::cross(p1 - p0, p2 - p0);
+			const float			face_area = scop::norm(face_normal);
+
+			centroid += (p0 + p1 + p2) * (face_area / 3.0f);
+			normal += face_normal;
+			area += face_area;
+		}
+		const float	normal_length = scop::norm(normal);
+		if (area > 0.0f && normal_length > 0.0f) {
+			sort_keys[c] = scop::dot(
+				centroid / area - mesh_center,
+				normal / normal_length
+			);
+		}
+	}
+
+	std::vector<std::size_t>	order(nb_clusters);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(
+		order.begin(),
+		order.end(),
+		[&sort_keys](std::size_t lhs, std::size_t rhs) {
+			return sort_keys[lhs] > sort_keys[rhs];
+		}
+	);
+
+	std::vector<uint32_t>	output;
+	output.reserve(indices.size());
+	for (const std::size_t c: order) {
+		output.insert(
+			output.end(),
+			indices.begin() + boundaries[c] * 3,
+			indices.begin() + boundaries[c + 1] * 3
+		);
+	}
+	indices.swap(output);
+}
+
+} // namespace mesh
+} // namespace scop
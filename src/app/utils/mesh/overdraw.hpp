@@ -0,0 +1,48 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   overdraw.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 12:21:36 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 12:21:36 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint32_t
+
+# include "vector.hpp"
+# include "vertex_cache.hpp"
+
+/**
+ * Side in pixels of the views rendered to estimate the overdraw.
+*/
+# define SCOP_OVERDRAW_VIEWPORT 256
+
+/**
+ * Max vertex cache penalty for overdraw ordering (below 1 to disable).
+*/
+# define SCOP_OVERDRAW_THRESHOLD 1.05f
+
+namespace scop {
+namespace mesh {
+
+float	analyzeOverdraw(
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions
+);
+
+void	optimizeOverdraw(
+	std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions,
+	float threshold,
+	std::size_t cache_size = SCOP_VERTEX_CACHE_SIZE
+);
+
+} // namespace mesh
+} // namespace scop
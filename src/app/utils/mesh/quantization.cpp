@@ -0,0 +1,170 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   quantization.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:12:40 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 10:12:40 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "quantization.hpp"
+
+#include <algorithm>	// std::min, std::max, std::clamp, std::copy
+#include <cmath>		// std::fabs, std::lround
+#include <limits>		// std::numeric_limits
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+static uint16_t	quantizeUnorm(float value, float offset, float scale) noexcept {
+	const float	normalized = scale > 0.0f ? (value - offset) / scale : 0.0f;
+
+	return static_cast<uint16_t>(
+		std::lround(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f)
+	);
+}
+
+static int16_t	quantizeSnorm(float value) noexcept {
+	return static_cast<int16_t>(
+		std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f)
+	);
+}
+
+/**
+ * @brief Octahedral encoding: projects the normal on the octahedron
+ * |x| + |y| + |z| = 1, then folds the lower half over the upper one.
+*/
+static void	encodeNormal(const scop::Vect3& normal, int16_t* encoded) noexcept {
+	const float	norm = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+
+	if (norm == 0.0f) {
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float	x = normal.x / norm;
+	float	y = normal.y / norm;
+
+	if (normal.z < 0.0f) {
+		const float	folded_x = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		const float	folded_y = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+
+		x = folded_x;
+		y = folded_y;
+	}
+	encoded[0] = quantizeSnorm(x);
+	encoded[1] = quantizeSnorm(y);
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Computes the position and texture coordinates bounds,
+ * used as the quantization range.
+*/
+Quantization	computeQuantization(const std::vector<Vertex>& vertices) noexcept {
+	Quantization	quantization;
+
+	if (vertices.empty()) {
+		return quantization;
+	}
+
+	constexpr float	max = std::numeric_limits<float>::max();
+	scop::Vect3		pos_min(max, max, max);
+	scop::Vect3		pos_max(-max, -max, -max);
+	scop::Vect2		uv_min(max, max);
+	scop::Vect2		uv_max(-max, -max);
+
+	for (const Vertex& vertex: vertices) {
+		pos_min.x = std::min(pos_min.x, vertex.pos.x);
+		pos_min.y = std::min(pos_min.y, vertex.pos.y);
+		pos_min.z = std::min(pos_min.z, vertex.pos.z);
+		pos_max.x = std::max(pos_max.x, vertex.pos.x);
+		pos_max.y = std::max(pos_max.y, vertex.pos.y);
+		pos_max.z = std::max(pos_max.z, vertex.pos.z);
+		uv_min.x = std::min(uv_min.x, vertex.tex_coord.x);
+		uv_min.y = std::min(uv_min.y, vertex.tex_coord.y);
+		uv_max.x = std::max(uv_max.x, vertex.tex_coord.x);
+		uv_max.y = std::max(uv_max.y, vertex.tex_coord.y);
+	}
+
+	quantization.pos_offset = pos_min;
+	quantization.pos_scale = scop::Vect3(
+		pos_max.x - pos_min.x,
+		pos_max.y - pos_min.y,
+		pos_max.z - pos_min.z
+	);
+	quantization.uv_offset = uv_min;
+	quantization.uv_scale = scop::Vect2(
+		uv_max.x - uv_min.x,
+		uv_max.y - uv_min.y
+	);
+	return quantization;
+}
+
+/**
+ * @brief Encodes the vertices in the compact layout.
+ *
+ * @param compact_vertices Output, of vertices.size() elements
+ * (e.g. the mapped staging buffer).
+*/
+void	quantizeVertices(
+	const std::vector<Vertex>& vertices,
+	const Quantization& quantization,
+	CompactVertex* compact_vertices
+) noexcept {
+	const scop::Vect3&	pos_offset = quantization.pos_offset;
+	const scop::Vect3&	pos_scale = quantization.pos_scale;
+	const scop::Vect2&	uv_offset = quantization.uv_offset;
+	const scop::Vect2&	uv_scale = quantization.uv_scale;
+
+	for (std::size_t i = 0; i < vertices.size(); ++i) {
+		const Vertex&	vertex = vertices[i];
+		CompactVertex	compact;
+
+		compact.pos[0] = quantizeUnorm(vertex.pos.x, pos_offset.x, pos_scale.x);
+		compact.pos[1] = quantizeUnorm(vertex.pos.y, pos_offset.y, pos_scale.y);
+		compact.pos[2] = quantizeUnorm(vertex.pos.z, pos_offset.z, pos_scale.z);
+		compact.pos[3] = 0;
+		encodeNormal(vertex.normal, compact.normal);
+		compact.tex_coord[0] = quantizeUnorm(vertex.tex_coord.x, uv_offset.x, uv_scale.x);
+		compact.tex_coord[1] = quantizeUnorm(vertex.tex_coord.y, uv_offset.y, uv_scale.y);
+
+		compact_vertices[i] = compact;
+	}
+}
+
+/**
+ * @brief Lays the vertices out for the gpu (see GpuVertex): quantized
+ * with the compact layout, copied as is otherwise.
+ *
+ * @param gpu_vertices Output, of vertices.size() elements.
+ * @return The quantization to read them back with.
+*/
+Quantization	layoutVertices(
+	const std::vector<Vertex>& vertices,
+	GpuVertex* gpu_vertices
+) noexcept {
+# if SCOP_COMPACT_VERTEX
+	const Quantization	quantization = computeQuantization(vertices);
+
+	quantizeVertices(vertices, quantization, gpu_vertices);
+	return quantization;
+# else
+	std::copy(vertices.begin(), vertices.end(), gpu_vertices);
+	return Quantization();
+# endif
+}
+
+} // namespace mesh
+} // namespace scop
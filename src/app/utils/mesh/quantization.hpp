@@ -0,0 +1,47 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   quantization.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:12:40 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 10:12:40 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+
+# include "vertex.hpp"
+# include "vector.hpp"
+
+namespace scop {
+namespace mesh {
+
+/**
+ * Maps the [0, 1] range of the quantized attributes back to model space:
+ * value = offset + quantized * scale.
+*/
+struct Quantization {
+	scop::Vect3		pos_offset = scop::Vect3(0.0f, 0.0f, 0.0f);
+	scop::Vect3		pos_scale = scop::Vect3(1.0f, 1.0f, 1.0f);
+	scop::Vect2		uv_offset = scop::Vect2(0.0f, 0.0f);
+	scop::Vect2		uv_scale = scop::Vect2(1.0f, 1.0f);
+};
+
+Quantization	computeQuantization(const std::vector<Vertex>& vertices) noexcept;
+void			quantizeVertices(
+	const std::vector<Vertex>& vertices,
+	const Quantization& quantization,
+	CompactVertex* compact_vertices
+) noexcept;
+Quantization	layoutVertices(
+	const std::vector<Vertex>& vertices,
+	GpuVertex* gpu_vertices
+) noexcept;
+
+} // namespace mesh
+} // namespace scop
@@ -0,0 +1,99 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   report.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:38:24 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:38:24 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "report.hpp"
+#include "overdraw.hpp"
+
+#include <iomanip>		// std::setw, std::setprecision
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+static void	printStats(
+	std::ostream& os,
+	const char* name,
+	float before,
+	float after
+) {
+	os << "  " << std::left << std::setw(20) << name << std::right <<
+		std::setw(8) << before << " -> " << std::setw(8) << after << '\n';
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Post-transform cache (FIFO and LRU, SCOP_VERTEX_CACHE_SIZE entries)
+ * and overdraw figures of the index buffer.
+ *
+ * @param positions Position of each vertex id.
+*/
+MeshStats	analyzeMesh(
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions
+) {
+	return MeshStats{
+		analyzeVertexCache(indices, positions.size(), CACHE_POLICY_FIFO),
+		analyzeVertexCache(indices, positions.size(), CACHE_POLICY_LRU),
+		analyzeOverdraw(indices, positions)
+	};
+}
+
+/**
+ * @brief Prints the report as a table, optimization results shown
+ * as before -> after.
+*/
+void	printMeshReport(std::ostream& os, const MeshReport& report) {
+	const std::size_t	buffers_size = report.index_buffer_size + report.vertex_buffer_size;
+	const std::size_t	full_detail_size =
+		report.nb_triangles * 3 * report.index_size + report.vertex_buffer_size;
+	const auto			flags = os.flags();
+	const auto			precision = os.precision();
+
+	os << std::fixed << std::setprecision(3);
+	os << "Mesh report\n";
+	os << "  parsed: " << report.nb_positions << " positions, " <<
+		report.nb_triangles_before << " triangles, " <<
+		report.nb_corners << " vertices\n";
+	os << "  deduplicated: " << report.nb_vertices << " vertices, " <<
+		report.nb_triangles << " triangles\n";
+
+	os << "Efficiency (input order -> optimized)\n";
+	printStats(os, "ACMR fifo", report.before.fifo.acmr, report.after.fifo.acmr);
+	printStats(os, "ATVR fifo", report.before.fifo.atvr, report.after.fifo.atvr);
+	printStats(os, "ACMR lru", report.before.lru.acmr, report.after.lru.acmr);
+	printStats(os, "ATVR lru", report.before.lru.atvr, report.after.lru.atvr);
+	printStats(os, "overdraw", report.before.overdraw, report.after.overdraw);
+
+	os << "Buffers\n";
+	os << "  index buffer: " << report.index_buffer_size << " bytes (" <<
+		report.nb_indices << " x " << report.index_size << " bytes, " <<
+		report.nb_lods << " levels of detail)\n";
+	os << "  vertex buffer: " << report.vertex_buffer_size << " bytes (" <<
+		report.nb_vertices << " x " << report.vertex_size << " bytes)\n";
+	os << "  total: " << buffers_size << " bytes\n";
+	os << "  bytes per triangle (full detail): " << std::setprecision(1) <<
+		(report.nb_triangles ?
+			static_cast<float>(full_detail_size) / report.nb_triangles :
+			0.0f) << '\n';
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+} // namespace mesh
+} // namespace scop
@@ -0,0 +1,66 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   report.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:38:24 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:38:24 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <ostream> // std::ostream
+# include <cstdint> // uint32_t
+
+# include "vector.hpp"
+# include "vertex_cache.hpp"
+
+namespace scop {
+namespace mesh {
+
+/**
+ * Efficiency of an index buffer over its vertices.
+*/
+struct MeshStats {
+	CacheStats	fifo;
+	CacheStats	lru;
+	float		overdraw;
+};
+
+/**
+ * What --mesh-report prints about a loaded model.
+*/
+struct MeshReport {
+	// As parsed
+	std::size_t	nb_positions;
+	std::size_t	nb_corners;
+	std::size_t	nb_triangles_before;
+
+	// Full detail level, deduplicated and optimized
+	std::size_t	nb_vertices;
+	std::size_t	nb_triangles;
+	MeshStats	before;
+	MeshStats	after;
+
+	// Gpu buffers, all the levels of detail included
+	std::size_t	nb_lods;
+	std::size_t	nb_indices;
+	std::size_t	index_size;
+	std::size_t	index_buffer_size;
+	std::size_t	vertex_size;
+	std::size_t	vertex_buffer_size;
+};
+
+MeshStats	analyzeMesh(
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::Vect3>& positions
+);
+void		printMeshReport(std::ostream& os, const MeshReport& report);
+
+} // namespace mesh
+} // namespace scop
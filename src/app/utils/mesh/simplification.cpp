@@ -0,0 +1,634 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   simplification.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 13:02:11 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 13:02:11 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "simplification.hpp"
+#include "meshlet.hpp"
+
+#include <algorithm>	// std::sort, std::nth_element, std::partition
+#include <cmath>		// std::sqrt, std::abs
+#include <limits>		// std::numeric_limits
+#include <numeric>	// std::iota
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Vertex kinds, deciding where a vertex can be collapsed to.
+ *
+ * @note - MANIFOLD: single vertex at its position, inside the surface.
+ * @note - BORDER: single vertex on an open boundary, collapses along it.
+ * @note - SEAM: two vertices at the same position (uv or normal seam),
+ * both collapse along the seam.
+ * @note - LOCKED: anything else (corners, seam crossings, non manifold).
+*/
+enum VertexKind {
+	KIND_MANIFOLD,
+	KIND_BORDER,
+	KIND_SEAM,
+	KIND_LOCKED
+};
+
+/**
+ * Symmetric plane quadric (A, b, c), with its accumulated weight.
+*/
+struct Quadric {
+	float	a00, a11, a22;
+	float	a10, a20, a21;
+	float	b0, b1, b2;
+	float	c;
+	float	w;
+};
+
+/**
+ * Candidate collapse of a vertex onto another one.
+*/
+struct Collapse {
+	uint32_t	from;
+	uint32_t	to;
+	float		error;
+};
+
+static constexpr uint32_t	no_edge = UINT32_MAX;
+static constexpr uint32_t	many_edges = UINT32_MAX - 1;
+
+static Quadric	planeQuadric(
+	const scop::Vect3& normal,
+	float distance,
+	float weight
+) noexcept {
+	const float	x = normal.x * weight;
+	const float	y = normal.y * weight;
+	const float	z = normal.z * weight;
+
+	return Quadric{
+		x * normal.x, y * normal.y, z * normal.z,
+		x * normal.y, x * normal.z, y * normal.z,
+		x * distance, y * distance, z * distance,
+		distance * distance * weight,
+		weight
+	};
+}
+
+static void	addQuadric(Quadric& quadric, const Quadric& other) noexcept {
+	quadric.a00 += other.a00;
+	quadric.a11 += other.a11;
+	quadric.a22 += other.a22;
+	quadric.a10 += other.a10;
+	quadric.a20 += other.a20;
+	quadric.a21 += other.a21;
+	quadric.b0 += other.b0;
+	quadric.b1 += other.b1;
+	quadric.b2 += other.b2;
+	quadric.c += other.c;
+	quadric.w += other.w;
+}
+
+/**
+ * @brief Weighted mean squared distance from a point to the quadric planes.
+*/
+static float	quadricError(const Quadric& q, const scop::Vect3& p) noexcept {
+	const float	rx = q.a00 * p.x + q.a10 * p.y + q.a20 * p.z;
+	const float	ry = q.a10 * p.x + q.a11 * p.y + q.a21 * p.z;
+	const float	rz = q.a20 * p.x + q.a21 * p.y + q.a22 * p.z;
+	const float	error =
+		rx * p.x + ry * p.y + rz * p.z +
+		2.0f * (q.b0 * p.x + q.b1 * p.y + q.b2 * p.z) +
+		q.c;
+
+	return std::abs(error) / (q.w > 0.0f ? q.w : 1.0f);
+}
+
+/**
+ * @brief Directed edges of the triangles, per starting vertex.
+*/
+static void	buildAdjacency(
+	const std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	std::vector<uint32_t>& offsets,
+	std::vector<uint32_t>& targets
+) {
+	offsets.assign(nb_vertices + 1, 0);
+	for (uint32_t index: indices) {
+		++offsets[index + 1];
+	}
+	for (std::size_t v = 0; v < nb_vertices; ++v) {
+		offsets[v + 1] += offsets[v];
+	}
+
+	targets.resize(indices.size());
+	std::vector<uint32_t>	fill(offsets.begin(), offsets.end() - 1);
+	for (std::size_t i = 0; i < indices.size(); i += 3) {
+		for (std::size_t k = 0; k < 3; ++k) {
+			targets[fill[indices[i + k]]++] = indices[i + (k + 1) % 3];
+		}
+	}
+}
+
+static bool	hasEdge(
+	const std::vector<uint32_t>& offsets,
+	const std::vector<uint32_t>& targets,
+	uint32_t from,
+	uint32_t to
+) noexcept {
+	for (uint32_t k = offsets[from]; k < offsets[from + 1]; ++k) {
+		if (targets[k] == to) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Open edges (without an opposite edge) leaving and entering
+ * each vertex: no_edge if none, many_edges if more than one.
+*/
+static void	findOpenEdges(
+	const std::vector<uint32_t>& offsets,
+	const std::vector<uint32_t>& targets,
+	std::vector<uint32_t>& open_out,
+	std::vector<uint32_t>& open_in
+) {
+	const std::size_t	nb_vertices = offsets.size() - 1;
+
+	open_out.assign(nb_vertices, no_edge);
+	open_in.assign(nb_vertices, no_edge);
+	for (uint32_t from = 0; from < nb_vertices; ++from) {
+		for (uint32_t k = offsets[from]; k < offsets[from + 1]; ++k) {
+			const uint32_t	to = targets[k];
+			if (hasEdge(offsets, targets, to, from)) {
+				continue;
+			}
+			open_out[from] = open_out[from] == no_edge ? to : many_edges;
+			open_in[to] = open_in[to] == no_edge ? from : many_edges;
+		}
+	}
+}
+
+/**
+ * @brief Checks if moving position from to position to turns over
+ * one of the triangles around it.
+*/
+static bool	hasFlips(
+	uint32_t from,
+	uint32_t to,
+	const std::vector<uint32_t>& triangle_offsets,
+	const std::vector<uint32_t>& triangles,
+	const std::vector<uint32_t>& indices,
+	const std::vector<uint32_t>& position_of,
+	const std::vector<scop::Vect3>& positions
+) {
+	for (uint32_t k = triangle_offsets[from]; k < triangle_offsets[from + 1]; ++k) {
+		uint32_t	corners[3];
+		for (std::size_t i = 0; i < 3; ++i) {
+			corners[i] = position_of[indices[triangles[k] * 3 + i]];
+		}
+		if (corners[0] == to || corners[1] == to || corners[2] == to) {
+			continue;
+		}
+
+		const scop::Vect3	before = scop::cross(
+			positions[corners[1]] - positions[corners[0]],
+			positions[corners[2]] - positions[corners[0]]
+		);
+		for (uint32_t& corner: corners) {
+			corner = corner == from ? to : corner;
+		}
+		const scop::Vect3	after = scop::cross(
+			positions[corners[1]] - positions[corners[0]],
+			positions[corners[2]] - positions[corners[0]]
+		);
+		if (scop::dot(before, after) <= 0.25f * scop::norm(before) * scop::norm(after)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Merges the vertices of a position with close enough attributes,
+ * so that only actual uv and normal seams are kept.
+ *
+ * @param uv_seams False to ignore the texture coordinates.
+ *
+ * @return The vertex each vertex is simplified as.
+*/
+static std::vector<uint32_t>	weldWedges(
+	const std::vector<Vertex>& vertices,
+	const std::vector<uint32_t>& first_wedge,
+	const std::vector<uint32_t>& next_wedge,
+	bool uv_seams
+) {
+	const float		uv_epsilon = uv_seams ? 1e-4f : 1.0f;
+	const float		min_cos = std::cos(SCOP_SIMPLIFY_SEAM_ANGLE * static_cast<float>(M_PI) / 180.0f);
+
+	std::vector<uint32_t>	canonical(vertices.size());
+	for (uint32_t first: first_wedge) {
+		uint32_t	v = first;
+		do {
+			canonical[v] = v;
+			for (uint32_t other = first; other != v; other = next_wedge[other]) {
+				if (canonical[other] != other) {
+					continue;
+				}
+				const Vertex&	lhs = vertices[v];
+				const Vertex&	rhs = vertices[other];
+				if (
+					std::abs(lhs.tex_coord.x - rhs.tex_coord.x) <= uv_epsilon &&
+					std::abs(lhs.tex_coord.y - rhs.tex_coord.y) <= uv_epsilon &&
+					scop::dot(lhs.normal, rhs.normal) >= min_cos
+				) {
+					canonical[v] = other;
+					break;
+				}
+			}
+			v = next_wedge[v];
+		} while (v != first);
+	}
+	return canonical;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Simplifies the mesh with quadric error edge collapses,
+ * down to target_index_count indices when possible.
+ *
+ * @param error Set to the largest distance between the simplified
+ * and the source surface, in model units.
+ * @param uv_seams False if the texture coordinates are not meaningful
+ * (generated), and can be merged.
+ *
+ * @note - Vertices are only moved onto their neighbours, so the vertex
+ * buffer is shared with the source mesh.
+ * @note - Seams are collapsed along themselves, both sides at once, so
+ * the uv and normal discontinuities are kept. Borders are collapsed along
+ * themselves too, and weighted to keep their shape.
+ * @note - Collapses are done by passes of independent edges, in increasing
+ * error order, up to SCOP_SIMPLIFY_MAX_ERROR.
+*/
+std::vector<uint32_t>	simplifyMesh(
+	const std::vector<uint32_t>& source,
+	const std::vector<Vertex>& vertices,
+	std::size_t target_index_count,
+	float& error,
+	bool uv_seams
+) {
+	const std::size_t			nb_vertices = vertices.size();
+	const std::vector<uint32_t>	position_of = computePositionIds(vertices);
+	std::size_t					nb_positions = 0;
+
+	for (uint32_t position: position_of) {
+		nb_positions = std::max<std::size_t>(nb_positions, position + 1);
+	}
+	error = 0.0f;
+
+	// Positions in a unit box, for a scale independent error
+	constexpr float	max = std::numeric_limits<float>::max();
+	scop::Vect3		min_pos(max, max, max);
+	float			extent = 0.0f;
+
+	for (const Vertex& vertex: vertices) {
+		min_pos.x = std::min(min_pos.x, vertex.pos.x);
+		min_pos.y = std::min(min_pos.y, vertex.pos.y);
+		min_pos.z = std::min(min_pos.z, vertex.pos.z);
+	}
+	for (const Vertex& vertex: vertices) {
+		extent = std::max(extent, vertex.pos.x - min_pos.x);
+		extent = std::max(extent, vertex.pos.y - min_pos.y);
+		extent = std::max(extent, vertex.pos.z - min_pos.z);
+	}
+	const float	scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+	std::vector<scop::Vect3>	positions(nb_positions);
+	std::vector<uint32_t>		first_wedge(nb_positions, no_edge);
+	std::vector<uint32_t>		next_wedge(nb_vertices);
+
+	for (uint32_t v = 0; v < nb_vertices; ++v) {
+		const uint32_t	position = position_of[v];
+		positions[position] = (vertices[v].pos - min_pos) * scale;
+
+		// Circular list of the vertices sharing the position
+		if (first_wedge[position] == no_edge) {
+			first_wedge[position] = v;
+			next_wedge[v] = v;
+		} else {
+			next_wedge[v] = next_wedge[first_wedge[position]];
+			next_wedge[first_wedge[position]] = v;
+		}
+	}
+
+	// Weld the vertices, and drop degenerate triangles
+	const std::vector<uint32_t>	canonical = weldWedges(
+		vertices,
+		first_wedge,
+		next_wedge,
+		uv_seams
+	);
+	std::vector<uint32_t>		indices;
+
+	indices.reserve(source.size());
+	for (std::size_t i = 0; i + 2 < source.size(); i += 3) {
+		const uint32_t	a = canonical[source[i]];
+		const uint32_t	b = canonical[source[i + 1]];
+		const uint32_t	c = canonical[source[i + 2]];
+		if (
+			position_of[a] != position_of[b] &&
+			position_of[b] != position_of[c] &&
+			position_of[a] != position_of[c]
+		) {
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(c);
+		}
+	}
+
+	std::vector<uint32_t>	offsets;
+	std::vector<uint32_t>	targets;
+	std::vector<uint32_t>	open_out;
+	std::vector<uint32_t>	open_in;
+	buildAdjacency(indices, nb_vertices, offsets, targets);
+	findOpenEdges(offsets, targets, open_out, open_in);
+
+	// Face planes, and planes orthogonal to the borders and seams
+	std::vector<Quadric>	quadrics(nb_positions, Quadric{});
+	for (std::size_t i = 0; i < indices.size(); i += 3) {
+		const scop::Vect3&	p0 = positions[position_of[indices[i]]];
+		scop::Vect3			normal = scop::cross(
+			positions[position_of[indices[i + 1]]] - p0,
+			positions[position_of[indices[i + 2]]] - p0
+		);
+		const float			area = scop::norm(normal);
+		if (area == 0.0f) {
+			continue;
+		}
+		normal = normal / area;
+
+		const Quadric	face = planeQuadric(normal, -scop::dot(normal, p0), area * 0.5f);
+		for (std::size_t k = 0; k < 3; ++k) {
+			const uint32_t	a = indices[i + k];
+			const uint32_t	b = indices[i + (k + 1) % 3];
+			addQuadric(quadrics[position_of[a]], face);
+
+			if (open_out[a] == no_edge || hasEdge(offsets, targets, b, a)) {
+				continue;
+			}
+			const scop::Vect3&	pa = positions[position_of[a]];
+			const scop::Vect3	edge = positions[position_of[b]] - pa;
+			const float			length = scop::norm(edge);
+			scop::Vect3			edge_normal = scop::cross(edge, normal);
+			const float			edge_normal_length = scop::norm(edge_normal);
+			if (edge_normal_length == 0.0f) {
+				continue;
+			}
+			edge_normal = edge_normal / edge_normal_length;
+
+			const Quadric	border = planeQuadric(
+				edge_normal,
+				-scop::dot(edge_normal, pa),
+				length * length * SCOP_SIMPLIFY_BORDER_WEIGHT
+			);
+			addQuadric(quadrics[position_of[a]], border);
+			addQuadric(quadrics[position_of[b]], border);
+		}
+	}
+
+	std::vector<uint8_t>	kinds(nb_positions);
+	std::vector<uint32_t>	partner(nb_vertices);
+	std::vector<uint32_t>	triangle_offsets;
+	std::vector<uint32_t>	triangles;
+	std::vector<Collapse>	collapses;
+	std::vector<uint8_t>	locked(nb_positions);
+	std::vector<uint32_t>	remap(nb_vertices);
+	float					max_error = 0.0f;
+	const float				max_collapse_error =
+		SCOP_SIMPLIFY_MAX_ERROR * SCOP_SIMPLIFY_MAX_ERROR;
+
+	while (indices.size() > target_index_count) {
+		// Classify positions from their live vertices
+		for (uint32_t position = 0; position < nb_positions; ++position) {
+			uint32_t	wedges[2];
+			std::size_t	nb_wedges = 0;
+			uint32_t	v = first_wedge[position];
+			do {
+				if (offsets[v + 1] > offsets[v]) {
+					if (nb_wedges < 2) {
+						wedges[nb_wedges] = v;
+					}
+					++nb_wedges;
+				}
+				v = next_wedge[v];
+			} while (v != first_wedge[position]);
+
+			auto	isOpen = [&](uint32_t edge) {
+				return edge != no_edge && edge != many_edges;
+			};
+
+			kinds[position] = KIND_LOCKED;
+			if (nb_wedges == 1) {
+				const uint32_t	out = open_out[wedges[0]];
+				const uint32_t	in = open_in[wedges[0]];
+				if (out == no_edge && in == no_edge) {
+					kinds[position] = KIND_MANIFOLD;
+				} else if (isOpen(out) && isOpen(in)) {
+					kinds[position] = KIND_BORDER;
+				}
+			} else if (
+				nb_wedges == 2 &&
+				isOpen(open_out[wedges[0]]) && isOpen(open_in[wedges[0]]) &&
+				isOpen(open_out[wedges[1]]) && isOpen(open_in[wedges[1]]) &&
+				position_of[open_out[wedges[0]]] == position_of[open_in[wedges[1]]] &&
+				position_of[open_in[wedges[0]]] == position_of[open_out[wedges[1]]]
+			) {
+				kinds[position] = KIND_SEAM;
+				partner[wedges[0]] = wedges[1];
+				partner[wedges[1]] = wedges[0];
+			}
+		}
+
+		// Vertex the seam partner collapses onto, along the other side
+		auto	partnerTarget = [&](uint32_t from, uint32_t to) {
+			return to == open_out[from] ?
+				open_in[partner[from]] :
+				open_out[partner[from]];
+		};
+
+		auto	canCollapse = [&](uint32_t from, uint32_t to) {
+			const uint8_t	kind_to = kinds[position_of[to]];
+
+			switch (kinds[position_of[from]]) {
+				case KIND_MANIFOLD:
+					return true;
+				case KIND_BORDER:
+					return
+						(kind_to == KIND_BORDER || kind_to == KIND_LOCKED) &&
+						(to == open_out[from] || to == open_in[from]);
+				case KIND_SEAM:
+					return
+						(kind_to == KIND_SEAM || kind_to == KIND_LOCKED) &&
+						(to == open_out[from] || to == open_in[from]) &&
+						position_of[partnerTarget(from, to)] == position_of[to];
+				default:
+					return false;
+			}
+		};
+
+		// Cheapest direction of each edge
+		collapses.clear();
+		for (std::size_t i = 0; i < indices.size(); i += 3) {
+			for (std::size_t k = 0; k < 3; ++k) {
+				const uint32_t	a = indices[i + k];
+				const uint32_t	b = indices[i + (k + 1) % 3];
+				if (a > b && hasEdge(offsets, targets, b, a)) {
+					continue;
+				}
+
+				Collapse	best{ a, b, max };
+				if (canCollapse(a, b)) {
+					best.error = quadricError(quadrics[position_of[a]], positions[position_of[b]]);
+				}
+				if (canCollapse(b, a)) {
+					const float	reverse_error =
+						quadricError(quadrics[position_of[b]], positions[position_of[a]]);
+					if (reverse_error < best.error) {
+						best = Collapse{ b, a, reverse_error };
+					}
+				}
+				if (best.error <= max_collapse_error) {
+					collapses.push_back(best);
+				}
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		// An edge collapse removes about two triangles: only sort the
+		// collapses up to a bit above the error of the goal
+		const std::size_t	triangle_goal = (indices.size() - target_index_count) / 3;
+		const std::size_t	edge_goal = triangle_goal / 2;
+		auto				compare = [](const Collapse& lhs, const Collapse& rhs) {
+			return lhs.error < rhs.error;
+		};
+
+		if (edge_goal < collapses.size()) {
+			std::nth_element(
+				collapses.begin(),
+				collapses.begin() + edge_goal,
+				collapses.end(),
+				compare
+			);
+			const float	error_limit = collapses[edge_goal].error * 1.5f;
+			collapses.erase(
+				std::partition(
+					collapses.begin(),
+					collapses.end(),
+					[error_limit](const Collapse& collapse) {
+						return collapse.error <= error_limit;
+					}
+				),
+				collapses.end()
+			);
+		}
+		std::sort(collapses.begin(), collapses.end(), compare);
+
+		// Triangles around each position
+		triangle_offsets.assign(nb_positions + 1, 0);
+		for (uint32_t index: indices) {
+			++triangle_offsets[position_of[index] + 1];
+		}
+		for (std::size_t position = 0; position < nb_positions; ++position) {
+			triangle_offsets[position + 1] += triangle_offsets[position];
+		}
+		triangles.resize(indices.size());
+		{
+			std::vector<uint32_t>	fill(triangle_offsets.begin(), triangle_offsets.end() - 1);
+			for (std::size_t i = 0; i < indices.size(); ++i) {
+				triangles[fill[position_of[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// Collapse independent edges: positions around a collapse keep
+		// their place for the rest of the pass (1), and both ends of it
+		// are left out of any other collapse (2)
+		std::fill(locked.begin(), locked.end(), 0);
+		std::iota(remap.begin(), remap.end(), 0);
+		std::size_t	triangles_removed = 0;
+
+		for (const Collapse& collapse: collapses) {
+			if (triangles_removed >= triangle_goal) {
+				break;
+			}
+			const uint32_t	from = position_of[collapse.from];
+			const uint32_t	to = position_of[collapse.to];
+			if (
+				locked[from] || locked[to] == 2 ||
+				hasFlips(from, to, triangle_offsets, triangles, indices, position_of, positions)
+			) {
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			if (kinds[from] == KIND_SEAM) {
+				remap[partner[collapse.from]] = partnerTarget(collapse.from, collapse.to);
+			}
+			addQuadric(quadrics[to], quadrics[from]);
+			max_error = std::max(max_error, collapse.error);
+
+			for (uint32_t k = triangle_offsets[from]; k < triangle_offsets[from + 1]; ++k) {
+				bool	removed = false;
+				for (std::size_t i = 0; i < 3; ++i) {
+					const uint32_t	corner = position_of[indices[triangles[k] * 3 + i]];
+					locked[corner] = std::max<uint8_t>(locked[corner], 1);
+					removed |= corner == to;
+				}
+				triangles_removed += removed;
+			}
+			locked[from] = 2;
+			locked[to] = 2;
+		}
+		if (triangles_removed == 0) {
+			break;
+		}
+
+		// Apply, and drop the collapsed triangles
+		std::size_t	nb_indices = 0;
+		for (std::size_t i = 0; i < indices.size(); i += 3) {
+			const uint32_t	a = remap[indices[i]];
+			const uint32_t	b = remap[indices[i + 1]];
+			const uint32_t	c = remap[indices[i + 2]];
+			if (
+				position_of[a] != position_of[b] &&
+				position_of[b] != position_of[c] &&
+				position_of[a] != position_of[c]
+			) {
+				indices[nb_indices++] = a;
+				indices[nb_indices++] = b;
+				indices[nb_indices++] = c;
+			}
+		}
+		indices.resize(nb_indices);
+
+		buildAdjacency(indices, nb_vertices, offsets, targets);
+		findOpenEdges(offsets, targets, open_out, open_in);
+	}
+
+	error = std::sqrt(max_error) * extent;
+	return indices;
+}
+
+} // namespace mesh
+} // namespace scop
@@ -0,0 +1,50 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   simplification.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 13:02:11 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 13:02:11 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint32_t
+
+# include "vertex.hpp"
+
+/**
+ * Weight of the border and seam edge planes, relative to the faces.
+*/
+# define SCOP_SIMPLIFY_BORDER_WEIGHT	10.0f
+
+/**
+ * Largest collapse error, relative to the mesh extent: the simplification
+ * stops there, even above its target.
+*/
+# define SCOP_SIMPLIFY_MAX_ERROR		0.05f
+
+/**
+ * Vertices sharing a position are simplified as one when their normals
+ * are closer than this angle (degrees) and their uvs match.
+*/
+# define SCOP_SIMPLIFY_SEAM_ANGLE		30.0f
+
+namespace scop {
+namespace mesh {
+
+std::vector<uint32_t>	simplifyMesh(
+	const std::vector<uint32_t>& indices,
+	const std::vector<Vertex>& vertices,
+	std::size_t target_index_count,
+	float& error,
+	bool uv_seams = true
+);
+
+} // namespace mesh
+} // namespace scop
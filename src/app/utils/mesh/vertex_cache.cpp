@@ -0,0 +1,229 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   vertex_cache.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 11:48:05 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 11:48:05 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "vertex_cache.hpp"
+
+#include <algorithm>	// std::find, std::rotate
+
+namespace scop {
+namespace mesh {
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Average cache miss ratio: transformed vertices per triangle,
+ * with a FIFO cache of cache_size vertices.
+ *
+ * @note Ranges from 0.5 (ideal grid) to 3 (no reuse at all).
+*/
+float	computeAcmr(
+	const std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	std::size_t cache_size
+) {
+	if (indices.size() < 3) {
+		return 0.0f;
+	}
+
+	// A vertex stays in cache until cache_size other vertices are loaded
+	std::vector<std::size_t>	cache_time(nb_vertices, 0);
+	std::size_t					time = cache_size + 1;
+
+	for (const uint32_t index: indices) {
+		if (time - cache_time[index] > cache_size) {
+			cache_time[index] = time++;
+		}
+	}
+	return static_cast<float>(time - cache_size - 1) / (indices.size() / 3);
+}
+
+/**
+ * @brief Cache misses of the index buffer, per triangle (ACMR) and per vertex
+ * used (ATVR), with a FIFO or LRU cache of cache_size vertices.
+ *
+ * @note The ATVR is 1 when each vertex is transformed only once.
+*/
+CacheStats	analyzeVertexCache(
+	const std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	CachePolicy policy,
+	std::size_t cache_size
+) {
+	if (indices.size() < 3) {
+		return CacheStats{ 0.0f, 0.0f };
+	}
+
+	std::vector<bool>		used(nb_vertices, false);
+	std::vector<uint32_t>	cache;
+	std::size_t				nb_used = 0;
+	std::size_t				misses = 0;
+
+	cache.reserve(cache_size + 1);
+	for (const uint32_t index: indices) {
+		if (!used[index]) {
+			used[index] = true;
+			++nb_used;
+		}
+
+		// Most recent entry first
+		const auto	entry = std::find(cache.begin(), cache.end(), index);
+		if (entry == cache.end()) {
+			++misses;
+			cache.insert(cache.begin(), index);
+			if (cache.size() > cache_size) {
+				cache.pop_back();
+			}
+		} else if (policy == CACHE_POLICY_LRU) {
+			std::rotate(cache.begin(), entry, entry + 1);
+		}
+	}
+	return CacheStats{
+		static_cast<float>(misses) / (indices.size() / 3),
+		static_cast<float>(misses) / nb_used
+	};
+}
+
+/**
+ * @brief Reorders the triangles to reuse the vertices still in the
+ * post-transform cache (Tipsify, Sander et al. 2007).
+ *
+ * @note Triangles are emitted as fans around the current vertex.
+ * The next one is the most recent vertex of the fan that can still be
+ * fanned around without getting out of the cache.
+*/
+void	optimizeVertexCache(
+	std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	std::size_t cache_size
+) {
+	const std::size_t	nb_triangles = indices.size() / 3;
+
+	if (nb_triangles == 0) {
+		return;
+	}
+
+	// Triangles using each vertex
+	std::vector<uint32_t>	offsets(nb_vertices + 1, 0);
+	std::vector<uint32_t>	adjacency(nb_triangles * 3);
+	std::vector<uint32_t>	live_triangles(nb_vertices, 0);
+
+	for (const uint32_t index: indices) {
+		++live_triangles[index];
+	}
+	for (std::size_t v = 0; v < nb_vertices; ++v) {
+		offsets[v + 1] = offsets[v] + live_triangles[v];
+	}
+	{
+		std::vector<uint32_t>	fill = offsets;
+		for (std::size_t i = 0; i < nb_triangles * 3; ++i) {
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<std::size_t>	cache_time(nb_vertices, 0);
+	std::vector<bool>			emitted(nb_triangles, false);
+	std::vector<uint32_t>		dead_ends;
+	std::vector<uint32_t>		candidates;
+	std::vector<uint32_t>		output;
+	std::size_t					time = cache_size + 1;
+	std::size_t					cursor = 0;
+	int64_t						fan_vertex = 0;
+
+	output.reserve(nb_triangles * 3);
+	dead_ends.reserve(nb_triangles * 3);
+
+	while (fan_vertex >= 0) {
+		candidates.clear();
+
+		// Emit every remaining triangle around the fan vertex
+		for (uint32_t i = offsets[fan_vertex]; i < offsets[fan_vertex + 1]; ++i) {
+			const uint32_t	triangle = adjacency[i];
+
+			if (emitted[triangle]) {
+				continue;
+			}
+			for (std::size_t corner = 0; corner < 3; ++corner) {
+				const uint32_t	v = indices[triangle * 3 + corner];
+
+				output.emplace_back(v);
+				dead_ends.emplace_back(v);
+				candidates.emplace_back(v);
+				--live_triangles[v];
+				if (time - cache_time[v] > cache_size) {
+					cache_time[v] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// Pick the next fan vertex among the ones just used
+		fan_vertex = -1;
+		int64_t	best_priority = -1;
+		for (const uint32_t v: candidates) {
+			if (live_triangles[v] == 0) {
+				continue;
+			}
+			int64_t	priority = 0;
+			if (time - cache_time[v] + 2 * live_triangles[v] <= cache_size) {
+				priority = time - cache_time[v];
+			}
+			if (priority > best_priority) {
+				best_priority = priority;
+				fan_vertex = v;
+			}
+		}
+
+		// Dead end: most recent vertex with triangles left, or next in input order
+		while (fan_vertex < 0 && !dead_ends.empty()) {
+			const uint32_t	v = dead_ends.back();
+			dead_ends.pop_back();
+			if (live_triangles[v] > 0) {
+				fan_vertex = v;
+			}
+		}
+		for (; fan_vertex < 0 && cursor < nb_vertices; ++cursor) {
+			if (live_triangles[cursor] > 0) {
+				fan_vertex = cursor;
+			}
+		}
+	}
+	indices.swap(output);
+}
+
+/**
+ * @brief Renumbers the indices in order of first use.
+ *
+ * @return The previous id of each new vertex id.
+*/
+std::vector<uint32_t>	remapVertexFetch(
+	std::vector<uint32_t>& indices,
+	std::size_t nb_vertices
+) {
+	constexpr uint32_t		unused = UINT32_MAX;
+	std::vector<uint32_t>	new_ids(nb_vertices, unused);
+	std::vector<uint32_t>	old_ids;
+
+	old_ids.reserve(nb_vertices);
+	for (uint32_t& index: indices) {
+		if (new_ids[index] == unused) {
+			new_ids[index] = static_cast<uint32_t>(old_ids.size());
+			old_ids.emplace_back(index);
+		}
+		index = new_ids[index];
+	}
+	return old_ids;
+}
+
+} // namespace mesh
+} // namespace scop
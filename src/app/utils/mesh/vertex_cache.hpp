@@ -0,0 +1,82 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   vertex_cache.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 11:48:05 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 11:48:05 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint32_t
+
+/**
+ * FIFO post-transform cache size the index buffer is optimized for.
+*/
+# define SCOP_VERTEX_CACHE_SIZE 16
+
+namespace scop {
+namespace mesh {
+
+enum CachePolicy {
+	CACHE_POLICY_FIFO,
+	CACHE_POLICY_LRU
+};
+
+/**
+ * Post-transform cache efficiency of an index buffer.
+*/
+struct CacheStats {
+	float	acmr;	// transformed vertices per triangle
+	float	atvr;	// transformed vertices per vertex used
+};
+
+float					computeAcmr(
+	const std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	std::size_t cache_size = SCOP_VERTEX_CACHE_SIZE
+);
+CacheStats				analyzeVertexCache(
+	const std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	CachePolicy policy,
+	std::size_t cache_size = SCOP_VERTEX_CACHE_SIZE
+);
+void					optimizeVertexCache(
+	std::vector<uint32_t>& indices,
+	std::size_t nb_vertices,
+	std::size_t cache_size = SCOP_VERTEX_CACHE_SIZE
+);
+std::vector<uint32_t>	remapVertexFetch(
+	std::vector<uint32_t>& indices,
+	std::size_t nb_vertices
+);
+
+/**
+ * @brief Renumbers the vertices in order of first use in the index buffer,
+ * so that vertex fetches follow the index buffer order.
+ *
+ * @note Vertices not used by any triangle are dropped.
+*/
+template<typename T>
+void	optimizeVertexFetch(
+	std::vector<T>& vertices,
+	std::vector<uint32_t>& indices
+) {
+	const std::vector<uint32_t>	old_ids = remapVertexFetch(indices, vertices.size());
+	std::vector<T>				remapped(old_ids.size());
+
+	for (std::size_t i = 0; i < old_ids.size(); ++i) {
+		remapped[i] = vertices[old_ids[i]];
+	}
+	vertices.swap(remapped);
+}
+
+} // namespace mesh
+} // namespace scop
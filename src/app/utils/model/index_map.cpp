@@ -0,0 +1,277 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   index_map.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 11:02:17 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 11:02:17 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "index_map.hpp"
+#include "parallel.hpp"
+
+namespace scop {
+namespace obj {
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Creates a table able to hold nb_expected ids at half load.
+*/
+IndexMap::IndexMap(std::size_t nb_expected) {
+	std::size_t	capacity = 16;
+
+	while (capacity < nb_expected * 2) {
+		capacity <<= 1;
+	}
+	slots.resize(capacity);
+	mask = capacity - 1;
+}
+
+/**
+ * @brief Inserts index with the given id, if not already present.
+ *
+ * @return The id stored for index: either id, or the one
+ * it was first inserted with.
+*/
+uint32_t	IndexMap::insert(const Model::Index& index, uint32_t id) {
+	if ((nb_elements + 1) * 2 > slots.size()) {
+		grow();
+	}
+	for (std::size_t pos = hash(index) & mask;; pos = (pos + 1) & mask) {
+		Slot&	slot = slots[pos];
+
+		if (slot.id == invalid_id) {
+			slot.index = index;
+			slot.id = id;
+			++nb_elements;
+			return id;
+		} else if (
+			slot.index.vertex == index.vertex &&
+			slot.index.texture == index.texture &&
+			slot.index.normal == index.normal
+		) {
+			return slot.id;
+		}
+	}
+}
+
+std::size_t	IndexMap::size() const noexcept {
+	return nb_elements;
+}
+
+/* ========================================================================== */
+
+/**
+ * @brief Order dependent hash of the index triple.
+*/
+uint64_t	IndexMap::hash(const Model::Index& index) noexcept {
+	uint64_t	hash =
+		static_cast<uint32_t>(index.vertex) * 0x9E3779B97F4A7C15ULL ^
+		static_cast<uint32_t>(index.texture) * 0xC2B2AE3D27D4EB4FULL ^
+		static_cast<uint32_t>(index.normal) * 0x165667B19E3779F9ULL;
+
+	hash ^= hash >> 31;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	return hash ^ (hash >> 33);
+}
+
+/**
+ * @brief Builds the index buffer of the triangles, giving one id to each
+ * distinct index triple, in order of first appearance.
+ *
+ * @param unique_indices Index triple of each id.
+ * @param indices One id per triangle corner.
+ * @param nb_threads 0 picks the number of hardware threads for large
+ * meshes, 1 deduplicates on the calling thread.
+ *
+ * @note The result does not depend on the number of threads.
+*/
+void	IndexMap::deduplicate(
+	const std::vector<Model::Triangle>& triangles,
+	std::vector<Model::Index>& unique_indices,
+	std::vector<uint32_t>& indices,
+	std::size_t nb_threads
+) {
+	const std::size_t	nb_corners = triangles.size() * 3;
+
+	nb_threads = scop::parallel::threadCount(
+		nb_corners,
+		SCOP_DEDUP_PARALLEL_THRESHOLD,
+		nb_threads
+	);
+	unique_indices.clear();
+	indices.resize(nb_corners);
+
+	if (nb_threads > 1) {
+		return deduplicateShards(triangles, unique_indices, indices, nb_threads);
+	}
+
+	IndexMap	map(triangles.size());
+
+	for (std::size_t i = 0; i < triangles.size(); ++i) {
+		for (std::size_t corner = 0; corner < 3; ++corner) {
+			const Model::Index&	index = triangles[i].indices[corner];
+			const uint32_t		new_id = static_cast<uint32_t>(unique_indices.size());
+			const uint32_t		id = map.insert(index, new_id);
+
+			if (id == new_id) {
+				unique_indices.emplace_back(index);
+			}
+			indices[i * 3 + corner] = id;
+		}
+	}
+}
+
+/* ========================================================================== */
+/*                                   PRIVATE                                  */
+/* ========================================================================== */
+
+void	IndexMap::grow() {
+	std::vector<Slot>	old_slots(slots.size() * 2);
+
+	old_slots.swap(slots);
+	mask = slots.size() - 1;
+	for (const Slot& old_slot: old_slots) {
+		if (old_slot.id == invalid_id) {
+			continue;
+		}
+		std::size_t	pos = hash(old_slot.index) & mask;
+		while (slots[pos].id != invalid_id) {
+			pos = (pos + 1) & mask;
+		}
+		slots[pos] = old_slot;
+	}
+}
+
+/**
+ * @brief Parallel deduplicate: each thread owns the index triples
+ * whose hash falls in its shard, and numbers them locally.
+ * Corners are first grouped by shard, so that each thread only goes
+ * through its own. Local ids are then renumbered in order of first
+ * appearance, as a serial deduplicate would.
+*/
+void	IndexMap::deduplicateShards(
+	const std::vector<Model::Triangle>& triangles,
+	std::vector<Model::Index>& unique_indices,
+	std::vector<uint32_t>& indices,
+	std::size_t nb_shards
+) {
+	const std::size_t	nb_triangles = triangles.size();
+	const std::size_t	nb_corners = nb_triangles * 3;
+	auto				getIndex = [&triangles](std::size_t corner) -> const Model::Index& {
+		return triangles[corner / 3].indices[corner % 3];
+	};
+
+	// Corners split in one block per thread, for the passes over all of them
+	auto	getBlockStart = [nb_corners, nb_shards](std::size_t block) {
+		return nb_corners * block / nb_shards;
+	};
+
+	// Shard of each corner, counted per block.
+	// The low hash bits are used by the tables.
+	std::vector<uint8_t>		shards(nb_corners);
+	std::vector<std::size_t>	offsets(nb_shards * nb_shards, 0);	// [block][shard]
+
+	scop::parallel::runRanges(nb_shards, nb_shards, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t block = begin; block < end; ++block) {
+			std::size_t*		counts = offsets.data() + block * nb_shards;
+			const std::size_t	block_end = getBlockStart(block + 1);
+
+			for (std::size_t corner = getBlockStart(block); corner < block_end; ++corner) {
+				const uint8_t	shard = static_cast<uint8_t>(
+					(hash(getIndex(corner)) >> 40) % nb_shards
+				);
+
+				shards[corner] = shard;
+				++counts[shard];
+			}
+		}
+	});
+
+	// Counts to offsets, shard by shard, then block by block:
+	// the corners of a shard end up together, in order
+	std::vector<std::size_t>	shard_starts(nb_shards + 1);
+	std::size_t					offset = 0;
+
+	for (std::size_t shard = 0; shard < nb_shards; ++shard) {
+		shard_starts[shard] = offset;
+		for (std::size_t block = 0; block < nb_shards; ++block) {
+			std::size_t&		block_offset = offsets[block * nb_shards + shard];
+			const std::size_t	count = block_offset;
+
+			block_offset = offset;
+			offset += count;
+		}
+	}
+	shard_starts[nb_shards] = offset;
+
+	std::vector<uint32_t>	shard_corners(nb_corners);
+	scop::parallel::runRanges(nb_shards, nb_shards, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t block = begin; block < end; ++block) {
+			std::size_t*		block_offsets = offsets.data() + block * nb_shards;
+			const std::size_t	block_end = getBlockStart(block + 1);
+
+			for (std::size_t corner = getBlockStart(block); corner < block_end; ++corner) {
+				shard_corners[block_offsets[shards[corner]]++] = static_cast<uint32_t>(corner);
+			}
+		}
+	});
+
+	// Local ids, and first corner of each local id
+	std::vector<std::vector<uint32_t>>	first_corners(nb_shards);
+	scop::parallel::runRanges(nb_shards, nb_shards, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t shard = begin; shard < end; ++shard) {
+			IndexMap	map(nb_triangles / nb_shards);
+
+			for (std::size_t i = shard_starts[shard]; i < shard_starts[shard + 1]; ++i) {
+				const uint32_t	corner = shard_corners[i];
+				const uint32_t	new_id = static_cast<uint32_t>(first_corners[shard].size());
+				const uint32_t	id = map.insert(getIndex(corner), new_id);
+
+				if (id == new_id) {
+					first_corners[shard].emplace_back(corner);
+				}
+				indices[corner] = id;
+			}
+		}
+	});
+
+	// Global ids, by merging the first corners of every shard
+	std::vector<std::vector<uint32_t>>	global_ids(nb_shards);
+	std::vector<std::size_t>			cursors(nb_shards, 0);
+	std::size_t							nb_unique = 0;
+
+	for (std::size_t i = 0; i < nb_shards; ++i) {
+		global_ids[i].resize(first_corners[i].size());
+		nb_unique += first_corners[i].size();
+	}
+	unique_indices.reserve(nb_unique);
+	for (std::size_t corner = 0; corner < nb_corners; ++corner) {
+		const uint8_t	shard = shards[corner];
+		std::size_t&	cursor = cursors[shard];
+
+		if (
+			cursor < first_corners[shard].size() &&
+			first_corners[shard][cursor] == corner
+		) {
+			global_ids[shard][cursor++] = static_cast<uint32_t>(unique_indices.size());
+			unique_indices.emplace_back(getIndex(corner));
+		}
+	}
+
+	// Local to global ids
+	scop::parallel::runRanges(nb_corners, nb_shards, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t corner = begin; corner < end; ++corner) {
+			indices[corner] = global_ids[shards[corner]][indices[corner]];
+		}
+	});
+}
+
+} // namespace obj
+} // namespace scop
@@ -0,0 +1,99 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   index_map.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 11:02:17 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 11:02:17 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstdint> // uint32_t, uint64_t
+
+# include "model.hpp"
+
+/**
+ * Meshes with more triangle corners than this are deduplicated
+ * on several threads, unless a thread count is given.
+*/
+# define SCOP_DEDUP_PARALLEL_THRESHOLD (1 << 21)
+
+namespace scop {
+namespace obj {
+
+/**
+ * Open addressing hash table, mapping a (vertex, texture, normal)
+ * index triple to a vertex id.
+*/
+class IndexMap {
+public:
+	/* ========================================================================= */
+	/*                               CONST MEMBERS                               */
+	/* ========================================================================= */
+
+	static constexpr uint32_t	invalid_id = UINT32_MAX;
+
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	explicit IndexMap(std::size_t nb_expected);
+	IndexMap(IndexMap&& x) = default;
+	~IndexMap() = default;
+
+	IndexMap() = delete;
+	IndexMap(const IndexMap& x) = delete;
+	IndexMap&	operator=(const IndexMap& x) = delete;
+
+	/* ========================================================================= */
+
+	uint32_t				insert(const Model::Index& index, uint32_t id);
+	std::size_t				size() const noexcept;
+
+	static uint64_t			hash(const Model::Index& index) noexcept;
+	static void				deduplicate(
+		const std::vector<Model::Triangle>& triangles,
+		std::vector<Model::Index>& unique_indices,
+		std::vector<uint32_t>& indices,
+		std::size_t nb_threads = 0
+	);
+
+private:
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	struct Slot {
+		Model::Index			index;
+		uint32_t				id = invalid_id;
+	};
+
+	/* ========================================================================= */
+	/*                               CLASS MEMBERS                               */
+	/* ========================================================================= */
+
+	std::vector<Slot>		slots;
+	std::size_t				mask = 0;
+	std::size_t				nb_elements = 0;
+
+	/* ========================================================================= */
+
+	void					grow();
+
+	static void				deduplicateShards(
+		const std::vector<Model::Triangle>& triangles,
+		std::vector<Model::Index>& unique_indices,
+		std::vector<uint32_t>& indices,
+		std::size_t nb_shards
+	);
+
+}; // class IndexMap
+
+} // namespace obj
+} // namespace scop
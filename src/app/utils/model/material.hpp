@@ -12,7 +12,7 @@
 
 #pragma once
 
-# include <memory> // std::unique_ptr
+# include <memory> // std::shared_ptr
 
 # include "vector.hpp"
 # include "image_handler.hpp"
@@ -30,19 +30,22 @@ enum IlluminationModel {
 
 /**
  * Contains .mtl file data.
+ *
+ * @note Copies share the texture, which is immutable.
 */
 struct Material {
 	/* ========================================================================= */
 	/*                                  TYPEDEFS                                 */
 	/* ========================================================================= */
 
-	typedef		std::unique_ptr<scop::Image>	ImagePtr;
+	typedef		std::shared_ptr<const scop::Image>	ImagePtr;
 
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
 	/* ========================================================================= */
 
 	Material(Material&& other):
+		library_path(std::move(other.library_path)),
 		name(std::move(other.name)),
 		ambient_color(std::move(other.ambient_color)),
 		diffuse_color(std::move(other.diffuse_color)),
@@ -54,16 +57,18 @@ struct Material {
 		ambient_texture(std::move(other.ambient_texture)) {}
 
 	Material() = default;
+	Material(const Material& other) = default;
 	Material&	operator=(Material&& other) = default;
+	Material&	operator=(const Material& other) = default;
 	~Material() = default;
 
-	Material(const Material& other) = delete;
-	Material&	operator=(const Material& other) = delete;
-
 	/* ========================================================================= */
 	/*                               CLASS MEMBERS                               */
 	/* ========================================================================= */
 
+	// .mtl file the material was parsed from, if any
+	std::string			library_path;
+
 	// newmtl (material name)
 	std::string			name;
 
@@ -0,0 +1,90 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   material_cache.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:16:31 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:16:31 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "material_cache.hpp"
+#include "mtl_parser.hpp"
+#include "file_cache.hpp"
+
+namespace scop {
+namespace mtl {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Material libraries parsed so far, apart for trusted input, which skips
+ * some of the checks.
+*/
+static utils::FileCache<Material>	shared_materials[2];
+
+/**
+ * @brief Whether the texture of the material is still the file
+ * it was decoded from, as it was when the material was parsed.
+*/
+static bool	isTextureCurrent(const Material& material) {
+	utils::FileKey	parsed_key;
+	utils::FileKey	current_key;
+
+	if (
+		material.ambient_texture == nullptr ||
+		!material.ambient_texture->getSourceKey(parsed_key)
+	) {
+		return true;
+	}
+	return
+		utils::getFileKey(material.ambient_texture->getPath(), current_key) &&
+		current_key.size == parsed_key.size &&
+		current_key.mtime == parsed_key.mtime;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Material of the .mtl file, parsed once for the whole process,
+ * its texture shared as well (see getSharedImage).
+ *
+ * @note Parsed again when the .mtl or its texture changed since.
+*/
+std::shared_ptr<const Material>	getSharedMaterial(
+	const std::string& path,
+	bool trusted_input
+) {
+	utils::FileCache<Material>&		cache = shared_materials[trusted_input];
+	auto							load = [trusted_input](const std::string& mtl_path) {
+		MtlParser	parser;
+
+		parser.setTrustedInput(trusted_input);
+		return new Material(parser.parseFile(mtl_path));
+	};
+	std::shared_ptr<const Material>	material = cache.get(path, load);
+
+	if (!isTextureCurrent(*material)) {
+		cache.erase(path);
+		material = cache.get(path, load);
+	}
+	return material;
+}
+
+/**
+ * @brief Drops the cached materials, still alive for their users.
+*/
+void	clearSharedMaterials() {
+	for (utils::FileCache<Material>& cache: shared_materials) {
+		cache.clear();
+	}
+}
+
+} // namespace mtl
+} // namespace scop
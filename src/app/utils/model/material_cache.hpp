@@ -0,0 +1,31 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   material_cache.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:16:31 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:16:31 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <memory> // std::shared_ptr
+# include <string> // std::string
+
+# include "material.hpp"
+
+namespace scop {
+namespace mtl {
+
+std::shared_ptr<const Material>	getSharedMaterial(
+	const std::string& path,
+	bool trusted_input
+);
+void							clearSharedMaterials();
+
+} // namespace mtl
+} // namespace scop
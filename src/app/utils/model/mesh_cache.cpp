@@ -0,0 +1,517 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   mesh_cache.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:12:41 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 10:12:41 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "mesh_cache.hpp"
+#include "utils.hpp"	// LOG
+#include "image_cache.hpp"
+#include "codec.hpp"
+#include "weld.hpp"
+#include "smooth_normals.hpp"
+#include "overdraw.hpp"
+#include "vertex_cache.hpp"
+#include "lod.hpp"
+#include "simplification.hpp"
+#include "file_cache.hpp"
+
+#include <fstream>		// std::ofstream
+#include <cstdio>		// std::rename, std::remove
+#include <cstring>		// std::memcpy, std::memcmp
+#include <algorithm>	// std::min, std::all_of
+#include <type_traits>	// std::is_trivially_copyable_v
+
+#include <sys/stat.h>	// stat
+
+namespace scop {
+namespace obj {
+
+static_assert(
+	std::is_trivially_copyable_v<scop::GpuVertex>,
+	"Vertices are encoded as raw bytes in the cache file"
+);
+static_assert(
+	std::is_trivially_copyable_v<scop::mesh::Meshlet>,
+	"Meshlets are copied as is from the cache file"
+);
+static_assert(
+	std::is_trivially_copyable_v<scop::mesh::Lod>,
+	"Levels of detail are copied as is from the cache file"
+);
+static_assert(
+	std::is_trivially_copyable_v<scop::mesh::Bounds>,
+	"Bounds are copied as is from the cache file"
+);
+static_assert(
+	std::is_trivially_copyable_v<scop::mesh::Quantization>,
+	"Quantization is copied as is from the cache file"
+);
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Size and mtime (ns) of a file.
+ *
+ * @return false if the file does not exist.
+*/
+static bool	getFileStat(
+	const std::string& path,
+	uint64_t& size,
+	int64_t& mtime
+) noexcept {
+	struct stat	file_stat;
+
+	if (::stat(path.c_str(), &file_stat) == -1) {
+		return false;
+	}
+	size = static_cast<uint64_t>(file_stat.st_size);
+	mtime =
+		static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+		file_stat.st_mtim.tv_nsec;
+	return true;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Maps the cache of a model, if it exists and still matches
+ * the source file, its material library and the processing settings.
+ *
+ * @note The source file is only hashed when its mtime changed.
+ * @return false if there is no valid cache.
+*/
+bool	MeshCache::load(const std::string& model_path) {
+	if (
+		!file.open(getCachePath(model_path)) ||
+		file.size() < sizeof(Header)
+	) {
+		file.close();
+		return false;
+	}
+	std::memcpy(&header, file.data(), sizeof(Header));
+
+	// Check format
+	const Options	options = getOptions();
+	const bool		valid_format =
+		std::memcmp(header.magic, "SCOPMSH", sizeof(header.magic)) == 0 &&
+		header.version == SCOP_MESH_CACHE_VERSION &&
+		header.vertex_size == sizeof(scop::GpuVertex) &&
+		std::memcmp(&header.options, &options, sizeof(Options)) == 0 &&
+		checkSection(header.vertices) &&
+		checkSection(header.indices) &&
+		checkSection(header.meshlets) &&
+		checkSection(header.lods) &&
+		checkSection(header.material_name) &&
+		checkSection(header.texture_path) &&
+		checkSection(header.library_path) &&
+		header.texture_path.size > 0 &&
+		header.meshlets.size % sizeof(scop::mesh::Meshlet) == 0 &&
+		header.lods.size % sizeof(scop::mesh::Lod) == 0 &&
+		checkRanges() &&
+		scop::mesh::checkVertices(
+			reinterpret_cast<const uint8_t*>(file.data() + header.vertices.offset),
+			header.vertices.size,
+			header.nb_vertices,
+			sizeof(scop::GpuVertex)
+		);
+
+	// Check source: same size, then same mtime or same content
+	Header	source{};
+	bool	valid_source =
+		valid_format &&
+		getSourceKey(model_path, source, false) &&
+		source.source_size == header.source_size;
+
+	if (valid_source && source.source_mtime != header.source_mtime) {
+		valid_source =
+			getSourceKey(model_path, source, true) &&
+			source.source_hash == header.source_hash;
+	}
+
+	if (!valid_source || !checkLibrary()) {
+		file.close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Writes the cache of a model, once its buffers are final.
+ *
+ * @note Failing to write the cache is not an error, the model
+ * will just be parsed again next time.
+*/
+void	MeshCache::save(
+	const std::string& model_path,
+	const std::vector<scop::Vertex>& vertices,
+	const std::vector<uint32_t>& indices,
+	const std::vector<scop::mesh::Meshlet>& meshlets,
+	const std::vector<scop::mesh::Lod>& lods,
+	const scop::mesh::Bounds& bounds,
+	const mtl::Material& material
+) noexcept {
+	const std::string	cache_path = getCachePath(model_path);
+	const std::string	tmp_path = cache_path + ".tmp";
+
+	try {
+		Header	header{};
+
+		std::memcpy(header.magic, "SCOPMSH", sizeof(header.magic));
+		header.version = SCOP_MESH_CACHE_VERSION;
+		header.vertex_size = sizeof(scop::GpuVertex);
+		header.options = getOptions();
+		header.bounds = bounds;
+		if (
+			!getSourceKey(model_path, header, true) || (
+				!material.library_path.empty() &&
+				!getFileStat(
+					material.library_path,
+					header.library_size,
+					header.library_mtime
+				)
+			)
+		) {
+			return;
+		}
+
+		// Material, its texture reloaded from its path
+		const scop::Image*	texture = material.ambient_texture.get();
+		const std::string	texture_path = texture ? texture->getPath() : "";
+		if (texture_path.empty()) {
+			return;
+		}
+
+		header.ambient_color = material.ambient_color;
+		header.diffuse_color = material.diffuse_color;
+		header.specular_color = material.specular_color;
+		header.emissive_color = material.emissive_color;
+		header.opacity = material.opacity;
+		header.shininess = material.shininess;
+		header.illum = static_cast<int32_t>(material.illum);
+
+		// Layout, each section 16 bytes aligned
+		uint64_t	end_offset = sizeof(Header);
+		auto		addSection = [&end_offset](uint64_t size) -> Section {
+			const Section	section = { (end_offset + 15) & ~uint64_t(15), size };
+			end_offset = section.offset + size;
+			return section;
+		};
+
+		// Geometry, vertices as uploaded
+		std::vector<scop::GpuVertex>	gpu_vertices(vertices.size());
+		header.quantization = scop::mesh::layoutVertices(vertices, gpu_vertices.data());
+
+		const std::vector<uint8_t>	encoded_vertices = scop::mesh::encodeVertices(
+			gpu_vertices.data(),
+			gpu_vertices.size(),
+			sizeof(scop::GpuVertex)
+		);
+		const std::vector<uint8_t>	encoded_indices = scop::mesh::encodeIndices(indices);
+		header.nb_vertices = vertices.size();
+		header.nb_indices = indices.size();
+
+		header.vertices = addSection(encoded_vertices.size());
+		header.indices = addSection(encoded_indices.size());
+		header.meshlets = addSection(meshlets.size() * sizeof(scop::mesh::Meshlet));
+		header.lods = addSection(lods.size() * sizeof(scop::mesh::Lod));
+		header.material_name = addSection(material.name.size());
+		header.texture_path = addSection(texture_path.size());
+		header.library_path = addSection(material.library_path.size());
+
+		// Written aside then renamed, so a partial cache is never loaded
+		std::ofstream	out(tmp_path, std::ios::binary | std::ios::trunc);
+		auto			writeSection =
+			[&out](const Section& section, const void* data) {
+				static const char	padding[16] = {};
+				const std::size_t	pos = static_cast<std::size_t>(out.tellp());
+
+				out.write(padding, section.offset - pos);
+				out.write(static_cast<const char*>(data), section.size);
+			};
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		writeSection(header.vertices, encoded_vertices.data());
+		writeSection(header.indices, encoded_indices.data());
+		writeSection(header.meshlets, meshlets.data());
+		writeSection(header.lods, lods.data());
+		writeSection(header.material_name, material.name.data());
+		writeSection(header.texture_path, texture_path.data());
+		writeSection(header.library_path, material.library_path.data());
+		out.close();
+
+		if (!out || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+			std::remove(tmp_path.c_str());
+			LOG("Could not write mesh cache " << cache_path);
+		}
+	} catch (const std::exception& e) {
+		std::remove(tmp_path.c_str());
+		LOG("Could not write mesh cache " << cache_path << ": " << e.what());
+	}
+}
+
+/* ========================================================================== */
+
+/**
+ * @brief Decodes the index buffer.
+ *
+ * @return false if it is corrupted, or if an index is out of range.
+*/
+bool	MeshCache::decodeIndices(std::vector<uint32_t>& indices) const {
+	// Every 4 indices take a byte at least
+	if (header.nb_indices > header.indices.size * 4) {
+		return false;
+	}
+
+	indices.resize(header.nb_indices);
+	const bool	decoded = scop::mesh::decodeIndices(
+		reinterpret_cast<const uint8_t*>(file.data() + header.indices.offset),
+		header.indices.size,
+		indices.data(),
+		indices.size()
+	);
+
+	return decoded && std::all_of(
+		indices.begin(),
+		indices.end(),
+		[this](uint32_t index) { return index < header.nb_vertices; }
+	);
+}
+
+/**
+ * @brief Decodes the getNbVertices() vertices to dst, in the gpu layout
+ * (e.g. the mapped staging buffer).
+ *
+ * @note The stream was checked on load, this only fails on a bug.
+*/
+bool	MeshCache::decodeVertices(scop::GpuVertex* dst) const noexcept {
+	return scop::mesh::decodeVertices(
+		reinterpret_cast<const uint8_t*>(file.data() + header.vertices.offset),
+		header.vertices.size,
+		dst,
+		header.nb_vertices,
+		sizeof(scop::GpuVertex)
+	);
+}
+
+std::size_t	MeshCache::getNbVertices() const noexcept {
+	return header.nb_vertices;
+}
+
+const scop::mesh::Quantization&	MeshCache::getQuantization() const noexcept {
+	return header.quantization;
+}
+
+const scop::mesh::Meshlet*	MeshCache::getMeshlets() const noexcept {
+	return reinterpret_cast<const scop::mesh::Meshlet*>(
+		file.data() + header.meshlets.offset
+	);
+}
+
+std::size_t	MeshCache::getNbMeshlets() const noexcept {
+	return header.meshlets.size / sizeof(scop::mesh::Meshlet);
+}
+
+const scop::mesh::Lod*	MeshCache::getLods() const noexcept {
+	return reinterpret_cast<const scop::mesh::Lod*>(
+		file.data() + header.lods.offset
+	);
+}
+
+std::size_t	MeshCache::getNbLods() const noexcept {
+	return header.lods.size / sizeof(scop::mesh::Lod);
+}
+
+const scop::mesh::Bounds&	MeshCache::getBounds() const noexcept {
+	return header.bounds;
+}
+
+/**
+ * @brief Rebuilds the material, its texture loaded from its path,
+ * deferred (see getSharedImage).
+*/
+mtl::Material	MeshCache::getMaterial() const {
+	mtl::Material	material;
+
+	material.library_path = getString(header.library_path);
+	material.name = getString(header.material_name);
+	material.ambient_color = header.ambient_color;
+	material.diffuse_color = header.diffuse_color;
+	material.specular_color = header.specular_color;
+	material.emissive_color = header.emissive_color;
+	material.opacity = header.opacity;
+	material.shininess = header.shininess;
+	material.illum = static_cast<mtl::IlluminationModel>(header.illum);
+	material.ambient_texture = scop::getSharedImage(getString(header.texture_path));
+	return material;
+}
+
+/* ========================================================================== */
+/*                                   PRIVATE                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Cache file path: the model path, with the cache extension.
+*/
+std::string	MeshCache::getCachePath(const std::string& model_path) {
+	return utils::replaceExtension(model_path, SCOP_MESH_CACHE_EXTENSION);
+}
+
+/**
+ * @brief Settings of every step the cached buffers went through,
+ * from welding to the levels of detail.
+*/
+MeshCache::Options	MeshCache::getOptions() noexcept {
+	static_assert(
+		sizeof(Options) == 12 * sizeof(uint32_t),
+		"Options are compared as raw bytes, without padding"
+	);
+	Options	options;
+
+	options.weld_epsilon = static_cast<float>(SCOP_WELD_EPSILON);
+	options.weld_cell_scale = static_cast<float>(SCOP_WELD_CELL_SCALE);
+	options.crease_angle = static_cast<float>(SCOP_NORMAL_CREASE_ANGLE);
+	options.overdraw_threshold = static_cast<float>(SCOP_OVERDRAW_THRESHOLD);
+	options.overdraw_viewport = SCOP_OVERDRAW_VIEWPORT;
+	options.vertex_cache_size = SCOP_VERTEX_CACHE_SIZE;
+	options.meshlet_max_vertices = SCOP_MESHLET_MAX_VERTICES;
+	options.meshlet_max_triangles = SCOP_MESHLET_MAX_TRIANGLES;
+	options.lod_min_triangles = SCOP_LOD_MIN_TRIANGLES;
+	options.simplify_border_weight = static_cast<float>(SCOP_SIMPLIFY_BORDER_WEIGHT);
+	options.simplify_max_error = static_cast<float>(SCOP_SIMPLIFY_MAX_ERROR);
+	options.simplify_seam_angle = static_cast<float>(SCOP_SIMPLIFY_SEAM_ANGLE);
+	return options;
+}
+
+/**
+ * @brief Retrieves the size, mtime and optionally the content hash
+ * of the source file.
+*/
+bool	MeshCache::getSourceKey(
+	const std::string& model_path,
+	Header& key,
+	bool with_hash
+) noexcept {
+	if (!getFileStat(model_path, key.source_size, key.source_mtime)) {
+		return false;
+	}
+
+	if (with_hash) {
+		utils::MappedFile	source;
+
+		if (!source.open(model_path) || source.size() != key.source_size) {
+			return false;
+		}
+		key.source_hash = hashContent(source.data(), source.size());
+	}
+	return true;
+}
+
+/**
+ * @brief 64 bits hash of the content, on 4 interleaved lanes.
+ * Not cryptographic, only meant to detect a modified file.
+*/
+uint64_t	MeshCache::hashContent(const char* data, std::size_t size) noexcept {
+	constexpr uint64_t	multiplier = 0xFF51AFD7ED558CCDULL;
+	uint64_t			lanes[4] = {
+		0x9E3779B97F4A7C15ULL ^ size,
+		0xC2B2AE3D27D4EB4FULL,
+		0x165667B19E3779F9ULL,
+		0x27D4EB2F165667C5ULL
+	};
+	auto				mix = [](uint64_t hash, uint64_t word) -> uint64_t {
+		hash = (hash ^ word) * multiplier;
+		return hash ^ (hash >> 32);
+	};
+
+	std::size_t	i = 0;
+	for (; i + 32 <= size; i += 32) {
+		uint64_t	words[4];
+		std::memcpy(words, data + i, sizeof(words));
+		for (std::size_t lane = 0; lane < 4; ++lane) {
+			lanes[lane] = mix(lanes[lane], words[lane]);
+		}
+	}
+	for (; i < size; i += 8) {
+		uint64_t	word = 0;
+		std::memcpy(&word, data + i, std::min<std::size_t>(8, size - i));
+		lanes[0] = mix(lanes[0], word);
+	}
+	return mix(mix(mix(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+}
+
+bool	MeshCache::checkSection(const Section& section) const noexcept {
+	return
+		section.offset % 16 == 0 &&
+		section.offset <= file.size() &&
+		section.size <= file.size() - section.offset;
+}
+
+/**
+ * @brief Checks that the meshlets and levels of detail only reference
+ * indices and meshlets within the cached buffers, and that the first
+ * level is the full detail one, at the start of the index buffer.
+*/
+bool	MeshCache::checkRanges() const noexcept {
+	const scop::mesh::Meshlet*	meshlets = getMeshlets();
+	const scop::mesh::Lod*		lods = getLods();
+
+	if (getNbLods() == 0 || lods[0].first_index != 0 || lods[0].index_count == 0) {
+		return false;
+	}
+
+	for (std::size_t i = 0; i < getNbMeshlets(); ++i) {
+		if (
+			uint64_t(meshlets[i].first_index) + meshlets[i].index_count >
+			header.nb_indices
+		) {
+			return false;
+		}
+	}
+	for (std::size_t i = 0; i < getNbLods(); ++i) {
+		if (
+			uint64_t(lods[i].first_index) + lods[i].index_count >
+				header.nb_indices ||
+			uint64_t(lods[i].first_meshlet) + lods[i].meshlet_count >
+				getNbMeshlets()
+		) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that the material library, if any, is the one
+ * the cache was built with.
+*/
+bool	MeshCache::checkLibrary() const {
+	if (header.library_path.size == 0) {
+		return true;
+	}
+
+	uint64_t	size;
+	int64_t		mtime;
+
+	return
+		getFileStat(getString(header.library_path), size, mtime) &&
+		size == header.library_size &&
+		mtime == header.library_mtime;
+}
+
+std::string	MeshCache::getString(const Section& section) const {
+	return std::string(file.data() + section.offset, section.size);
+}
+
+} // namespace obj
+} // namespace scop
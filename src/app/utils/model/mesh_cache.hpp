@@ -0,0 +1,182 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   mesh_cache.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:12:41 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 10:12:41 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <string> // std::string
+# include <vector> // std::vector
+# include <cstdint> // uint32_t, uint64_t
+
+# include "vertex.hpp"
+# include "meshlet.hpp"
+# include "lod.hpp"
+# include "bounds.hpp"
+# include "quantization.hpp"
+# include "material.hpp"
+# include "mapped_file.hpp"
+
+# define SCOP_MESH_CACHE_EXTENSION ".scopmesh"
+# define SCOP_MESH_CACHE_VERSION 12
+
+namespace scop {
+namespace obj {
+
+/**
+ * Binary cache of a loaded model (.scopmesh), written next to the .obj file.
+ *
+ * Holds the final index buffer, the vertices already in the gpu layout
+ * (see GpuVertex) with their quantization, the meshlets and levels
+ * of detail, the model bounds, the material and its texture path,
+ * so that a warm start skips parsing and deduplication. The texture
+ * pixels are left to the image and texture caches (see texture_cache.hpp).
+ * Valid as long as the .obj, its .mtl and the mesh processing settings
+ * it was built with are unchanged.
+ * Buffers are 16 bytes aligned in the file, to be copied as is from the
+ * mapping, except the vertices and indices, stored encoded (see codec.hpp).
+*/
+class MeshCache {
+public:
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	MeshCache() = default;
+	MeshCache(MeshCache&& x) = default;
+	~MeshCache() = default;
+
+	MeshCache(const MeshCache& x) = delete;
+	MeshCache&	operator=(const MeshCache& x) = delete;
+
+	/* ========================================================================= */
+
+	bool					load(const std::string& model_path);
+	static void				save(
+		const std::string& model_path,
+		const std::vector<scop::Vertex>& vertices,
+		const std::vector<uint32_t>& indices,
+		const std::vector<scop::mesh::Meshlet>& meshlets,
+		const std::vector<scop::mesh::Lod>& lods,
+		const scop::mesh::Bounds& bounds,
+		const mtl::Material& material
+	) noexcept;
+
+	bool					decodeIndices(std::vector<uint32_t>& indices) const;
+	bool					decodeVertices(scop::GpuVertex* vertices) const noexcept;
+	std::size_t				getNbVertices() const noexcept;
+	const scop::mesh::Quantization&	getQuantization() const noexcept;
+	const scop::mesh::Meshlet*	getMeshlets() const noexcept;
+	std::size_t				getNbMeshlets() const noexcept;
+	const scop::mesh::Lod*	getLods() const noexcept;
+	std::size_t				getNbLods() const noexcept;
+	const scop::mesh::Bounds&	getBounds() const noexcept;
+	mtl::Material			getMaterial() const;
+
+private:
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	/**
+	 * Byte range in the cache file.
+	*/
+	struct Section {
+		uint64_t				offset;
+		uint64_t				size;
+	};
+
+	/**
+	 * Mesh processing settings the buffers were built with.
+	 * 32-bit fields only, compared as raw bytes.
+	*/
+	struct Options {
+		float					weld_epsilon;
+		float					weld_cell_scale;
+		float					crease_angle;
+		float					overdraw_threshold;
+		uint32_t				overdraw_viewport;
+		uint32_t				vertex_cache_size;
+		uint32_t				meshlet_max_vertices;
+		uint32_t				meshlet_max_triangles;
+		uint32_t				lod_min_triangles;
+		float					simplify_border_weight;
+		float					simplify_max_error;
+		float					simplify_seam_angle;
+	};
+
+	/**
+	 * Cache file header, followed by the sections.
+	*/
+	struct Header {
+		char					magic[8];
+		uint32_t				version;
+		uint32_t				vertex_size;
+		Options					options;
+
+		// Source file key
+		uint64_t				source_size;
+		int64_t					source_mtime;
+		uint64_t				source_hash;
+
+		Section					vertices;
+		Section					indices;
+		uint64_t				nb_vertices;
+		uint64_t				nb_indices;
+		Section					meshlets;
+		Section					lods;
+		Section					material_name;
+		Section					texture_path;
+
+		// Material library key
+		Section					library_path;
+		uint64_t				library_size;
+		int64_t					library_mtime;
+
+		scop::mesh::Bounds		bounds;
+		scop::mesh::Quantization	quantization;
+
+		scop::Vect3				ambient_color;
+		scop::Vect3				diffuse_color;
+		scop::Vect3				specular_color;
+		scop::Vect3				emissive_color;
+		float					opacity;
+		int32_t					shininess;
+		int32_t					illum;
+	};
+
+	/* ========================================================================= */
+	/*                               CLASS MEMBERS                               */
+	/* ========================================================================= */
+
+	utils::MappedFile		file;
+	Header					header{};
+
+	/* ========================================================================= */
+
+	static std::string		getCachePath(const std::string& model_path);
+	static Options			getOptions() noexcept;
+	static bool				getSourceKey(
+		const std::string& model_path,
+		Header& key,
+		bool with_hash
+	) noexcept;
+	static uint64_t			hashContent(const char* data, std::size_t size) noexcept;
+
+	bool					checkSection(const Section& section) const noexcept;
+	bool					checkRanges() const noexcept;
+	bool					checkLibrary() const;
+	std::string				getString(const Section& section) const;
+
+}; // class MeshCache
+
+} // namespace obj
+} // namespace scop
@@ -16,7 +16,9 @@
 #include "vertex.hpp"
 #include "utils.hpp"
 #include "material.hpp"
-#include "ppm_loader.hpp"
+#include "image_cache.hpp"
+#include "smooth_normals.hpp"
+#include "weld.hpp"
 
 namespace scop {
 namespace obj {
@@ -32,7 +34,9 @@ normal_coords(std::move(x.normal_coords)),
 indices(std::move(x.indices)),
 triangles(std::move(x.triangles)),
 material(std::move(x.material)),
-smooth_shading(x.smooth_shading) {}
+smooth_shading(x.smooth_shading),
+default_texture_coords(x.default_texture_coords),
+default_normal_coords(x.default_normal_coords) {}
 
 void	Model::addVertex(const Vect3& vertex) {
 	vertex_coords.emplace_back(vertex);
@@ -54,6 +58,56 @@ void	Model::addIndex(const Index& index) {
 	indices.emplace_back(index);
 }
 
+/**
+ * @brief Appends the content of a model parsed from the next part
+ * of the same file. Indices are expected to be already resolved.
+*/
+void	Model::append(Model&& fragment) {
+	vertex_coords.insert(
+		vertex_coords.end(),
+		fragment.vertex_coords.begin(),
+		fragment.vertex_coords.end()
+	);
+	texture_coords.insert(
+		texture_coords.end(),
+		fragment.texture_coords.begin(),
+		fragment.texture_coords.end()
+	);
+	normal_coords.insert(
+		normal_coords.end(),
+		fragment.normal_coords.begin(),
+		fragment.normal_coords.end()
+	);
+	indices.insert(
+		indices.end(),
+		fragment.indices.begin(),
+		fragment.indices.end()
+	);
+	triangles.insert(
+		triangles.end(),
+		fragment.triangles.begin(),
+		fragment.triangles.end()
+	);
+	smooth_shading = smooth_shading || fragment.smooth_shading;
+}
+
+/**
+ * @brief Reserves storage for the expected amount of elements.
+*/
+void	Model::reserve(
+	std::size_t nb_vertices,
+	std::size_t nb_textures,
+	std::size_t nb_normals,
+	std::size_t nb_indices,
+	std::size_t nb_triangles
+) {
+	vertex_coords.reserve(nb_vertices);
+	texture_coords.reserve(nb_textures);
+	normal_coords.reserve(nb_normals);
+	indices.reserve(nb_indices);
+	triangles.reserve(nb_triangles);
+}
+
 void	Model::setDefaultTextureCoords() {
 	texture_coords = {
 		{ 0.0f, 0.0f },
@@ -61,6 +115,7 @@ void	Model::setDefaultTextureCoords() {
 		{ 1.0f, 1.0f },
 		{ 0.0f, 1.0f }
 	};
+	default_texture_coords = true;
 
 	std::size_t	i = 0;
 	for (auto& triangle: triangles) {
@@ -76,29 +131,34 @@ void	Model::setDefaultTextureCoords() {
 	}
 }
 
+/**
+ * @brief Generates the missing normals: smoothed over the whole model
+ * if it enables smooth shading, else with hard edges past
+ * SCOP_NORMAL_CREASE_ANGLE.
+*/
 void	Model::setDefaultNormalCoords() {
-	// Reserve as many as the triangles.
-	normal_coords.reserve(triangles.size());
-
-	// Calculate normal coordinates for each triangles.
-	for (Triangle& triangle: triangles) {
-		// Calculate 2 coplanar vectors of the triangle
-		const scop::Vect3	v1 =
-			vertex_coords[triangle.indices[1].vertex] -
-			vertex_coords[triangle.indices[0].vertex];
-		const scop::Vect3	v2 =
-			vertex_coords[triangle.indices[2].vertex] -
-			vertex_coords[triangle.indices[0].vertex];
-
-		// Save the normalized normal coordinates
-		normal_coords.emplace_back(scop::normalize(scop::cross(v1, v2)));
-
-		// Set the normal coordinates for each triangle index
-		for (auto& index: triangle.indices) {
-			index.normal = normal_coords.size() - 1;
-		}
+	default_normal_coords = true;
+	generateSmoothNormals(
+		vertex_coords,
+		triangles,
+		normal_coords,
+		smooth_shading ? 180.0f : SCOP_NORMAL_CREASE_ANGLE
+	);
+}
+
+/**
+ * @brief Welds the positions closer than epsilon (relative to the model
+ * size) and removes the triangles left degenerate or duplicated,
+ * see weldVertices. Generated normals are generated again over the
+ * welded positions.
+*/
+WeldStats	Model::weld(float epsilon) {
+	const WeldStats	stats = weldVertices(vertex_coords, triangles, epsilon);
+
+	if (default_normal_coords && stats.welded_vertices > 0) {
+		setDefaultNormalCoords();
 	}
-	return;
+	return stats;
 }
 
 void	Model::setMaterial(scop::mtl::Material&& mtl) {
@@ -106,8 +166,7 @@ void	Model::setMaterial(scop::mtl::Material&& mtl) {
 	if (material.ambient_texture != nullptr) {
 		return;
 	} else {
-		scop::PpmLoader ppm_loader(SCOP_TEXTURE_FILE_DEFAULT);
-		material.ambient_texture.reset(new scop::Image(ppm_loader.load()));
+		material.ambient_texture = scop::getSharedImage(SCOP_TEXTURE_FILE_DEFAULT);
 	}
 }
 
@@ -129,6 +188,10 @@ const std::vector<Model::Triangle>&	Model::getTriangles() const noexcept {
 	return triangles;
 }
 
+std::vector<Model::Triangle>&	Model::getTriangles() noexcept {
+	return triangles;
+}
+
 const std::vector<Vect3>&	Model::getNormalCoords() const noexcept {
 	return normal_coords;
 }
@@ -145,5 +208,20 @@ mtl::Material&	Model::getMaterial() noexcept {
 	return material;
 }
 
+/**
+ * @brief Whether the texture coordinates were generated,
+ * the file having none.
+*/
+bool	Model::hasDefaultTextureCoords() const noexcept {
+	return default_texture_coords;
+}
+
+/**
+ * @brief Whether the normals were generated, the file having none.
+*/
+bool	Model::hasDefaultNormalCoords() const noexcept {
+	return default_normal_coords;
+}
+
 } // namespace obj
-} // namespace scop
\ No newline at end of file
+} // namespace scop
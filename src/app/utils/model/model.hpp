@@ -28,6 +28,7 @@ struct Vect3;
 struct Vertex;
 
 namespace obj {
+struct WeldStats;
 
 /**
  * Contains .obj file data.
@@ -90,9 +91,18 @@ public:
 	void							addNormal(const Vect3& normal);
 	void							addIndex(const Index& index);
 	void							addTriangle(const Triangle& triangle);
+	void							append(Model&& fragment);
+	void							reserve(
+		std::size_t nb_vertices,
+		std::size_t nb_textures,
+		std::size_t nb_normals,
+		std::size_t nb_indices,
+		std::size_t nb_triangles
+	);
 
 	void							setDefaultTextureCoords();
 	void							setDefaultNormalCoords();
+	WeldStats						weld(float epsilon);
 
 	void							setMaterial(mtl::Material&& material);
 	void							toggleSmoothShading() noexcept;
@@ -102,8 +112,11 @@ public:
 	const std::vector<Vect3>&		getNormalCoords() const noexcept;
 	const std::vector<Index>&		getIndices() const noexcept;
 	const std::vector<Triangle>&	getTriangles() const noexcept;
+	std::vector<Triangle>&			getTriangles() noexcept;
 	const mtl::Material&			getMaterial() const noexcept;
 	mtl::Material&					getMaterial() noexcept;
+	bool							hasDefaultTextureCoords() const noexcept;
+	bool							hasDefaultNormalCoords() const noexcept;
 
 private:
 	/* ========================================================================= */
@@ -117,6 +130,8 @@ private:
 	std::vector<Triangle>			triangles;
 	mtl::Material					material{};
 	bool							smooth_shading = false;
+	bool							default_texture_coords = false;
+	bool							default_normal_coords = false;
 
 }; // class Model
 
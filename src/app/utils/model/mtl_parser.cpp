@@ -12,9 +12,9 @@
 
 #include "mtl_parser.hpp"
 #include "utils.hpp"
-#include "ppm_loader.hpp"
+#include "image_cache.hpp"
+#include "mapped_file.hpp"
 
-#include <fstream> // std::ifstream
 #include <stdexcept> // std::invalid_argument
 #include <algorithm> // std::clamp
 
@@ -27,15 +27,16 @@ namespace mtl {
 
 Material	MtlParser::parseFile(const std::string& file_name) {
 	checkFile(file_name);
-	std::ifstream	file(file_name);
+	utils::MappedFile	file;
 
-	if (!file.is_open()) {
+	if (!file.open(file_name)) {
 		throw std::invalid_argument("Could not open file");
 	}
 
-	for (std::size_t current_line = 1; file.good(); ++current_line) {
-		std::getline(file, line);
+	const std::string_view	content = file.view();
+	std::size_t				cursor = 0;
 
+	for (std::size_t current_line = 1; getLine(content, cursor); ++current_line) {
 		try {
 			processLine();
 		} catch (const base::parse_error& error) {
@@ -46,9 +47,7 @@ Material	MtlParser::parseFile(const std::string& file_name) {
 			);
 		}
 	}
-	if (file.bad()) {
-		throw std::invalid_argument("Error while reading file " + file_name);
-	}
+	material_output.library_path = file_name;
 	return std::move(material_output);
 }
 
@@ -79,7 +78,9 @@ void	MtlParser::processLine() {
 
 	// Check line type.
 	getWord();
-	if (token[0] == '#') {
+	if (token.empty()) {
+		throw base::parse_error("unknown line type");
+	} else if (token[0] == '#') {
 		return;
 	}
 	for (std::size_t i = 0; i < nb_line_size; ++i) {
@@ -90,7 +91,11 @@ void	MtlParser::processLine() {
 			} catch (const std::out_of_range& oor) {
 				throw base::parse_error("value overflow");
 			}
-			if (current_pos != std::string::npos && line[current_pos] != '#') {
+			if (
+				!trusted_input &&
+				current_pos != std::string_view::npos &&
+				line[current_pos] != '#'
+			) {
 				throw base::parse_error("unexpected token");
 			}
 			return;
@@ -160,8 +165,7 @@ void	MtlParser::parseTr() {
 	bool	is_d = token == "d";
 	if (!getWord())
 		throw base::parse_error("expected transparency value");
-	checkNumberType(token);
-	float value = std::stof(token);
+	float value = parseFloat(token);
 	material_output.opacity = is_d ? value : 1.0f - value;
 }
 
@@ -173,9 +177,8 @@ void	MtlParser::parseTr() {
 void	MtlParser::parseNs() {
 	if (!getWord())
 		throw base::parse_error("expected transparency value");
-	checkNumberType(token);
 	material_output.shininess = static_cast<int32_t>(std::clamp(
-		static_cast<int32_t>(std::stof(token)),
+		static_cast<int32_t>(parseFloat(token)),
 		0,
 		1000
 	));
@@ -189,8 +192,7 @@ void	MtlParser::parseNs() {
 void	MtlParser::parseIllum() {
 	if (!getWord())
 		throw base::parse_error("expected transparency value");
-	checkNumberType(token);
-	const std::size_t	illum = static_cast<std::size_t>(std::stof(token));
+	const std::size_t	illum = static_cast<std::size_t>(parseFloat(token));
 	if (illum > 10)
 		throw base::parse_error("no such illumination model");
 	material_output.illum = static_cast<IlluminationModel>(illum);
@@ -209,21 +211,20 @@ void	MtlParser::parseTexture() {
 
 	// Check file format.
 	std::size_t	extension_pos = token.rfind('.');
-	if (extension_pos == std::string::npos) {
+	if (extension_pos == std::string_view::npos) {
 		throw base::parse_error(
 			"no extention found for texture file (must be .ppm)"
 		);
-	} else if (token.find(".ppm", extension_pos) == std::string::npos) {
+	} else if (token.find(".ppm", extension_pos) == std::string_view::npos) {
 		throw base::parse_error(
 			"texture file must be a ppm file (.ppm)"
 		);
 	}
 
-	// Load image.
+	// Load image header, shared with the other materials using it.
 	try {
-		scop::PpmLoader	loader(SCOP_TEXTURE_PATH + token);
-		material_output.ambient_texture.reset(
-			new scop::Image(loader.load())
+		material_output.ambient_texture = scop::getSharedImage(
+			SCOP_TEXTURE_PATH + std::string(token)
 		);
 	} catch (const scop::ImageLoader::FailedToLoadImage& e) {
 		throw base::parse_error(e.what());
@@ -249,8 +250,7 @@ scop::Vect3	MtlParser::parseColors() {
 	for (std::size_t i = 0; i < 3; ++i) {
 		if (!getWord())
 			throw base::parse_error("expected 3 values");
-		checkNumberType(token);
-		rgb[i] = std::stof(token);
+		rgb[i] = parseFloat(token);
 		skipWhitespace();
 	}
 	return rgb;
@@ -46,6 +46,8 @@ public:
 	*/
 	Material			parseFile(const std::string& path);
 
+	using				scop::Parser::setTrustedInput;
+
 private:
 	/* ========================================================================= */
 	/*                                  TYPEDEFS                                 */
@@ -13,13 +13,14 @@
 #include "obj_parser.hpp"
 #include "utils.hpp"	// LOG
 #include "mtl_parser.hpp"
+#include "material_cache.hpp"
 #include "ppm_loader.hpp"
 #include "material.hpp"
+#include "mapped_file.hpp"
 
-#include <fstream>		// std::ifstream
 #include <vector>		// std::vector
-#include <optional>		// std::optional
-#include <algorithm>	// std::count
+#include <algorithm>	// std::max, std::all_of
+#include <thread>		// std::thread
 
 namespace scop {
 namespace obj {
@@ -28,31 +29,33 @@ namespace obj {
 /*                                   PUBLIC                                   */
 /* ========================================================================== */
 
+/**
+ * @brief Parser splitting large files in nb_threads chunks.
+ *
+ * @note - 0 picks the number of hardware threads, for files larger
+ * than SCOP_OBJ_PARALLEL_THRESHOLD only.
+ * @note - 1 always parses on the calling thread.
+*/
+ObjParser::ObjParser(std::size_t nb_threads) noexcept:
+nb_threads(nb_threads) {}
+
 Model	ObjParser::parseFile(const std::string& file_name) {
 	checkFile(file_name);
-	std::ifstream	file;
+	utils::MappedFile	file;
 
-	file.open(file_name);
-	if (!file.is_open()) {
+	if (!file.open(file_name)) {
 		throw std::invalid_argument("Could not open file " + file_name);
 	}
 
-	for (std::size_t current_line = 1; file.good(); ++current_line) {
-		std::getline(file, line);
+	// Tokens are views on the mapped file: no copy until values are stored
+	std::vector<Chunk>	chunks = splitContent(file.view());
 
-		try {
-			processLine();
-		} catch (const base::parse_error& error) {
-			throw std::invalid_argument(
-				"Error while parsing '" + file_name +
-				"' at line " + std::to_string(current_line) + ": " +
-				error.what()
-			);
-		}
-	}
-	if (file.bad()) {
-		throw std::invalid_argument("Error while reading file " + file_name);
+	if (chunks.size() == 1) {
+		parseContent(chunks.front());
+	} else {
+		parseChunks(chunks);
 	}
+	checkChunks(file_name, chunks);
 
 	// Make sure the model is valid
 	fixMissingComponents();
@@ -86,26 +89,72 @@ void	ObjParser::processLine() {
 
 	// Check line type
 	getWord();
-	if (token[0] == '#') {
+	if (token.empty()) {
+		throw base::parse_error("undefined line type");
+	} else if (token[0] == '#') {
 		return;
 	}
-	for (std::size_t i = 0; i < nb_line_types; ++i) {
-		if (token == line_begin[i]) {
-			// Parse the line
-			skipWhitespace();
-			try {
-				(this->*parseLineFun[i])();
-			} catch (const std::out_of_range& oor) {
-				throw base::parse_error("value overflow");
+
+	void	(ObjParser::*parseLineFn)() = nullptr;
+
+	switch (token[0]) {
+		case 'v':
+			if (token.size() == 1) {
+				parseLineFn = &ObjParser::parseVertex;
+			} else if (token.size() == 2 && token[1] == 't') {
+				parseLineFn = &ObjParser::parseTexture;
+			} else if (token.size() == 2 && token[1] == 'n') {
+				parseLineFn = &ObjParser::parseNormal;
 			}
-			// Verify that the line is finished or contains comments
-			if (current_pos != std::string::npos && line[current_pos] != '#') {
-				throw base::parse_error("unexpected token");
+			break;
+		case 'f':
+			if (token.size() == 1) {
+				parseLineFn = &ObjParser::parseFace;
 			}
-			return;
-		}
+			break;
+		case 'm':
+			if (token == "mtllib") {
+				parseLineFn = &ObjParser::parseMtlPath;
+			}
+			break;
+		case 'u':
+			if (token == "usemtl") {
+				parseLineFn = &ObjParser::parseMtlName;
+			}
+			break;
+		case 's':
+			if (token.size() == 1) {
+				parseLineFn = &ObjParser::parseSmoothShading;
+			}
+			break;
+		case 'o':	// TODO
+		case 'g':	// TODO
+			if (token.size() == 1) {
+				parseLineFn = &ObjParser::ignore;
+			}
+			break;
+		default:
+			break;
+	}
+	if (parseLineFn == nullptr) {
+		throw base::parse_error("undefined line type");
+	}
+
+	// Parse the line
+	skipWhitespace();
+	try {
+		(this->*parseLineFn)();
+	} catch (const std::out_of_range& oor) {
+		throw base::parse_error("value overflow");
+	}
+	// Verify that the line is finished or contains comments
+	if (
+		!trusted_input &&
+		current_pos != std::string_view::npos &&
+		line[current_pos] != '#'
+	) {
+		throw base::parse_error("unexpected token");
 	}
-	throw base::parse_error("undefined line type");
 }
 
 /* ========================================================================== */
@@ -122,8 +171,7 @@ void	ObjParser::parseVertex() {
 	for (std::size_t i = 0; i < 3; ++i) {
 		if (!getWord())
 			throw base::parse_error("expecting 3 coordinates");
-		checkNumberType(token);
-		vertex[i] = std::stof(token);
+		vertex[i] = parseFloat(token);
 		skipWhitespace();
 	}
 	model_output.addVertex(vertex);
@@ -141,8 +189,7 @@ void	ObjParser::parseTexture() {
 	for (std::size_t i = 0; i < 2; ++i) {
 		if (!getWord())
 			throw base::parse_error("expecting 2 coordinates");
-		checkNumberType(token);
-		texture[i] = std::stof(token);
+		texture[i] = parseFloat(token);
 		skipWhitespace();
 	}
 	model_output.addTexture(texture);
@@ -160,8 +207,7 @@ void	ObjParser::parseNormal() {
 	for (std::size_t i = 0; i < 3; ++i) {
 		if (!getWord())
 			throw base::parse_error("expecting 3 coordinates");
-		checkNumberType(token);
-		normal[i] = std::stof(token);
+		normal[i] = parseFloat(token);
 		skipWhitespace();
 	}
 	model_output.addNormal(normal);
@@ -177,57 +223,74 @@ void	ObjParser::parseNormal() {
  * Retrives at least one triangle.
 */
 void	ObjParser::parseFace() {
-	std::optional<uint8_t>			format;
-	std::vector<Model::Index>		indices;
+	// Common faces (triangles, quads) stay in the inline buffer
+	Model::Index	inline_indices[nb_inline_indices];
+	std::size_t		nb_indices = 0;
+	uint8_t			format = 0;
 
 	// Parse all indices chunks
 	while (getWord()) {
-		// Verify nb indices
-		size_t	nb_slashes = std::count(token.begin(), token.end(), '/');
-		if (nb_slashes > 2) {
-			throw base::parse_error("expecting at most 3 indices");
+		// Locate the slashes in one pass
+		std::size_t	slashes[2];
+		std::size_t	nb_slashes = 0;
+		for (std::size_t i = 0; i < token.size(); ++i) {
+			if (token[i] != '/') {
+				continue;
+			} else if (nb_slashes == 2) {
+				throw base::parse_error("expecting at most 3 indices");
+			}
+			slashes[nb_slashes++] = i;
 		}
 
 		// If first chunk, determine format
-		if (!format.has_value()) {
-			format = getFormat();
-		} else if (format.value() != getFormat()) {
+		if (format == 0) {
+			format = getFormat(slashes, nb_slashes);
+		} else if (format != getFormat(slashes, nb_slashes)) {
 			throw base::parse_error("inconsistent format");
 		}
 
-		// Extract expected indices from chunk
+		// Extract expected indices from chunk: v[/vt[/vn]]
+		const std::size_t	bounds[4] = {
+			0,
+			nb_slashes > 0 ? slashes[0] + 1 : token.size() + 1,
+			nb_slashes > 1 ? slashes[1] + 1 : token.size() + 1,
+			token.size() + 1
+		};
 		Model::Index	index{};
-		std::size_t	begin_pos = 0;
 		for (std::size_t i = 0; i < 3; ++i) {
-			if (format.value() & (1 << i)) {
-				std::size_t	end_pos = token.find(cs_slash, begin_pos);
-				if (end_pos == std::string::npos) {
-					end_pos = token.size();
-				}
-				std::string	index_str = token.substr(begin_pos, end_pos - begin_pos);
-				if (checkNumberType(index_str) != TOKEN_INT) {
-					throw base::parse_error("expecting integer index");
-				}
-				index[i] = std::stoi(index_str);
-				begin_pos = end_pos + 1;
-			} else if (nb_slashes) {
-				begin_pos += 1;
+			if (format & (1 << i)) {
+				index[i] = parseInt(std::string_view(
+					token.data() + bounds[i],
+					bounds[i + 1] - bounds[i] - 1
+				));
 			}
 		}
 		if (index.vertex == 0) {
 			throw base::parse_error("expecting vertex index");
 		}
 		model_output.addIndex(index);
-		indices.emplace_back(index);
+
+		if (nb_indices < nb_inline_indices) {
+			inline_indices[nb_indices] = index;
+		} else {
+			if (nb_indices == nb_inline_indices) {
+				face_indices.assign(inline_indices, inline_indices + nb_inline_indices);
+			}
+			face_indices.emplace_back(index);
+		}
+		++nb_indices;
 		skipWhitespace();
 	}
 
-	if (indices.size() < 3) {
+	if (nb_indices < 3) {
 		throw base::parse_error("expecting at least 3 vertices");
 	}
 
 	// Store the new triangles
-	storeTriangles(indices);
+	storeTriangles(
+		nb_indices > nb_inline_indices ? face_indices.data() : inline_indices,
+		nb_indices
+	);
 }
 
 /**
@@ -260,61 +323,306 @@ void	ObjParser::parseMtlName() {
 /**
  * @brief Parses smooth shading enable.
  * 
- * @note Format expected: "s <0 | 1 | off | on>"
+ * @note Format expected: "s <group number | off | on>",
+ * any group but 0 enables smooth shading.
 */
 void	ObjParser::parseSmoothShading() {
 	if (!getWord()) {
 		throw base::parse_error("expecting smooth shading value");
 	}
 	// Verify that the smoothing group is valid
-	if (token == "1" || token == "on") {
+	const bool	is_group = std::all_of(token.begin(), token.end(), [](char c) {
+		return c >= '0' && c <= '9';
+	});
+	if (token == "on" || (is_group && token.find_first_not_of('0') != token.npos)) {
 		model_output.toggleSmoothShading();
-	} else if (token != "0" && token != "off") {
-		throw base::parse_error("expecting 0, 1, off or on");
+	} else if (!is_group && token != "off") {
+		throw base::parse_error("expecting a group number, off or on");
 	}
 }
 
 /* ========================================================================== */
 
+/**
+ * @brief Cuts the content in chunks ending on a newline boundary.
+ * The newline itself belongs to no chunk, so every chunk yields
+ * exactly its own lines.
+*/
+std::vector<ObjParser::Chunk>	ObjParser::splitContent(
+	std::string_view content
+) const {
+	std::size_t	nb_chunks = nb_threads;
+
+	if (nb_chunks == 0 && content.size() >= SCOP_OBJ_PARALLEL_THRESHOLD) {
+		nb_chunks = std::thread::hardware_concurrency();
+	}
+	nb_chunks = std::max<std::size_t>(nb_chunks, 1);
+
+	std::vector<Chunk>	chunks;
+	std::size_t			begin_pos = 0;
+
+	chunks.reserve(nb_chunks);
+	for (std::size_t i = 1; i < nb_chunks; ++i) {
+		const std::size_t	target_pos = content.size() / nb_chunks * i;
+		const std::size_t	end_pos = content.find('\n', std::max(begin_pos, target_pos));
+
+		if (end_pos == std::string_view::npos) {
+			break;
+		}
+		chunks.push_back(Chunk{ content.substr(begin_pos, end_pos - begin_pos), 0, nullptr });
+		begin_pos = end_pos + 1;
+	}
+	chunks.push_back(Chunk{ content.substr(begin_pos), 0, nullptr });
+	return chunks;
+}
+
+/**
+ * @brief Parses every line of a chunk into model_output.
+ *
+ * @note Errors are kept in the chunk instead of being thrown,
+ * as the chunk may be parsed by a worker thread.
+*/
+void	ObjParser::parseContent(Chunk& chunk) noexcept {
+	std::size_t	cursor = 0;
+
+	try {
+		reserveStorage(chunk.content);
+		while (getLine(chunk.content, cursor)) {
+			++chunk.nb_lines;
+			processLine();
+		}
+	} catch (...) {
+		chunk.error = std::current_exception();
+	}
+}
+
+/**
+ * @brief Parses the first chunk on the calling thread and the others
+ * on worker threads, each into its own model fragment.
+ * Fragments are merged in file order, so that the result is the same
+ * as a serial parse.
+*/
+void	ObjParser::parseChunks(std::vector<Chunk>& chunks) {
+	std::vector<ObjParser>		workers(chunks.size() - 1);
+	std::vector<std::thread>	threads;
+
+	threads.reserve(workers.size());
+	for (ObjParser& worker: workers) {
+		worker.trusted_input = trusted_input;
+	}
+	try {
+		for (std::size_t i = 0; i < workers.size(); ++i) {
+			threads.emplace_back(
+				&ObjParser::parseContent,
+				&workers[i],
+				std::ref(chunks[i + 1])
+			);
+		}
+	} catch (...) {
+		for (std::thread& thread: threads) {
+			thread.join();
+		}
+		throw;
+	}
+	parseContent(chunks.front());
+	for (std::thread& thread: threads) {
+		thread.join();
+	}
+
+	// No need to merge if checkChunks is going to throw
+	for (const Chunk& chunk: chunks) {
+		if (chunk.error) {
+			return;
+		}
+	}
+	mergeChunks(workers);
+}
+
+/**
+ * @brief Appends the worker fragments to model_output.
+ * Indices resolved from negative face indices are offset by the number
+ * of attributes parsed before their chunk.
+*/
+void	ObjParser::mergeChunks(std::vector<ObjParser>& workers) {
+	std::size_t	nb_vertices = model_output.getVertexCoords().size();
+	std::size_t	nb_textures = model_output.getTextureCoords().size();
+	std::size_t	nb_normals = model_output.getNormalCoords().size();
+	std::size_t	nb_indices = model_output.getIndices().size();
+	std::size_t	nb_triangles = model_output.getTriangles().size();
+
+	for (const ObjParser& worker: workers) {
+		nb_vertices += worker.model_output.getVertexCoords().size();
+		nb_textures += worker.model_output.getTextureCoords().size();
+		nb_normals += worker.model_output.getNormalCoords().size();
+		nb_indices += worker.model_output.getIndices().size();
+		nb_triangles += worker.model_output.getTriangles().size();
+	}
+	model_output.reserve(
+		nb_vertices,
+		nb_textures,
+		nb_normals,
+		nb_indices,
+		nb_triangles
+	);
+
+	for (ObjParser& worker: workers) {
+		const int	offsets[3] = {
+			static_cast<int>(model_output.getVertexCoords().size()),
+			static_cast<int>(model_output.getTextureCoords().size()),
+			static_cast<int>(model_output.getNormalCoords().size())
+		};
+		std::vector<Model::Triangle>&	triangles = worker.model_output.getTriangles();
+
+		for (const RelativeIndex& relative: worker.relative_indices) {
+			triangles[relative.triangle].indices[relative.corner][relative.attribute] +=
+				offsets[relative.attribute];
+		}
+		model_output.append(std::move(worker.model_output));
+
+		// Last material statement wins, as in a serial parse
+		if (!worker.mtl_path.empty()) {
+			mtl_path = std::move(worker.mtl_path);
+		}
+		if (!worker.mtl_name.empty()) {
+			mtl_name = std::move(worker.mtl_name);
+		}
+	}
+}
+
+/**
+ * @brief Rethrows the error of the first failing chunk, with its line
+ * number in the whole file.
+*/
+void	ObjParser::checkChunks(
+	const std::string& file_name,
+	const std::vector<Chunk>& chunks
+) const {
+	std::size_t	current_line = 0;
+
+	for (const Chunk& chunk: chunks) {
+		if (!chunk.error) {
+			current_line += chunk.nb_lines;
+			continue;
+		}
+		try {
+			std::rethrow_exception(chunk.error);
+		} catch (const base::parse_error& error) {
+			throw std::invalid_argument(
+				"Error while parsing '" + file_name +
+				"' at line " + std::to_string(current_line + chunk.nb_lines) +
+				": " + error.what()
+			);
+		}
+	}
+}
+
+/**
+ * @brief Cheap pre-count pass over the whole content, to reserve
+ * the model storage before parsing.
+ *
+ * @note Only looks at the beginning of each line, except for faces
+ * where the vertices are counted to know the number of triangles.
+*/
+void	ObjParser::reserveStorage(std::string_view content) {
+	std::size_t	nb_vertices = 0;
+	std::size_t	nb_textures = 0;
+	std::size_t	nb_normals = 0;
+	std::size_t	nb_indices = 0;
+	std::size_t	nb_triangles = 0;
+
+	for (std::size_t cursor = 0; cursor < content.size();) {
+		std::size_t	end_pos = content.find('\n', cursor);
+		if (end_pos == std::string_view::npos) {
+			end_pos = content.size();
+		}
+		const std::string_view	current = content.substr(cursor, end_pos - cursor);
+		cursor = end_pos + 1;
+
+		if (current.size() < 2) {
+			continue;
+		} else if (current[0] == 'v') {
+			switch (current[1]) {
+				case ' ':
+				case '\t':	++nb_vertices; break;
+				case 't':	++nb_textures; break;
+				case 'n':	++nb_normals; break;
+				default:	break;
+			}
+		} else if (current[0] == 'f' && (current[1] == ' ' || current[1] == '\t')) {
+			// Count the index chunks of the face
+			std::size_t	nb_chunks = 0;
+			bool		in_chunk = false;
+			for (char c: current.substr(1)) {
+				if (c == '#') {
+					break;
+				}
+				const bool	is_space = c == ' ' || c == '\t';
+				nb_chunks += !is_space && !in_chunk;
+				in_chunk = !is_space;
+			}
+			nb_indices += nb_chunks;
+			nb_triangles += nb_chunks > 2 ? nb_chunks - 2 : 0;
+		}
+	}
+	model_output.reserve(
+		nb_vertices,
+		nb_textures,
+		nb_normals,
+		nb_indices,
+		nb_triangles
+	);
+}
+
+/**
+ * @brief Resolves the face indices in place, and stores the face
+ * as a triangle fan.
+*/
 void	ObjParser::storeTriangles(
-	const std::vector<Model::Index>& indices
+	Model::Index* indices,
+	std::size_t nb_indices
 ) {
-	std::size_t	attr_sizes[3] = {
-		model_output.getVertexCoords().size(),
-		model_output.getTextureCoords().size(),
-		model_output.getNormalCoords().size()
+	const int			attr_sizes[3] = {
+		static_cast<int>(model_output.getVertexCoords().size()),
+		static_cast<int>(model_output.getTextureCoords().size()),
+		static_cast<int>(model_output.getNormalCoords().size())
 	};
-	std::size_t	nb_triangles = indices.size() - 2;
+	const std::size_t	first_triangle = model_output.getTriangles().size();
+	const std::size_t	nb_triangles = nb_indices - 2;
 
-	for (std::size_t i = 0; i < nb_triangles; ++i) {
-		// Replace occurence of -1 by last element of corresponding list
-		auto	selectIndex =
-			[indices, attr_sizes](std::size_t pos, std::size_t attr) -> int {
-				if (indices[pos][attr] < 0) {
-					return attr_sizes[attr] - 1;
-				} else {
-					return indices[pos][attr] - 1;
+	// Keep track of the indices that depend on the chunk position (rare)
+	for (std::size_t i = 0; i < nb_indices; ++i) {
+		if ((indices[i].vertex | indices[i].texture | indices[i].normal) >= 0) {
+			continue;
+		}
+		for (uint8_t attr = 0; attr < 3; ++attr) {
+			if (indices[i][attr] >= 0) {
+				continue;
+			}
+			// Corners using the i-th vertex of the fan
+			for (std::size_t t = 0; t < nb_triangles; ++t) {
+				if (i == 0) {
+					relative_indices.push_back({ first_triangle + t, 0, attr });
+				} else if (i == t + 1 || i == t + 2) {
+					relative_indices.push_back({
+						first_triangle + t,
+						static_cast<uint8_t>(i - t),
+						attr
+					});
 				}
-			};
+			}
+		}
+	}
 
-		Model::Triangle	triangle{};
+	// Replace negative index by last element of corresponding list
+	for (std::size_t i = 0; i < nb_indices; ++i) {
+		Model::Index&	index = indices[i];
+		index.vertex = index.vertex < 0 ? attr_sizes[0] - 1 : index.vertex - 1;
+		index.texture = index.texture < 0 ? attr_sizes[1] - 1 : index.texture - 1;
+		index.normal = index.normal < 0 ? attr_sizes[2] - 1 : index.normal - 1;
+	}
 
-		triangle.indices[0] = {
-			.vertex = selectIndex(0, 0),
-			.texture = selectIndex(0, 1),
-			.normal = selectIndex(0, 2)
-		};
-		triangle.indices[1] = {
-			.vertex = selectIndex(i + 1, 0),
-			.texture = selectIndex(i + 1, 1),
-			.normal = selectIndex(i + 1, 2)
-		};
-		triangle.indices[2] = {
-			.vertex = selectIndex(i + 2, 0),
-			.texture = selectIndex(i + 2, 1),
-			.normal = selectIndex(i + 2, 2)
-		};
-		model_output.addTriangle(triangle);
+	for (std::size_t i = 0; i < nb_triangles; ++i) {
+		model_output.addTriangle({{ indices[0], indices[i + 1], indices[i + 2] }});
 	}
 }
 
@@ -326,15 +634,15 @@ void	ObjParser::ignore() noexcept {
 	return skipComment();
 }
 
-uint8_t	ObjParser::getFormat() const noexcept {
-	std::size_t	first_slash = token.find(cs_slash);
-	std::size_t	last_slash = token.rfind(cs_slash);
-
-	if (first_slash == std::string::npos && last_slash == std::string::npos) {
+uint8_t	ObjParser::getFormat(
+	const std::size_t* slashes,
+	std::size_t nb_slashes
+) const noexcept {
+	if (nb_slashes == 0) {
 		return vertex_bit;
-	} else if (first_slash == last_slash) {
+	} else if (nb_slashes == 1) {
 		return vertex_bit | texture_bit;
-	} else if (first_slash == last_slash - 1) {
+	} else if (slashes[0] == slashes[1] - 1) {
 		return vertex_bit | normal_bit;
 	} else {
 		return vertex_bit | texture_bit | normal_bit;
@@ -360,8 +668,10 @@ void	ObjParser::fixMissingComponents() noexcept {
 */
 void	ObjParser::checkMtl() {
 	if (!mtl_path.empty() && !mtl_name.empty()){
-		scop::mtl::MtlParser	mtl_parser;
-		model_output.setMaterial(mtl_parser.parseFile(SCOP_MTL_PATH + mtl_path));
+		// Own copy of the library material, its texture shared
+		model_output.setMaterial(scop::mtl::Material(
+			*scop::mtl::getSharedMaterial(SCOP_MTL_PATH + mtl_path, trusted_input)
+		));
 
 		if (mtl_name != model_output.getMaterial().name) {
 			throw std::invalid_argument("Unknown material: " + mtl_name);
@@ -14,11 +14,19 @@
 
 // Std
 # include <string> // std::string
+# include <string_view> // std::string_view
+# include <vector> // std::vector
+# include <exception> // std::exception_ptr
 
 # include "model.hpp"
 # include "vertex.hpp"
 # include "parser.hpp"
 
+/**
+ * Files smaller than this are always parsed on the calling thread.
+*/
+# define SCOP_OBJ_PARALLEL_THRESHOLD (8 << 20)
+
 namespace scop {
 class Image;
 
@@ -41,6 +49,7 @@ public:
 	/* ========================================================================= */
 
 	ObjParser() = default;
+	explicit ObjParser(std::size_t nb_threads) noexcept;
 	ObjParser(ObjParser&& x) = default;
 	~ObjParser() = default;
 
@@ -51,19 +60,47 @@ public:
 
 	Model			parseFile(const std::string& file_name);
 
+	using			scop::Parser::setTrustedInput;
+
 private:
 	/* ========================================================================= */
 	/*                                  TYPEDEF                                  */
 	/* ========================================================================= */
 
 	typedef		scop::Parser	base;
-	typedef		void (ObjParser::*ParseFunction)();
+
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	/**
+	 * Piece of the file parsed by a worker, cut at a newline boundary.
+	*/
+	struct Chunk {
+		std::string_view			content;
+		std::size_t					nb_lines = 0;
+		std::exception_ptr			error;
+	};
+
+	/**
+	 * Triangle index resolved from a negative (relative) face index.
+	 * It only holds against the attributes of its own chunk,
+	 * and needs to be offset when the chunks are merged.
+	*/
+	struct RelativeIndex {
+		std::size_t					triangle;
+		uint8_t						corner;
+		uint8_t						attribute;
+	};
 
 	/* ======================================================================== */
 	/*                               CLASS MEMBERS                              */
 	/* ======================================================================== */
 
 	Model				model_output;
+	std::vector<RelativeIndex>	relative_indices;
+	std::vector<Model::Index>	face_indices;
+	std::size_t			nb_threads = 0;
 
 	std::string			mtl_path;
 	std::string			mtl_name;
@@ -79,43 +116,26 @@ private:
 	const uint8_t		texture_bit = 1 << 1; // 2
 	const uint8_t		normal_bit = 1 << 2; // 4
 
-	static constexpr
-	const std::size_t	nb_line_types = 10;
-	
 	/**
-	 * List of possible line type in .obj file.
+	 * Face vertices kept on the stack before spilling to face_indices.
 	*/
-	const std::string	line_begin[nb_line_types] = {
-		"#",
-		"v",
-		"vn",
-		"vt",
-		"f",
-		"mtllib",
-		"usemtl",
-		"s",
-		"o",		// TODO
-		"g"			// TODO
-	};
-
-	const ParseFunction		parseLineFun[nb_line_types] = {
-		&ObjParser::ignore,
-		&ObjParser::parseVertex,
-		&ObjParser::parseNormal,
-		&ObjParser::parseTexture,
-		&ObjParser::parseFace,
-		&ObjParser::parseMtlPath,
-		&ObjParser::parseMtlName,
-		&ObjParser::parseSmoothShading,
-		&ObjParser::ignore,
-		&ObjParser::ignore
-	};
+	static constexpr
+	const std::size_t	nb_inline_indices = 4;
 
 	/* ======================================================================== */
 
 	void				checkFile(const std::string& file) const override;
 	void				processLine() override;
 
+	std::vector<Chunk>	splitContent(std::string_view content) const;
+	void				parseContent(Chunk& chunk) noexcept;
+	void				parseChunks(std::vector<Chunk>& chunks);
+	void				mergeChunks(std::vector<ObjParser>& workers);
+	void				checkChunks(
+		const std::string& file_name,
+		const std::vector<Chunk>& chunks
+	) const;
+
 	void				parseVertex();
 	void				parseTexture();
 	void				parseNormal();
@@ -124,9 +144,16 @@ private:
 	void				parseMtlName();
 	void				parseSmoothShading();
 
-	void				storeTriangles(const std::vector<Model::Index>& indices);
+	void				reserveStorage(std::string_view content);
+	void				storeTriangles(
+		Model::Index* indices,
+		std::size_t nb_indices
+	);
 	void				ignore() noexcept;
-	uint8_t				getFormat() const noexcept;
+	uint8_t				getFormat(
+		const std::size_t* slashes,
+		std::size_t nb_slashes
+	) const noexcept;
 	void				fixMissingComponents() noexcept;
 	void				checkMtl();
 
@@ -12,18 +12,46 @@
 
 #include "parser.hpp"
 
+#include <charconv>	// std::from_chars
+#include <cstring>	// std::memcpy
+#include <cstdint>	// uint64_t, int64_t
+#include <cmath>	// std::fabs
+#include <limits>	// std::numeric_limits
+#include <stdexcept>	// std::out_of_range
+
 namespace scop {
 
 /* ========================================================================== */
 /*                                  PROTECTED                                 */
 /* ========================================================================== */
 
+/**
+ * @brief Retrieve the next line of content, starting at cursor.
+ * The line is a view on content, without its trailing '\n'.
+ *
+ * @return false if there is no line left.
+*/
+bool	Parser::getLine(std::string_view content, std::size_t& cursor) noexcept {
+	if (cursor > content.size()) {
+		return false;
+	}
+	std::size_t	end_pos = content.find('\n', cursor);
+	if (end_pos == std::string_view::npos) {
+		end_pos = content.size();
+	}
+	line = content.substr(cursor, end_pos - cursor);
+	cursor = end_pos + 1;
+	return true;
+}
+
 /**
  * @brief Retrieve a word. A word is a sequence of characters that are not
  * whitespace characters.
+ *
+ * @note The token is a view on the current line, no copy is made.
 */
 bool	Parser::getWord() {
-	if (current_pos == std::string::npos) {
+	if (current_pos == std::string_view::npos) {
 		return false;
 	}
 	std::size_t	end_pos = line.find_first_of(cs_whitespaces, current_pos);
@@ -36,7 +64,7 @@ bool	Parser::getWord() {
  * @brief Skip comment. Moves current_pos to the end of the line.
 */
 void	Parser::skipComment() noexcept {
-	current_pos = std::string::npos;
+	current_pos = std::string_view::npos;
 }
 
 /**
@@ -52,7 +80,7 @@ void	Parser::skipWhitespace() noexcept {
  * 
  * @param word The value to check.
 */
-TokenType	Parser::checkNumberType(const std::string& word) const {
+TokenType	Parser::checkNumberType(std::string_view word) const {
 	if (word.empty()) {
 		throw Parser::parse_error("expecting number");
 	}
@@ -60,7 +88,7 @@ TokenType	Parser::checkNumberType(const std::string& word) const {
 	std::size_t	pos_checked = word.find(cs_negate);
 
 	// Check if first negate
-	if (pos_checked != std::string::npos && pos_checked != 0) {
+	if (pos_checked != std::string_view::npos && pos_checked != 0) {
 		throw Parser::parse_error("unexpected '-' character");
 	} else if (pos_checked == 0) {
 		pos_checked += 1;
@@ -70,13 +98,13 @@ TokenType	Parser::checkNumberType(const std::string& word) const {
 
 	// Check if there are only digits
 	pos_checked = word.find_first_of(cs_digit, pos_checked);
-	if (pos_checked == std::string::npos) {
+	if (pos_checked == std::string_view::npos) {
 		throw Parser::parse_error("expecting digits after '-'");
 	}
 
 	// Check if there's a dot after digits
 	std::size_t	dot_pos = word.find(cs_dot, pos_checked);
-	if (dot_pos == std::string::npos) {
+	if (dot_pos == std::string_view::npos) {
 		checkJunkAfterNumber(word, pos_checked);
 		return TokenType::TOKEN_INT;
 	}
@@ -88,12 +116,164 @@ TokenType	Parser::checkNumberType(const std::string& word) const {
  * @brief Check if there are junk characters after a number.
 */
 void	Parser::checkJunkAfterNumber(
-	const std::string& word,
+	std::string_view word,
 	std::size_t pos
 ) const {
-	if (word.find_first_not_of(cs_digit, pos) != std::string::npos) {
+	if (word.find_first_not_of(cs_digit, pos) != std::string_view::npos) {
 		throw Parser::parse_error("unexpected character after value");
 	}
 }
 
+/**
+ * @brief Validates and converts a word to a float, in a single pass.
+ *
+ * @note - Accepted format: "[+-]digits[.digits]", as checkNumberType.
+ * @note - Does not depend on the locale. Short decimals are converted
+ * exactly with one floating point operation, others go through
+ * std::from_chars.
+ * @note - In trusted input mode, the conversion stops at the first
+ * unexpected character instead of throwing.
+ *
+ * @throw std::out_of_range if the value overflows.
+*/
+float	Parser::parseFloat(std::string_view word) const {
+	const char*	it = word.data();
+	const char*	end = it + word.size();
+	bool		negative = false;
+
+	if (it != end && (*it == '-' || *it == '+')) {
+		negative = *it == '-';
+		++it;
+	}
+
+	// Accumulate up to 19 significant digits, tracking the decimal exponent
+	const char*	digits_begin = it;
+	uint64_t	mantissa = 0;
+	int			exponent = 0;
+	std::size_t	nb_digits = 0;
+	bool		has_digits = false;
+	bool		truncated = false;
+	bool		after_dot = false;
+
+	for (; it != end; ++it) {
+		if (*it == '.' && !after_dot) {
+			after_dot = true;
+			continue;
+		} else if (*it < '0' || *it > '9') {
+			break;
+		}
+		has_digits = true;
+		if (mantissa == 0 && *it == '0') {
+			exponent -= after_dot;
+		} else if (nb_digits < 19) {
+			mantissa = mantissa * 10 + (*it - '0');
+			exponent -= after_dot;
+			++nb_digits;
+		} else {
+			truncated = true;
+			exponent += !after_dot;
+		}
+	}
+	if (!trusted_input && (it != end || !has_digits)) {
+		throwNumberError(word, TOKEN_FLOAT);
+	}
+
+	// Fast path: mantissa and power of ten are exact doubles,
+	// so the division/multiplication is correctly rounded
+	if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+		static constexpr double	powers_of_ten[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		const double	value = exponent < 0 ?
+			static_cast<double>(mantissa) / powers_of_ten[-exponent] :
+			static_cast<double>(mantissa) * powers_of_ten[exponent];
+
+		// Rounding to float again is only ambiguous on an exact midpoint
+		uint64_t	bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		if ((bits & 0x1FFFFFFF) != 0x10000000) {
+			const float	result = static_cast<float>(value);
+			return negative ? -result : result;
+		}
+	}
+
+	// Exact fallback
+	float	result = 0.0f;
+	if (std::from_chars(digits_begin, it, result).ec == std::errc::result_out_of_range ||
+		(result != 0.0f && std::fabs(result) < std::numeric_limits<float>::min())
+	) {
+		throw std::out_of_range("value overflow");
+	}
+	return negative ? -result : result;
+}
+
+/**
+ * @brief Validates and converts a word to an int, in a single pass.
+ *
+ * @note In trusted input mode, the conversion stops at the first
+ * unexpected character instead of throwing.
+ *
+ * @throw std::out_of_range if the value overflows.
+*/
+int	Parser::parseInt(std::string_view word) const {
+	const char*	it = word.data();
+	const char*	end = it + word.size();
+	bool		negative = false;
+
+	if (it != end && (*it == '-' || *it == '+')) {
+		negative = *it == '-';
+		++it;
+	}
+
+	const char*		digits_begin = it;
+	const int64_t	limit = static_cast<int64_t>(
+		std::numeric_limits<int>::max()
+	) + negative;
+	int64_t			value = 0;
+	bool			overflow = false;
+
+	for (; it != end && *it >= '0' && *it <= '9'; ++it) {
+		if (!overflow) {
+			value = value * 10 + (*it - '0');
+			overflow = value > limit;
+		}
+	}
+	if (!trusted_input && (it != end || it == digits_begin)) {
+		throwNumberError(word, TOKEN_INT);
+	} else if (overflow) {
+		throw std::out_of_range("value overflow");
+	}
+	return static_cast<int>(negative ? -value : value);
+}
+
+/**
+ * @brief Trusted input skips most of the format checks,
+ * for files known to be well formed.
+*/
+void	Parser::setTrustedInput(bool trusted) noexcept {
+	trusted_input = trusted;
+}
+
+/* ========================================================================== */
+/*                                   PRIVATE                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Throws the error matching a word rejected by parseFloat
+ * or parseInt, the same way checkNumberType does.
+*/
+void	Parser::throwNumberError(
+	std::string_view word,
+	TokenType expected
+) const {
+	checkNumberType(word);
+
+	// Float instead of an index, or junk checkNumberType lets through
+	if (expected == TOKEN_INT) {
+		throw Parser::parse_error("expecting integer index");
+	}
+	throw Parser::parse_error("unexpected character after value");
+}
+
 } // namespace scop
\ No newline at end of file
@@ -13,6 +13,7 @@
 #pragma once
 
 # include <string>
+# include <string_view>
 
 namespace scop {
 
@@ -68,8 +69,9 @@ protected:
 	/* ========================================================================= */
 
 	std::size_t				current_pos;
-	std::string			line;
-	std::string			token;
+	std::string_view		line;
+	std::string_view		token;
+	bool					trusted_input = false;
 
 	/* ========================================================================= */
 	/*                                  METHODS                                  */
@@ -87,14 +89,30 @@ protected:
 	virtual void		checkFile(const std::string& file) const = 0;
 	virtual void		processLine() = 0;
 
+	bool				getLine(
+		std::string_view content,
+		std::size_t& cursor
+	) noexcept;
 	bool				getWord();
 	void				skipComment() noexcept;
 	void				skipWhitespace() noexcept;
-	TokenType			checkNumberType(const std::string& word) const;
+	TokenType			checkNumberType(std::string_view word) const;
 	void				checkJunkAfterNumber(
-		const std::string& word,
+		std::string_view word,
 		std::size_t pos
 	) const;
+	float				parseFloat(std::string_view word) const;
+	int					parseInt(std::string_view word) const;
+	void				setTrustedInput(bool trusted) noexcept;
+
+private:
+	/* ========================================================================= */
+
+	[[noreturn]]
+	void				throwNumberError(
+		std::string_view word,
+		TokenType expected
+	) const;
 
 }; // class Parser
 
@@ -0,0 +1,279 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   smooth_normals.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 14:31:45 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 14:31:45 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "smooth_normals.hpp"
+#include "vector.hpp"
+#include "simd.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>	// std::min, std::sort
+#include <cmath>		// std::cos
+#include <utility>		// std::pair
+
+namespace scop {
+namespace obj {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Unit normal and corner angles of the triangles in [begin, end),
+ * four at a time.
+ *
+ * @note Degenerate triangles get a null normal, and so no weight.
+*/
+static void	computeFaces(
+	const std::vector<scop::Vect3>& positions,
+	const std::vector<Model::Triangle>& triangles,
+	std::size_t begin,
+	std::size_t end,
+	std::vector<scop::Vect3>& face_normals,
+	std::vector<float>& corner_angles
+) {
+	using namespace scop::simd;
+
+	for (std::size_t first = begin; first < end; first += 4) {
+		// Gather 4 triangles (the last one repeated past the end)
+		float	corners[3][3][4];
+		for (std::size_t lane = 0; lane < 4; ++lane) {
+			const Model::Triangle&	triangle = triangles[std::min(first + lane, end - 1)];
+			for (std::size_t corner = 0; corner < 3; ++corner) {
+				const scop::Vect3&	pos = positions[triangle.indices[corner].vertex];
+				corners[corner][0][lane] = pos.x;
+				corners[corner][1][lane] = pos.y;
+				corners[corner][2][lane] = pos.z;
+			}
+		}
+
+		Vect3x4	p[3];
+		for (std::size_t corner = 0; corner < 3; ++corner) {
+			p[corner] = Vect3x4{
+				load(corners[corner][0]),
+				load(corners[corner][1]),
+				load(corners[corner][2])
+			};
+		}
+
+		Float4			length;
+		const Vect3x4	normal = normalize(cross(p[1] - p[0], p[2] - p[0]), length);
+		const Vect3x4	u01 = normalize(p[1] - p[0], length);
+		const Vect3x4	u02 = normalize(p[2] - p[0], length);
+		const Vect3x4	u12 = normalize(p[2] - p[1], length);
+		const Float4	angles[3] = {
+			acos(dot(u01, u02)),
+			acos(splat(0.0f) - dot(u01, u12)),
+			acos(dot(u02, u12))
+		};
+
+		float	out_normal[3][4];
+		float	out_angles[3][4];
+		store(out_normal[0], normal.x);
+		store(out_normal[1], normal.y);
+		store(out_normal[2], normal.z);
+		for (std::size_t corner = 0; corner < 3; ++corner) {
+			store(out_angles[corner], angles[corner]);
+		}
+		for (std::size_t lane = 0; lane < 4 && first + lane < end; ++lane) {
+			face_normals[first + lane] = scop::Vect3(
+				out_normal[0][lane],
+				out_normal[1][lane],
+				out_normal[2][lane]
+			);
+			for (std::size_t corner = 0; corner < 3; ++corner) {
+				corner_angles[(first + lane) * 3 + corner] = out_angles[corner][lane];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Root of the cluster of i, halving the path on the way.
+*/
+static uint32_t	findCluster(std::vector<uint32_t>& parents, uint32_t i) noexcept {
+	while (parents[i] != i) {
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+	return i;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Generates the vertex normals of the model, as the average of the
+ * normals of the faces around each vertex, weighted by their angle there.
+ * Normals are shared by the corners of the same cluster of faces.
+ *
+ * @param normals Filled with the generated normals.
+ * @param crease_angle Faces sharing an edge and more than this angle
+ * (degrees) apart are not averaged together, keeping a hard edge.
+ * 180 to smooth everything.
+ * @param nb_threads 0 picks the number of hardware threads for large
+ * meshes, 1 generates on the calling thread.
+ *
+ * @note The result does not depend on the number of threads.
+*/
+void	generateSmoothNormals(
+	const std::vector<scop::Vect3>& positions,
+	std::vector<Model::Triangle>& triangles,
+	std::vector<scop::Vect3>& normals,
+	float crease_angle,
+	std::size_t nb_threads
+) {
+	const std::size_t	nb_triangles = triangles.size();
+	const std::size_t	nb_vertices = positions.size();
+	const float			min_cos = std::cos(crease_angle * static_cast<float>(M_PI) / 180.0f);
+	const bool			smooth_all = crease_angle >= 180.0f;
+
+	nb_threads = scop::parallel::threadCount(
+		nb_triangles,
+		SCOP_NORMALS_PARALLEL_THRESHOLD,
+		nb_threads
+	);
+
+	// Face normals and corner weights
+	std::vector<scop::Vect3>	face_normals(nb_triangles);
+	std::vector<float>			corner_angles(nb_triangles * 3);
+	scop::parallel::runRanges(
+		(nb_triangles + 3) / 4,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			computeFaces(
+				positions,
+				triangles,
+				begin * 4,
+				std::min(end * 4, nb_triangles),
+				face_normals,
+				corner_angles
+			);
+		}
+	);
+
+	// Corners around each vertex, in triangle order
+	std::vector<uint32_t>	corner_offsets(nb_vertices + 1, 0);
+	std::vector<uint32_t>	corners(nb_triangles * 3);
+	for (const Model::Triangle& triangle: triangles) {
+		for (const Model::Index& index: triangle.indices) {
+			++corner_offsets[index.vertex + 1];
+		}
+	}
+	for (std::size_t v = 0; v < nb_vertices; ++v) {
+		corner_offsets[v + 1] += corner_offsets[v];
+	}
+	{
+		std::vector<uint32_t>	fill(corner_offsets.begin(), corner_offsets.end() - 1);
+		for (std::size_t corner = 0; corner < corners.size(); ++corner) {
+			const int	vertex = triangles[corner / 3].indices[corner % 3].vertex;
+			corners[fill[vertex]++] = static_cast<uint32_t>(corner);
+		}
+	}
+
+	// Faces around each vertex clustered across the edges they share there,
+	// when within the crease angle: one normal per cluster
+	std::vector<scop::Vect3>	corner_normals(corners.size());
+	std::vector<uint32_t>		local_ids(corners.size());
+	std::vector<uint32_t>		normal_offsets(nb_vertices + 1, 0);
+	scop::parallel::runRanges(
+		nb_vertices,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			std::vector<std::pair<int, uint32_t>>	edges;
+			std::vector<uint32_t>					parents;
+			std::vector<scop::Vect3>				sums;
+			std::vector<uint32_t>					cluster_ids;
+
+			for (std::size_t v = begin; v < end; ++v) {
+				const uint32_t	first = corner_offsets[v];
+				const uint32_t	nb_corners = corner_offsets[v + 1] - first;
+				uint32_t		nb_normals = 0;
+
+				parents.resize(nb_corners);
+				for (uint32_t i = 0; i < nb_corners; ++i) {
+					parents[i] = smooth_all ? 0 : i;
+				}
+
+				if (!smooth_all) {
+					// Other end of both edges of each face at the vertex
+					edges.clear();
+					for (uint32_t i = 0; i < nb_corners; ++i) {
+						const uint32_t			corner = corners[first + i];
+						const Model::Triangle&	triangle = triangles[corner / 3];
+						edges.emplace_back(triangle.indices[(corner + 1) % 3].vertex, i);
+						edges.emplace_back(triangle.indices[(corner + 2) % 3].vertex, i);
+					}
+					std::sort(edges.begin(), edges.end());
+					for (std::size_t e = 1; e < edges.size(); ++e) {
+						if (edges[e].first != edges[e - 1].first) {
+							continue;
+						}
+						const uint32_t	a = edges[e - 1].second;
+						const uint32_t	b = edges[e].second;
+						if (scop::dot(
+							face_normals[corners[first + a] / 3],
+							face_normals[corners[first + b] / 3]
+						) >= min_cos) {
+							parents[findCluster(parents, a)] = findCluster(parents, b);
+						}
+					}
+				}
+
+				// Angle weighted sums, numbered in corner order
+				sums.assign(nb_corners, scop::Vect3(0.0f, 0.0f, 0.0f));
+				cluster_ids.assign(nb_corners, nb_corners);
+				for (uint32_t i = 0; i < nb_corners; ++i) {
+					const uint32_t	corner = corners[first + i];
+					const uint32_t	root = findCluster(parents, i);
+					sums[root] += face_normals[corner / 3] * corner_angles[corner];
+					if (cluster_ids[root] == nb_corners) {
+						cluster_ids[root] = nb_normals++;
+					}
+				}
+				for (uint32_t i = 0; i < nb_corners; ++i) {
+					const uint32_t		root = findCluster(parents, i);
+					const scop::Vect3&	sum = sums[root];
+					const float			length = scop::norm(sum);
+
+					corner_normals[first + i] = length > 0.0f ?
+						sum / length :
+						scop::Vect3(0.0f, 0.0f, 1.0f);
+					local_ids[first + i] = cluster_ids[root];
+				}
+				normal_offsets[v + 1] = nb_normals;
+			}
+		}
+	);
+	for (std::size_t v = 0; v < nb_vertices; ++v) {
+		normal_offsets[v + 1] += normal_offsets[v];
+	}
+
+	// Each vertex owns its range of normals
+	normals.resize(normal_offsets.back());
+	scop::parallel::runRanges(
+		nb_vertices,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			for (std::size_t v = begin; v < end; ++v) {
+				for (uint32_t k = corner_offsets[v]; k < corner_offsets[v + 1]; ++k) {
+					const uint32_t	id = normal_offsets[v] + local_ids[k];
+					normals[id] = corner_normals[k];
+					triangles[corners[k] / 3].indices[corners[k] % 3].normal = id;
+				}
+			}
+		}
+	);
+}
+
+} // namespace obj
+} // namespace scop
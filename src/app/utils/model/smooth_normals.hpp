@@ -0,0 +1,44 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   smooth_normals.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 14:31:45 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 14:31:45 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+
+# include "model.hpp"
+
+/**
+ * Angle (degrees) above which adjacent faces keep a hard edge,
+ * when the model doesn't ask for smooth shading.
+*/
+# define SCOP_NORMAL_CREASE_ANGLE			60.0f
+
+/**
+ * Meshes with more triangles than this get their normals generated
+ * on several threads, unless a thread count is given.
+*/
+# define SCOP_NORMALS_PARALLEL_THRESHOLD	(1 << 16)
+
+namespace scop {
+namespace obj {
+
+void	generateSmoothNormals(
+	const std::vector<scop::Vect3>& positions,
+	std::vector<Model::Triangle>& triangles,
+	std::vector<scop::Vect3>& normals,
+	float crease_angle,
+	std::size_t nb_threads = 0
+);
+
+} // namespace obj
+} // namespace scop
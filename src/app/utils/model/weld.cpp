@@ -0,0 +1,285 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   weld.cpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:12:08 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:12:08 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "weld.hpp"
+#include "vector.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>	// std::min, std::max, std::sort
+#include <array>		// std::array
+#include <cmath>		// std::floor
+#include <cstdint>		// int64_t, uint32_t
+
+namespace scop {
+namespace obj {
+
+/* ========================================================================== */
+/*                                   HELPERS                                  */
+/* ========================================================================== */
+
+/**
+ * Uniform grid over the model bounding box, hashed into buckets
+ * of position ids (ascending in each bucket).
+*/
+struct Grid {
+	scop::Vect3				origin;
+	float					inv_cell_size;
+	std::size_t				mask;
+	std::vector<uint32_t>	offsets;
+	std::vector<uint32_t>	ids;
+
+	std::array<int64_t, 3>	cellOf(const scop::Vect3& pos) const noexcept {
+		return {
+			static_cast<int64_t>(std::floor((pos.x - origin.x) * inv_cell_size)),
+			static_cast<int64_t>(std::floor((pos.y - origin.y) * inv_cell_size)),
+			static_cast<int64_t>(std::floor((pos.z - origin.z) * inv_cell_size))
+		};
+	}
+
+	std::size_t				bucketOf(int64_t x, int64_t y, int64_t z) const noexcept {
+		const uint64_t	hash =
+			static_cast<uint64_t>(x) * 73856093u ^
+			static_cast<uint64_t>(y) * 19349663u ^
+			static_cast<uint64_t>(z) * 83492791u;
+		return static_cast<std::size_t>(hash ^ (hash >> 29)) & mask;
+	}
+};
+
+/**
+ * @brief Buckets the positions into a grid of cells of the given size.
+*/
+static void	buildGrid(
+	const std::vector<scop::Vect3>& positions,
+	const scop::Vect3& origin,
+	float cell_size,
+	std::size_t nb_threads,
+	Grid& grid
+) {
+	const std::size_t	nb_positions = positions.size();
+	std::size_t			nb_buckets = 1;
+	while (nb_buckets < nb_positions * 2) {
+		nb_buckets <<= 1;
+	}
+	grid.origin = origin;
+	grid.inv_cell_size = 1.0f / cell_size;
+	grid.mask = nb_buckets - 1;
+
+	std::vector<uint32_t>	buckets(nb_positions);
+	scop::parallel::runRanges(
+		nb_positions,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i) {
+				const auto	cell = grid.cellOf(positions[i]);
+				buckets[i] = static_cast<uint32_t>(grid.bucketOf(cell[0], cell[1], cell[2]));
+			}
+		}
+	);
+
+	// Counting sort, keeping the ids ascending in each bucket
+	grid.offsets.assign(nb_buckets + 1, 0);
+	for (uint32_t bucket: buckets) {
+		++grid.offsets[bucket + 1];
+	}
+	for (std::size_t b = 0; b < nb_buckets; ++b) {
+		grid.offsets[b + 1] += grid.offsets[b];
+	}
+	std::vector<uint32_t>	fill(grid.offsets.begin(), grid.offsets.end() - 1);
+	grid.ids.resize(nb_positions);
+	for (std::size_t i = 0; i < nb_positions; ++i) {
+		grid.ids[fill[buckets[i]]++] = static_cast<uint32_t>(i);
+	}
+}
+
+/**
+ * @brief Drops the triangles with twice the same position, then the copies
+ * of a previous triangle (same positions, same winding).
+ *
+ * @return The number of triangles removed.
+*/
+static std::size_t	removeDegenerateTriangles(
+	std::vector<Model::Triangle>& triangles
+) {
+	const std::size_t					nb_triangles = triangles.size();
+	std::vector<std::array<int, 3>>		keys(nb_triangles);
+	std::vector<uint32_t>				order;
+	std::vector<bool>					removed(nb_triangles, false);
+
+	order.reserve(nb_triangles);
+	for (std::size_t t = 0; t < nb_triangles; ++t) {
+		const auto&	indices = triangles[t].indices;
+		const int	a = indices[0].vertex;
+		const int	b = indices[1].vertex;
+		const int	c = indices[2].vertex;
+
+		if (a == b || b == c || a == c) {
+			removed[t] = true;
+			continue;
+		}
+		// Rotate the smallest id first, keeping the winding
+		if (a < b && a < c) {
+			keys[t] = { a, b, c };
+		} else if (b < c) {
+			keys[t] = { b, c, a };
+		} else {
+			keys[t] = { c, a, b };
+		}
+		order.push_back(static_cast<uint32_t>(t));
+	}
+
+	// Copies end up next to each other, the first one ahead
+	std::sort(order.begin(), order.end(), [&keys](uint32_t lhs, uint32_t rhs) {
+		return keys[lhs] != keys[rhs] ? keys[lhs] < keys[rhs] : lhs < rhs;
+	});
+	for (std::size_t i = 1; i < order.size(); ++i) {
+		if (keys[order[i]] == keys[order[i - 1]]) {
+			removed[order[i]] = true;
+		}
+	}
+
+	std::size_t	kept = 0;
+	for (std::size_t t = 0; t < nb_triangles; ++t) {
+		if (!removed[t]) {
+			triangles[kept++] = triangles[t];
+		}
+	}
+	triangles.resize(kept);
+	return nb_triangles - kept;
+}
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Merges the positions closer than epsilon, the triangles pointing
+ * to the first position of each group, then removes the triangles
+ * left degenerate or duplicated.
+ *
+ * Positions are bucketed in a uniform grid, hashed, so that each one
+ * is only compared to its cell and the neighbor ones within epsilon.
+ * Each position is welded to the first one within epsilon, groups
+ * following chains of close positions.
+ *
+ * @param positions Left as is, welded ones just stop being referenced.
+ * @param epsilon Largest distance merged, relative to the diagonal
+ * of the bounding box of the positions.
+ * @param nb_threads 0 picks the number of hardware threads for large
+ * models, 1 welds on the calling thread.
+ *
+ * @note The result does not depend on the number of threads.
+*/
+WeldStats	weldVertices(
+	const std::vector<scop::Vect3>& positions,
+	std::vector<Model::Triangle>& triangles,
+	float epsilon,
+	std::size_t nb_threads
+) {
+	const std::size_t	nb_positions = positions.size();
+	WeldStats			stats{ 0, 0 };
+
+	if (nb_positions == 0) {
+		stats.removed_triangles = removeDegenerateTriangles(triangles);
+		return stats;
+	}
+	nb_threads = scop::parallel::threadCount(
+		nb_positions,
+		SCOP_WELD_PARALLEL_THRESHOLD,
+		nb_threads
+	);
+
+	scop::Vect3	min = positions[0];
+	scop::Vect3	max = positions[0];
+	for (const scop::Vect3& pos: positions) {
+		min = scop::Vect3(std::min(min.x, pos.x), std::min(min.y, pos.y), std::min(min.z, pos.z));
+		max = scop::Vect3(std::max(max.x, pos.x), std::max(max.y, pos.y), std::max(max.z, pos.z));
+	}
+
+	// Cells a few times epsilon wide, so that most positions are far enough
+	// from the sides to skip the neighbor cells, and no smaller than
+	// the float precision over the model
+	const float	diagonal = scop::norm(max - min);
+	const float	distance = std::max(epsilon, 0.0f) * diagonal;
+	const float	max_distance2 = distance * distance;
+	float		cell_size = std::max(distance * SCOP_WELD_CELL_SCALE, diagonal * 1e-6f);
+	if (cell_size <= 0.0f) {
+		cell_size = 1.0f;
+	}
+	// Epsilon in cells, with some room for rounding
+	const float	reach = distance / cell_size + 1e-3f;
+
+	Grid	grid;
+	buildGrid(positions, min, cell_size, nb_threads, grid);
+
+	// First position within epsilon of each one, itself if none
+	std::vector<uint32_t>	parents(nb_positions);
+	scop::parallel::runRanges(
+		nb_positions,
+		nb_threads,
+		[&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i) {
+				const scop::Vect3&	pos = positions[i];
+				const auto			cell = grid.cellOf(pos);
+				uint32_t			parent = static_cast<uint32_t>(i);
+
+				// Neighbor cells along each axis, when close enough to the side
+				int64_t	first[3];
+				int64_t	last[3];
+				for (std::size_t axis = 0; axis < 3; ++axis) {
+					const float	offset = (pos[axis] - grid.origin[axis]) * grid.inv_cell_size -
+						static_cast<float>(cell[axis]);
+					first[axis] = cell[axis] - (offset < reach);
+					last[axis] = cell[axis] + (1.0f - offset < reach);
+				}
+
+				for (int64_t z = first[2]; z <= last[2]; ++z) {
+					for (int64_t y = first[1]; y <= last[1]; ++y) {
+						for (int64_t x = first[0]; x <= last[0]; ++x) {
+							const std::size_t	bucket = grid.bucketOf(x, y, z);
+							for (uint32_t k = grid.offsets[bucket]; k < grid.offsets[bucket + 1]; ++k) {
+								const uint32_t	j = grid.ids[k];
+								if (j >= parent) {
+									break;
+								}
+								const scop::Vect3	diff = positions[j] - pos;
+								if (scop::dot(diff, diff) <= max_distance2) {
+									parent = j;
+									break;
+								}
+							}
+						}
+					}
+				}
+				parents[i] = parent;
+			}
+		}
+	);
+
+	// Parents come first, so their group is already known
+	for (std::size_t i = 0; i < nb_positions; ++i) {
+		if (parents[i] != i) {
+			parents[i] = parents[parents[i]];
+			++stats.welded_vertices;
+		}
+	}
+	for (Model::Triangle& triangle: triangles) {
+		for (Model::Index& index: triangle.indices) {
+			index.vertex = static_cast<int>(parents[index.vertex]);
+		}
+	}
+
+	stats.removed_triangles = removeDegenerateTriangles(triangles);
+	return stats;
+}
+
+} // namespace obj
+} // namespace scop
@@ -0,0 +1,60 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   weld.hpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:12:08 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:12:08 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <vector> // std::vector
+# include <cstddef> // std::size_t
+
+# include "model.hpp"
+
+/**
+ * Largest distance between welded positions, relative to the diagonal
+ * of the model bounding box. 0 only welds identical positions,
+ * negative disables welding.
+*/
+# ifndef SCOP_WELD_EPSILON
+#  define SCOP_WELD_EPSILON			-1.0f
+# endif
+
+/**
+ * Size of the grid cells used to find close positions, relative to epsilon.
+*/
+# define SCOP_WELD_CELL_SCALE			4.0f
+
+/**
+ * Models with more positions than this get welded on several threads,
+ * unless a thread count is given.
+*/
+# define SCOP_WELD_PARALLEL_THRESHOLD	(1 << 16)
+
+namespace scop {
+namespace obj {
+
+/**
+ * What a welding pass removed.
+*/
+struct WeldStats {
+	std::size_t	welded_vertices;
+	std::size_t	removed_triangles;
+};
+
+WeldStats	weldVertices(
+	const std::vector<scop::Vect3>& positions,
+	std::vector<Model::Triangle>& triangles,
+	float epsilon,
+	std::size_t nb_threads = 0
+);
+
+} // namespace obj
+} // namespace scop
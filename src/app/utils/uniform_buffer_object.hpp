@@ -14,6 +14,7 @@
 
 # define __ALIGNMENT_MAT4 16
 # define __ALIGNMENT_VEC3 16
+# define __ALIGNMENT_VEC2 8
 # define __ALIGNMENT_SCAL 4
 # define __ALIGNMENT_BUFF 64
 
@@ -31,6 +32,12 @@ public:
 		alignas(__ALIGNMENT_MAT4) scop::Mat4	model;
 		alignas(__ALIGNMENT_MAT4) scop::Mat4	view;
 		alignas(__ALIGNMENT_MAT4) scop::Mat4	proj;
+
+		// Dequantization of the compact vertex attributes
+		alignas(__ALIGNMENT_VEC3) scop::Vect3	pos_offset;
+		alignas(__ALIGNMENT_VEC3) scop::Vect3	pos_scale;
+		alignas(__ALIGNMENT_VEC2) scop::Vect2	uv_offset;
+		alignas(__ALIGNMENT_VEC2) scop::Vect2	uv_scale;
 	};
 
 	struct Texture {
@@ -17,9 +17,29 @@
 
 // Std
 # include <array>
+# include <cstddef> // offsetof
+# include <cstdint> // uint16_t, int16_t
+# include <cstring> // std::memcpy
+# include <type_traits> // std::conditional_t
 
 # include "vector.hpp"
 
+/**
+ * Vertex layout uploaded to the gpu: 1 for CompactVertex, 0 for Vertex.
+ * Must match the define the vertex shader is compiled with.
+*/
+# ifndef SCOP_COMPACT_VERTEX
+#  define SCOP_COMPACT_VERTEX 1
+# endif
+
+/**
+ * Vertex buffer streams: 1 for positions alone in binding 0 and the other
+ * attributes in binding 1, 0 for interleaved vertices in binding 0.
+*/
+# ifndef SCOP_SPLIT_VERTEX
+#  define SCOP_SPLIT_VERTEX 0
+# endif
+
 namespace scop {
 
 struct Vertex {
@@ -28,7 +48,6 @@ struct Vertex {
 	/* ========================================================================= */
 
 	scop::Vect3		pos;
-	scop::Vect3		color;
 	scop::Vect2		tex_coord;
 	scop::Vect3		normal;
 
@@ -60,8 +79,8 @@ struct Vertex {
 	/**
 	 * Expliciting to vulkan the vertex struct format.
 	*/
-	static std::array<VkVertexInputAttributeDescription, 4>	getAttributeDescriptions() {
-		std::array<VkVertexInputAttributeDescription, 4>	attribute_descriptions{};
+	static std::array<VkVertexInputAttributeDescription, 3>	getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 3>	attribute_descriptions{};
 
 		// `pos` attribute
 		attribute_descriptions[0].binding = 0;
@@ -69,23 +88,17 @@ struct Vertex {
 		attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
 		attribute_descriptions[0].offset = offsetof(Vertex, pos);
 
-		// `color` attribute
+		// `tex_coord` attribute
 		attribute_descriptions[1].binding = 0;
 		attribute_descriptions[1].location = 1;
-		attribute_descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attribute_descriptions[1].offset = offsetof(Vertex, color);
+		attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+		attribute_descriptions[1].offset = offsetof(Vertex, tex_coord);
 
-		// `tex_coord` attribute
+		// `normal` attribute
 		attribute_descriptions[2].binding = 0;
 		attribute_descriptions[2].location = 2;
-		attribute_descriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-		attribute_descriptions[2].offset = offsetof(Vertex, tex_coord);
-
-		// `normal` attribute
-		attribute_descriptions[3].binding = 0;
-		attribute_descriptions[3].location = 3;
-		attribute_descriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attribute_descriptions[3].offset = offsetof(Vertex, normal);
+		attribute_descriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attribute_descriptions[2].offset = offsetof(Vertex, normal);
 
 		return attribute_descriptions;
 	}
@@ -99,16 +112,151 @@ struct Vertex {
 	}
 }; // struct Vertex
 
-} // namespace scop
+/**
+ * Quantized vertex (16 bytes instead of 32):
+ * - pos: unorm16, relative to the model bounds (w unused),
+ * - normal: octahedral encoding, snorm16,
+ * - tex_coord: unorm16, relative to the texture coordinates bounds.
+*/
+struct CompactVertex {
+	/* ========================================================================= */
+	/*                               CLASS MEMBERS                               */
+	/* ========================================================================= */
 
-template<>
-struct std::hash<scop::Vertex> {
-	std::size_t	operator()(const scop::Vertex& vertex) const {
-		return (
-			(std::hash<scop::Vect3>()(vertex.pos)) ^
-			(std::hash<scop::Vect3>()(vertex.color)) ^
-			(std::hash<scop::Vect2>()(vertex.tex_coord)) ^
-			(std::hash<scop::Vect3>()(vertex.normal))
-		);
+	uint16_t		pos[4];
+	int16_t			normal[2];
+	uint16_t		tex_coord[2];
+
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	/* HELPER FUNCTIONS ======================================================== */
+
+	static VkVertexInputBindingDescription	getBindingDescription() {
+		VkVertexInputBindingDescription	binding_description{};
+
+		binding_description.binding = 0;
+		binding_description.stride = sizeof(CompactVertex);
+		binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return binding_description;
+	}
+
+	/**
+	 * Same locations as Vertex.
+	*/
+	static std::array<VkVertexInputAttributeDescription, 3>	getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 3>	attribute_descriptions{};
+
+		// `pos` attribute
+		attribute_descriptions[0].binding = 0;
+		attribute_descriptions[0].location = 0;
+		attribute_descriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attribute_descriptions[0].offset = offsetof(CompactVertex, pos);
+
+		// `tex_coord` attribute
+		attribute_descriptions[1].binding = 0;
+		attribute_descriptions[1].location = 1;
+		attribute_descriptions[1].format = VK_FORMAT_R16G16_UNORM;
+		attribute_descriptions[1].offset = offsetof(CompactVertex, tex_coord);
+
+		// `normal` attribute
+		attribute_descriptions[2].binding = 0;
+		attribute_descriptions[2].location = 2;
+		attribute_descriptions[2].format = VK_FORMAT_R16G16_SNORM;
+		attribute_descriptions[2].offset = offsetof(CompactVertex, normal);
+
+		return attribute_descriptions;
+	}
+}; // struct CompactVertex
+
+/**
+ * Vertex layout of the gpu vertex buffer.
+*/
+using GpuVertex = std::conditional_t<SCOP_COMPACT_VERTEX, CompactVertex, Vertex>;
+
+/**
+ * Streams of the gpu vertex buffer for the vertex layout V.
+ *
+ * Split, each vertex is cut after its position: positions are packed in
+ * binding 0, the other attributes follow in binding 1 in the same order,
+ * so that a depth only pass fetches the positions alone.
+*/
+template<typename V>
+struct VertexStreams {
+	static_assert(offsetof(V, pos) == 0, "Position must be the first attribute");
+
+	/* ========================================================================= */
+	/*                               CONST MEMBERS                               */
+	/* ========================================================================= */
+
+	static constexpr bool		split = SCOP_SPLIT_VERTEX;
+	static constexpr uint32_t	nb_bindings = split ? 2 : 1;
+	static constexpr uint32_t	position_size = sizeof(V::pos);
+	static constexpr uint32_t	attributes_size = sizeof(V) - position_size;
+
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	/**
+	 * First nb_bindings descriptions are used.
+	*/
+	static std::array<VkVertexInputBindingDescription, 2>	getBindingDescriptions() {
+		std::array<VkVertexInputBindingDescription, 2>	binding_descriptions{};
+
+		binding_descriptions[0] = V::getBindingDescription();
+		if constexpr (split) {
+			binding_descriptions[0].stride = position_size;
+			binding_descriptions[1] = V::getBindingDescription();
+			binding_descriptions[1].binding = 1;
+			binding_descriptions[1].stride = attributes_size;
+		}
+		return binding_descriptions;
+	}
+
+	static auto	getAttributeDescriptions() {
+		auto	attribute_descriptions = V::getAttributeDescriptions();
+
+		if constexpr (split) {
+			for (VkVertexInputAttributeDescription& attribute: attribute_descriptions) {
+				if (attribute.location != 0) {
+					attribute.binding = 1;
+					attribute.offset -= position_size;
+				}
+			}
+		}
+		return attribute_descriptions;
 	}
-};
\ No newline at end of file
+
+	/**
+	 * Position alone (location 0, binding 0), for the depth only pipeline.
+	*/
+	static VkVertexInputAttributeDescription	getPositionDescription() {
+		return V::getAttributeDescriptions()[0];
+	}
+
+	/**
+	 * @brief Cuts interleaved vertices into the position and attribute streams.
+	*/
+	static void	splitVertices(
+		const V* vertices,
+		std::size_t nb_vertices,
+		void* positions,
+		void* attributes
+	) noexcept {
+		const char*	src = reinterpret_cast<const char*>(vertices);
+		char*		dst_positions = static_cast<char*>(positions);
+		char*		dst_attributes = static_cast<char*>(attributes);
+
+		for (std::size_t i = 0; i < nb_vertices; ++i, src += sizeof(V)) {
+			std::memcpy(dst_positions + i * position_size, src, position_size);
+			std::memcpy(dst_attributes + i * attributes_size, src + position_size, attributes_size);
+		}
+	}
+};
+
+using GpuStreams = VertexStreams<GpuVertex>;
+
+} // namespace scop
@@ -12,15 +12,27 @@
 
 #include "app.hpp"
 
+/**
+ * Usage: ./scop [--mesh-report] model.obj
+ *
+ * --mesh-report prints the mesh efficiency figures instead of
+ * opening the viewer.
+*/
 int main(int ac, char** av) {
 	try {
+		scop::AppMode	mode = scop::APP_MODE_VIEWER;
+		if (ac > 1 && std::string(av[1]) == "--mesh-report") {
+			mode = scop::APP_MODE_MESH_REPORT;
+			--ac;
+			++av;
+		}
 		if (ac == 1) {
 			throw std::invalid_argument("No model path provided");
 		} else if (ac != 2) {
 			throw std::invalid_argument("Too many arguments");
 		}
 
-		scop::App		app(av[1]);
+		scop::App		app(av[1], mode);
 		app.run();
 	} catch (const std::exception& e) {
 		std::cerr << e.what() << __NL;
@@ -0,0 +1,214 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   file_cache.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:02:18 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:02:18 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <cstdint> // int64_t
+# include <cstdlib> // realpath, std::free
+# include <memory> // std::shared_ptr
+# include <mutex> // std::mutex, std::lock_guard
+# include <string> // std::string
+# include <unordered_map> // std::unordered_map
+
+# include <sys/stat.h> // stat
+
+# include "mapped_file.hpp"
+
+namespace scop {
+namespace utils {
+
+/**
+ * @brief Canonical path (links, '.' and '..' resolved) and modification
+ * time (ns) of a file.
+ *
+ * @return false if the file does not exist.
+*/
+inline bool	getFileKey(
+	const std::string& path,
+	std::string& canonical_path,
+	int64_t& mtime
+) {
+	struct stat	file_stat;
+	char*		resolved = ::realpath(path.c_str(), nullptr);
+
+	if (resolved == nullptr) {
+		return false;
+	}
+	canonical_path = resolved;
+	std::free(resolved);
+
+	if (::stat(canonical_path.c_str(), &file_stat) == -1) {
+		return false;
+	}
+	mtime =
+		static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+		file_stat.st_mtim.tv_nsec;
+	return true;
+}
+
+/**
+ * @brief Current size and modification time (ns) of a file.
+ *
+ * @return false if the file does not exist.
+*/
+inline bool	getFileKey(const std::string& path, FileKey& key) {
+	struct stat	file_stat;
+
+	if (::stat(path.c_str(), &file_stat) == -1) {
+		return false;
+	}
+	key.size = static_cast<uint64_t>(file_stat.st_size);
+	key.mtime =
+		static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+		file_stat.st_mtim.tv_nsec;
+	return true;
+}
+
+/**
+ * @brief Path with the extension of its file name replaced, or added if it
+ * has none. Dots in the directories, or leading the name, are kept.
+*/
+inline std::string	replaceExtension(
+	const std::string& path,
+	const std::string& extension
+) {
+	const std::size_t	name_pos = path.find_last_of('/') + 1;
+	const std::size_t	extension_pos = path.rfind('.');
+
+	if (extension_pos == std::string::npos || extension_pos <= name_pos) {
+		return path + extension;
+	}
+	return path.substr(0, extension_pos) + extension;
+}
+
+/**
+ * Process-wide cache of values loaded from files, shared and immutable.
+ *
+ * Keyed by canonical path and modification time: the same file reached
+ * through another path is a hit, a modified one is loaded again.
+ *
+ * @note Thread safe. Loads run under the lock, so that a file is never
+ * loaded twice: they are meant to be cheap (e.g. headers only).
+*/
+template<typename T>
+class FileCache {
+public:
+	/* ========================================================================= */
+	/*                                  TYPEDEFS                                 */
+	/* ========================================================================= */
+
+	typedef		std::shared_ptr<const T>	Ptr;
+
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	FileCache() = default;
+	~FileCache() = default;
+
+	FileCache(const FileCache& x) = delete;
+	FileCache&	operator=(const FileCache& x) = delete;
+
+	/* ========================================================================= */
+
+	/**
+	 * @brief Value of the file, from load(path) on a miss.
+	 *
+	 * @param hit Set to whether the value was already cached.
+	 * @note Files that cannot be found are loaded uncached,
+	 * for load to report the error.
+	*/
+	template<typename Load>
+	Ptr	get(const std::string& path, Load&& load, bool* hit = nullptr) {
+		std::string	canonical_path;
+		int64_t		mtime;
+
+		if (hit != nullptr) {
+			*hit = false;
+		}
+		if (!getFileKey(path, canonical_path, mtime)) {
+			return Ptr(load(path));
+		}
+
+		std::lock_guard<std::mutex>	lock(mutex);
+		Entry&						entry = entries[canonical_path];
+
+		if (entry.value != nullptr && entry.mtime == mtime) {
+			if (hit != nullptr) {
+				*hit = true;
+			}
+			return entry.value;
+		}
+		entry.value = nullptr;
+		entry.value = Ptr(load(path));
+		entry.mtime = mtime;
+		return entry.value;
+	}
+
+	/**
+	 * @brief Drops the value of the file, loaded again on the next get
+	 * (e.g. when a file it depends on changed).
+	*/
+	void	erase(const std::string& path) {
+		std::string	canonical_path;
+		int64_t		mtime;
+
+		if (getFileKey(path, canonical_path, mtime)) {
+			std::lock_guard<std::mutex>	lock(mutex);
+			entries.erase(canonical_path);
+		}
+	}
+
+	/**
+	 * @brief Runs visit(value) on each cached value.
+	*/
+	template<typename Visit>
+	void	forEach(Visit&& visit) {
+		std::lock_guard<std::mutex>	lock(mutex);
+
+		for (const auto& [path, entry]: entries) {
+			if (entry.value != nullptr) {
+				visit(*entry.value);
+			}
+		}
+	}
+
+	/**
+	 * @brief Drops the cached values, still alive for their users.
+	*/
+	void	clear() {
+		std::lock_guard<std::mutex>	lock(mutex);
+		entries.clear();
+	}
+
+private:
+	/* ========================================================================= */
+	/*                                HELPER CLASS                               */
+	/* ========================================================================= */
+
+	struct Entry {
+		int64_t		mtime = 0;
+		Ptr			value;
+	};
+
+	/* ========================================================================= */
+	/*                               CLASS MEMBERS                               */
+	/* ========================================================================= */
+
+	std::mutex								mutex;
+	std::unordered_map<std::string, Entry>	entries;
+
+}; // class FileCache
+
+} // namespace utils
+} // namespace scop
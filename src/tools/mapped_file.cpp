@@ -0,0 +1,123 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   mapped_file.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:14:02 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 10:14:02 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "mapped_file.hpp"
+
+#include <sys/mman.h>	// mmap, munmap, madvise
+#include <sys/stat.h>	// fstat
+#include <fcntl.h>		// open
+#include <unistd.h>		// close
+
+namespace scop {
+namespace utils {
+
+/* ========================================================================== */
+/*                                   PUBLIC                                   */
+/* ========================================================================== */
+
+MappedFile::MappedFile(MappedFile&& x) noexcept:
+fd(x.fd),
+mapping(x.mapping),
+mapping_size(x.mapping_size),
+key(x.key) {
+	x.fd = -1;
+	x.mapping = nullptr;
+	x.mapping_size = 0;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+/* ========================================================================== */
+
+/**
+ * @brief Maps the whole file in memory, read only.
+ *
+ * @note An empty file is considered open, with an empty view.
+ * @return false if the file could not be opened or mapped.
+*/
+bool	MappedFile::open(const std::string& path) noexcept {
+	close();
+
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat	file_stat;
+	if (::fstat(fd, &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+		close();
+		return false;
+	}
+
+	mapping_size = static_cast<std::size_t>(file_stat.st_size);
+	key.size = static_cast<uint64_t>(file_stat.st_size);
+	key.mtime =
+		static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+		file_stat.st_mtim.tv_nsec;
+	if (mapping_size == 0) {
+		return true;
+	}
+
+	void*	address = ::mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (address == MAP_FAILED) {
+		close();
+		return false;
+	}
+	mapping = static_cast<char*>(address);
+
+	// Files are parsed front to back
+	::madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+	return true;
+}
+
+void	MappedFile::close() noexcept {
+	if (mapping != nullptr) {
+		::munmap(mapping, mapping_size);
+		mapping = nullptr;
+	}
+	if (fd != -1) {
+		::close(fd);
+		fd = -1;
+	}
+	mapping_size = 0;
+	key = FileKey();
+}
+
+/* ========================================================================== */
+
+bool	MappedFile::isOpen() const noexcept {
+	return fd != -1;
+}
+
+std::string_view	MappedFile::view() const noexcept {
+	return std::string_view(mapping, mapping_size);
+}
+
+const char*	MappedFile::data() const noexcept {
+	return mapping;
+}
+
+std::size_t	MappedFile::size() const noexcept {
+	return mapping_size;
+}
+
+/**
+ * @brief Key of the file as it was when opened, matching the mapped content.
+*/
+const FileKey&	MappedFile::getKey() const noexcept {
+	return key;
+}
+
+} // namespace utils
+} // namespace scop
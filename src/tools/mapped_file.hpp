@@ -0,0 +1,74 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   mapped_file.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:12:41 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 10:12:41 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <string>			// std::string
+# include <string_view>	// std::string_view
+# include <cstdint>		// uint64_t, int64_t
+
+namespace scop {
+namespace utils {
+
+/**
+ * Size and modification time (ns) of a file, standing for its content.
+*/
+struct FileKey {
+	uint64_t			size = 0;
+	int64_t				mtime = 0;
+};
+
+/**
+ * Read-only memory mapping of a whole file.
+ *
+ * The content stays valid as long as the object is alive, so views
+ * built on top of it must not outlive it.
+*/
+class MappedFile {
+public:
+	/* ========================================================================= */
+	/*                                  METHODS                                  */
+	/* ========================================================================= */
+
+	MappedFile() = default;
+	MappedFile(MappedFile&& x) noexcept;
+	~MappedFile();
+
+	MappedFile(const MappedFile& x) = delete;
+	MappedFile&	operator=(const MappedFile& x) = delete;
+
+	/* ========================================================================= */
+
+	bool				open(const std::string& path) noexcept;
+	void				close() noexcept;
+
+	bool				isOpen() const noexcept;
+	std::string_view	view() const noexcept;
+	const char*			data() const noexcept;
+	std::size_t			size() const noexcept;
+	const FileKey&		getKey() const noexcept;
+
+private:
+	/* ========================================================================= */
+	/*                               CLASS MEMBERS                               */
+	/* ========================================================================= */
+
+	int					fd = -1;
+	char*				mapping = nullptr;
+	std::size_t			mapping_size = 0;
+	FileKey				key;			// Of the mapped content
+
+}; // class MappedFile
+
+} // namespace utils
+} // namespace scop
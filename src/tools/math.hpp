@@ -29,47 +29,6 @@ inline float	dregrees(float radians) noexcept {
 	return radians * 180 / M_PI;
 }
 
-/**
- * @brief Generates a random float between 0.0f and 1.0f.
- * 
- * @note Uses a Mersenne Twister pseudo-random generator.
-*/
-inline float	generateRandomFloat() {
-	static std::random_device rd;
-	static std::mt19937 gen(rd());
-	static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
-	return dis(gen);
-}
-
-/**
- * @brief Generates a random vibrant color.
-*/
-inline void	generateVibrantColor(float& red, float& green, float& blue) {
-	red = generateRandomFloat();
-	green = generateRandomFloat();
-	blue = generateRandomFloat();
-
-	// Boost the saturation and value to make it vibrant
-	const float maxChannel = std::max(std::max(red, green), blue);
-	const float minChannel = std::min(std::min(red, green), blue);
-	const float delta = maxChannel - minChannel;
-	
-	if (delta > 0.0f) {
-		if (maxChannel == red) {
-			green = (green - minChannel) / delta;
-			blue = (blue - minChannel) / delta;
-		}
-		else if (maxChannel == green) {
-			red = (red - minChannel) / delta;
-			blue = (blue - minChannel) / delta;
-		}
-		else if (maxChannel == blue) {
-			red = (red - minChannel) / delta;
-			green = (green - minChannel) / delta;
-		}
-	}
-}
-
 /**
  * @brief Computes the linear interpolation between two values.
  *
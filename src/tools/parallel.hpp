@@ -0,0 +1,80 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   parallel.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 15:02:13 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 15:02:13 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+// Std
+# include <algorithm> // std::min
+# include <exception> // std::exception_ptr
+# include <thread> // std::thread
+# include <vector> // std::vector
+
+namespace scop {
+namespace parallel {
+
+/**
+ * @brief Runs task(begin, end) over [0, size), split in one range per thread.
+ *
+ * @note The first exception thrown by a task is rethrown once all the
+ * threads are joined.
+*/
+template<typename Task>
+inline void	runRanges(std::size_t size, std::size_t nb_threads, Task&& task) {
+	if (nb_threads <= 1) {
+		return task(std::size_t(0), size);
+	}
+
+	std::vector<std::thread>		threads;
+	std::vector<std::exception_ptr>	errors(nb_threads);
+	const std::size_t				range = (size + nb_threads - 1) / nb_threads;
+
+	threads.reserve(nb_threads);
+	for (std::size_t i = 0; i < nb_threads; ++i) {
+		const std::size_t	begin = std::min(size, i * range);
+		const std::size_t	end = std::min(size, begin + range);
+		threads.emplace_back([&task, &errors, i, begin, end]() {
+			try {
+				task(begin, end);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		});
+	}
+	for (std::thread& thread: threads) {
+		thread.join();
+	}
+	for (const std::exception_ptr& error: errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+/**
+ * @brief Number of threads to use for size elements: all the hardware
+ * threads from threshold on, one below it.
+ *
+ * @param nb_threads Requested count, 0 to decide from the size.
+*/
+inline std::size_t	threadCount(
+	std::size_t size,
+	std::size_t threshold,
+	std::size_t nb_threads
+) noexcept {
+	if (nb_threads == 0) {
+		nb_threads = size >= threshold ? std::thread::hardware_concurrency() : 1;
+	}
+	return std::max<std::size_t>(1, std::min<std::size_t>(nb_threads, 256));
+}
+
+} // namespace parallel
+} // namespace scop
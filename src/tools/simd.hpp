@@ -0,0 +1,210 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   simd.hpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: etran <etran@student.42.fr>                +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 14:20:07 by etran             #+#    #+#             */
+/*   Updated: 2026/10/17 14:20:07 by etran            ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+# if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define SCOP_SIMD_SSE2 1
+# else
+#  include <cmath> // std::sqrt
+#  define SCOP_SIMD_SSE2 0
+# endif
+
+// Byte shuffles, only when the compiler targets them (-mssse3 and up)
+# if defined(__SSSE3__)
+#  include <tmmintrin.h>
+#  define SCOP_SIMD_SSSE3 1
+# else
+#  define SCOP_SIMD_SSSE3 0
+# endif
+
+namespace scop {
+namespace simd {
+
+/**
+ * Four floats processed at once (SSE2, or plain loops without it).
+ *
+ * @note Comparisons return lane masks, to be used with select.
+*/
+struct Float4 {
+# if SCOP_SIMD_SSE2
+	__m128	v;
+# else
+	float	v[4];
+# endif
+};
+
+# if SCOP_SIMD_SSE2
+
+inline Float4	load(const float* ptr) noexcept {
+	return { _mm_loadu_ps(ptr) };
+}
+
+inline void	store(float* ptr, Float4 a) noexcept {
+	_mm_storeu_ps(ptr, a.v);
+}
+
+inline Float4	splat(float value) noexcept {
+	return { _mm_set1_ps(value) };
+}
+
+inline Float4	operator+(Float4 a, Float4 b) noexcept { return { _mm_add_ps(a.v, b.v) }; }
+inline Float4	operator-(Float4 a, Float4 b) noexcept { return { _mm_sub_ps(a.v, b.v) }; }
+inline Float4	operator*(Float4 a, Float4 b) noexcept { return { _mm_mul_ps(a.v, b.v) }; }
+inline Float4	operator/(Float4 a, Float4 b) noexcept { return { _mm_div_ps(a.v, b.v) }; }
+
+inline Float4	min(Float4 a, Float4 b) noexcept { return { _mm_min_ps(a.v, b.v) }; }
+inline Float4	max(Float4 a, Float4 b) noexcept { return { _mm_max_ps(a.v, b.v) }; }
+inline Float4	sqrt(Float4 a) noexcept { return { _mm_sqrt_ps(a.v) }; }
+
+inline Float4	abs(Float4 a) noexcept {
+	return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) };
+}
+
+inline Float4	lessThan(Float4 a, Float4 b) noexcept {
+	return { _mm_cmplt_ps(a.v, b.v) };
+}
+
+/**
+ * @brief Lanes of a where mask is set, of b elsewhere.
+*/
+inline Float4	select(Float4 mask, Float4 a, Float4 b) noexcept {
+	return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+
+# else
+
+namespace detail {
+
+template<typename F>
+inline Float4	map(Float4 a, Float4 b, F op) noexcept {
+	Float4	res;
+	for (int i = 0; i < 4; ++i) {
+		res.v[i] = op(a.v[i], b.v[i]);
+	}
+	return res;
+}
+
+} // namespace detail
+
+inline Float4	load(const float* ptr) noexcept {
+	return { { ptr[0], ptr[1], ptr[2], ptr[3] } };
+}
+
+inline void	store(float* ptr, Float4 a) noexcept {
+	for (int i = 0; i < 4; ++i) {
+		ptr[i] = a.v[i];
+	}
+}
+
+inline Float4	splat(float value) noexcept {
+	return { { value, value, value, value } };
+}
+
+inline Float4	operator+(Float4 a, Float4 b) noexcept {
+	return detail::map(a, b, [](float x, float y) { return x + y; });
+}
+inline Float4	operator-(Float4 a, Float4 b) noexcept {
+	return detail::map(a, b, [](float x, float y) { return x - y; });
+}
+inline Float4	operator*(Float4 a, Float4 b) noexcept {
+	return detail::map(a, b, [](float x, float y) { return x * y; });
+}
+inline Float4	operator/(Float4 a, Float4 b) noexcept {
+	return detail::map(a, b, [](float x, float y) { return x / y; });
+}
+
+inline Float4	min(Float4 a, Float4 b) noexcept {
+	return detail::map(a, b, [](float x, float y) { return y < x ? y : x; });
+}
+inline Float4	max(Float4 a, Float4 b) noexcept {
+	return detail::map(a, b, [](float x, float y) { return x < y ? y : x; });
+}
+inline Float4	sqrt(Float4 a) noexcept {
+	return detail::map(a, a, [](float x, float) { return std::sqrt(x); });
+}
+
+inline Float4	abs(Float4 a) noexcept {
+	return detail::map(a, a, [](float x, float) { return x < 0.0f ? -x : x; });
+}
+
+inline Float4	lessThan(Float4 a, Float4 b) noexcept {
+	// Any non zero lane is set
+	return detail::map(a, b, [](float x, float y) { return x < y ? 1.0f : 0.0f; });
+}
+
+inline Float4	select(Float4 mask, Float4 a, Float4 b) noexcept {
+	Float4	res;
+	for (int i = 0; i < 4; ++i) {
+		res.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+	}
+	return res;
+}
+
+# endif
+
+/* ========================================================================== */
+
+/**
+ * Three component vectors, four at a time (one lane each).
+*/
+struct Vect3x4 {
+	Float4	x;
+	Float4	y;
+	Float4	z;
+};
+
+inline Vect3x4	operator-(const Vect3x4& a, const Vect3x4& b) noexcept {
+	return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+inline Float4	dot(const Vect3x4& a, const Vect3x4& b) noexcept {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Vect3x4	cross(const Vect3x4& a, const Vect3x4& b) noexcept {
+	return {
+		a.y * b.z - a.z * b.y,
+		a.z * b.x - a.x * b.z,
+		a.x * b.y - a.y * b.x
+	};
+}
+
+/**
+ * @brief Lengths of the vectors, and the vectors divided by them
+ * (left null when null).
+*/
+inline Vect3x4	normalize(const Vect3x4& a, Float4& length) noexcept {
+	length = sqrt(dot(a, a));
+
+	const Float4	zero = splat(0.0f);
+	const Float4	nonzero = lessThan(zero, length);
+	const Float4	inv = select(nonzero, splat(1.0f) / select(nonzero, length, splat(1.0f)), zero);
+	return { a.x * inv, a.y * inv, a.z * inv };
+}
+
+/**
+ * @brief Arc cosine, within 1e-4 radians (Abramowitz & Stegun 4.4.45).
+*/
+inline Float4	acos(Float4 a) noexcept {
+	const Float4	x = min(abs(a), splat(1.0f));
+	const Float4	poly =
+		((splat(-0.0187293f) * x + splat(0.0742610f)) * x - splat(0.2121144f)) * x +
+		splat(1.5707288f);
+	const Float4	res = sqrt(splat(1.0f) - x) * poly;
+
+	return select(lessThan(a, splat(0.0f)), splat(3.14159265f) - res, res);
+}
+
+} // namespace simd
+} // namespace scop
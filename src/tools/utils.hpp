@@ -64,22 +64,5 @@ inline std::vector<char>	readFile(const std::string& filename) {
 	return buffer;
 }
 
-/**
- * @brief Computes the barycenter of a list of vertices.
- * 
- * @param vertices The list of vertices.
-*/
-inline Vect3	computeBarycenter(const std::vector<Vertex>& vertices) noexcept {
-	Vect3	barycenter{};
-
-	for (const Vertex& vertex : vertices) {
-		barycenter += vertex.pos;
-	}
-	if (vertices.size() > 0) {
-		barycenter /= static_cast<float>(vertices.size());
-	}
-	return barycenter;
-}
-
 } // namespace utils
 } // namespace scop
\ No newline at end of file